@@ -255,7 +255,7 @@ uint16_t xStringUint32Toa(char *str, uint32_t value)
 {
     // convert uint32 to string
     // return the length of the converted xString
-    return sprintf(str, "%d", value);
+    return sprintf(str, "%lu", (unsigned long)value);
 }
 
 uint16_t xStringInt32Toa(char *str, int32_t value)
@@ -2,4 +2,5 @@
 #define __MILLIS_H__
 #include "stdint.h"
 uint32_t millis(void);
+uint32_t micros(void); // free-running microseconds, wraps every ~71 minutes
 #endif // __MILLIS_H__
@@ -3,3 +3,21 @@ uint32_t millis(void)
 {
     return HAL_GetTick();
 }
+
+// 微秒时间戳,由HAL 1ms节拍与SysTick当前计数合成,约71分钟回绕,只用于差值
+uint32_t micros(void)
+{
+    uint32_t ms, val, load;
+    do
+    {
+        ms = HAL_GetTick();
+        val = SysTick->VAL;
+    } while (ms != HAL_GetTick());
+    load = SysTick->LOAD;
+    // SysTick优先级最低,在其它中断中调用时计数可能已回绕而节拍尚未更新
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && val > (load >> 1))
+    {
+        ms++;
+    }
+    return ms * 1000 + (load - val) * 1000 / (load + 1);
+}
@@ -29,6 +29,7 @@
 -*------------------------------------------------------------------*/
 
 #include "Sch51.h"
+#include <string.h>
 // ------ Public variable definitions ------------------------------
 
 // The array of tasks
@@ -46,6 +47,122 @@ static void SCH_Go_To_Sleep(void);
 // The code of the last error (reset after ~1 minute)
 static uint8_t Last_error_code_G;
 
+// Scheduler ticks since start, used for deadline checks
+static volatile uint32_t SCH_Tick_G = 0;
+
+// Sleep statistics, see SCH_Go_To_Sleep()
+static uint32_t SCH_Wakes_G = 0;
+static uint32_t SCH_Idle_ms_G = 0;
+static uint32_t SCH_Idle_us_G = 0; // below 1 ms, carried to the next sleep
+static uint32_t SCH_Busy_Start_us_G = 0; // end of the last sleep
+static uint32_t SCH_Busy_Max_us_G = 0;   // longest stretch between two sleeps
+
+// Adds one execution time to the min/avg/max and histogram of a task
+static void SCH_Profile(sTaskStats *pStats, const uint32_t Exec_us)
+{
+   uint8_t Bucket = 0;
+   uint32_t Edge = (uint32_t)1 << SCH_PROF_HIST_BASE;
+
+   while (Bucket < SCH_PROF_HIST_SIZE - 1 && Exec_us >= Edge)
+   {
+      Bucket++;
+      Edge <<= SCH_PROF_HIST_STEP;
+   }
+   if (pStats->Hist[Bucket] != 0xFFFF)
+   {
+      pStats->Hist[Bucket]++;
+   }
+
+   if (pStats->Runs == 0 || Exec_us < pStats->Bcet_us)
+   {
+      pStats->Bcet_us = Exec_us;
+   }
+   if (Exec_us > pStats->Wcet_us)
+   {
+      pStats->Wcet_us = Exec_us;
+   }
+   pStats->Total_us += Exec_us;
+   pStats->Runs++;
+}
+
+/*------------------------------------------------------------------*-
+
+  SCH_Run_Task()
+
+  Runs one due task and updates its timing statistics.
+
+  A run is a deadline miss when the next release of the task was
+  already due before it started (RunMe backlog, or started a full
+  period or more after its release). It is an overrun when the task
+  itself ran for a full period or more.
+
+-*------------------------------------------------------------------*/
+static void SCH_Run_Task(const uint8_t Index)
+{
+   sTask *pTask = &SCH_tasks_G[Index];
+   uint32_t Start_tick = SCH_Tick_G;
+   uint32_t Start_us;
+   uint32_t Exec_us;
+
+   if (pTask->RunMe > 1 && pTask->Stats.Backlog != 0xFFFF)
+   {
+      pTask->Stats.Backlog++;
+   }
+   if (pTask->Period != 0 && (pTask->RunMe > 1 || Start_tick - pTask->Release >= pTask->Period))
+   {
+      pTask->Stats.Deadline_misses++;
+   }
+
+   {
+      // Reduce RunMe before the run, so a release or SCH_Trigger_Task()
+      // while the task runs makes it due again instead of being lost
+      SCH_ENTER_CRITICAL(); // RunMe is also updated by the timer ISR
+      pTask->RunMe -= 1;
+      if (pTask->RunMe > 0)
+      {
+         pTask->Release = Start_tick; // backlog run counts from now
+      }
+      SCH_EXIT_CRITICAL();
+   }
+
+   Start_us = SCH_TIME_US();
+   (*pTask->pTask)(); // Run the task
+   Exec_us = SCH_TIME_US() - Start_us;
+
+   SCH_Profile(&pTask->Stats, Exec_us);
+   if (pTask->Period != 0 && SCH_Tick_G - Start_tick >= pTask->Period)
+   {
+      pTask->Stats.Overruns++;
+   }
+
+   // Periodic tasks will automatically run again
+   // - if this is a 'one shot' task, remove it from the array
+   // - event tasks stay, parked until armed again
+   if (pTask->Period == 0 && (pTask->Flags & SCH_TASK_EVENT) == 0)
+   {
+      SCH_Delete_Task(Index);
+   }
+}
+
+// Index of the highest priority due task, SCH_MAX_TASKS if none
+static uint8_t SCH_Next_Ready(void)
+{
+   uint8_t Index;
+   uint8_t Best = SCH_MAX_TASKS;
+   for (Index = 0; Index < SCH_MAX_TASKS; Index++)
+   {
+      if (SCH_tasks_G[Index].RunMe == 0 || SCH_tasks_G[Index].pTask == 0)
+      {
+         continue;
+      }
+      if (Best == SCH_MAX_TASKS || SCH_tasks_G[Index].Priority < SCH_tasks_G[Best].Priority)
+      {
+         Best = Index;
+      }
+   }
+   return Best;
+}
+
 /*------------------------------------------------------------------*-
 
   SCH_Dispatch_Tasks()
@@ -58,23 +175,19 @@ static uint8_t Last_error_code_G;
 void SCH_Dispatch_Tasks(void)
 {
    uint8_t Index;
+   uint8_t Runs;
 
-   // Dispatches (runs) the next task (if one is ready)
-   for (Index = 0; Index < SCH_MAX_TASKS; Index++)
+   // Dispatches (runs) the highest priority ready task, then picks again,
+   // so a task released during a long run does not wait for the rest of the array.
+   // Bounded so an overrunning task cannot keep the loop from reaching sleep/report
+   for (Runs = 0; Runs < SCH_MAX_TASKS; Runs++)
    {
-      if (SCH_tasks_G[Index].RunMe > 0)
+      Index = SCH_Next_Ready();
+      if (Index >= SCH_MAX_TASKS)
       {
-         (*SCH_tasks_G[Index].pTask)(); // Run the task
-
-         SCH_tasks_G[Index].RunMe -= 1; // Reset / reduce RunMe flag
-
-         // Periodic tasks will automatically run again
-         // - if this is a 'one shot' task, remove it from the array
-         if (SCH_tasks_G[Index].Period == 0)
-         {
-            SCH_Delete_Task(Index);
-         }
+         break;
       }
+      SCH_Run_Task(Index);
    }
 
    // Report system status
@@ -133,7 +246,7 @@ uint8_t SCH_Add_Task(void (*pFunction)(), const uint16_t DELAY, const uint16_t P
 {
    uint8_t Index = 0;
    // First find a gap in the array (if there is one)
-   while ((SCH_tasks_G[Index].pTask != 0) && (Index < SCH_MAX_TASKS))
+   while ((Index < SCH_MAX_TASKS) && (SCH_tasks_G[Index].pTask != 0))
    {
       Index++;
    }
@@ -152,9 +265,77 @@ uint8_t SCH_Add_Task(void (*pFunction)(), const uint16_t DELAY, const uint16_t P
    SCH_tasks_G[Index].Delay = DELAY;
    SCH_tasks_G[Index].Period = PERIOD;
    SCH_tasks_G[Index].RunMe = 0;
+   SCH_tasks_G[Index].Priority = SCH_PRIO_DEFAULT;
+   SCH_tasks_G[Index].Flags = 0;
+   SCH_tasks_G[Index].Release = 0;
+   memset(&SCH_tasks_G[Index].Stats, 0, sizeof(sTaskStats));
    return Index; // return position of task (to allow later deletion)
 }
 
+/*------------------------------------------------------------------*-
+
+  SCH_Add_Event_Task()
+
+  Adds a one-shot task that keeps its slot. It is parked (never
+  runs) until SCH_Arm_Task() sets its delay, runs once, and is
+  parked again. A task that re-arms itself from its own run forms
+  a timed chain that cannot fail for lack of a free slot.
+
+  RETURN VALUE: as SCH_Add_Task()
+
+-*------------------------------------------------------------------*/
+uint8_t SCH_Add_Event_Task(void (*pFunction)(void))
+{
+   uint8_t Index = SCH_Add_Task(pFunction, 0, 0);
+   if (Index < SCH_MAX_TASKS)
+   {
+      SCH_tasks_G[Index].Flags = SCH_TASK_EVENT;
+   }
+   return Index;
+}
+
+/*------------------------------------------------------------------*-
+
+  SCH_Arm_Task()
+
+  Runs an event task once, DELAY ticks from now (as SCH_Add_Task()
+  with PERIOD 0). Re-arming replaces a pending run.
+
+  RETURN VALUE: RETURN_ERROR if TASK_INDEX is not an event task
+
+-*------------------------------------------------------------------*/
+uint8_t SCH_Arm_Task(const uint8_t TASK_INDEX, const uint16_t DELAY)
+{
+   if (TASK_INDEX >= SCH_MAX_TASKS || SCH_tasks_G[TASK_INDEX].pTask == 0 ||
+       (SCH_tasks_G[TASK_INDEX].Flags & SCH_TASK_EVENT) == 0)
+   {
+      return RETURN_ERROR;
+   }
+   {
+      SCH_ENTER_CRITICAL();
+      SCH_tasks_G[TASK_INDEX].Delay = DELAY;
+      SCH_tasks_G[TASK_INDEX].RunMe = 0;
+      SCH_tasks_G[TASK_INDEX].Flags |= SCH_TASK_ARMED;
+      SCH_EXIT_CRITICAL();
+   }
+   return RETURN_NORMAL;
+}
+
+// Parks an event task again, a pending run is dropped
+void SCH_Disarm_Task(const uint8_t TASK_INDEX)
+{
+   if (TASK_INDEX >= SCH_MAX_TASKS || (SCH_tasks_G[TASK_INDEX].Flags & SCH_TASK_EVENT) == 0)
+   {
+      return;
+   }
+   {
+      SCH_ENTER_CRITICAL();
+      SCH_tasks_G[TASK_INDEX].Flags &= ~SCH_TASK_ARMED;
+      SCH_tasks_G[TASK_INDEX].RunMe = 0;
+      SCH_EXIT_CRITICAL();
+   }
+}
+
 /*------------------------------------------------------------------*-
 
   SCH_Delete_Task()
@@ -192,6 +373,7 @@ uint8_t SCH_Delete_Task(const uint8_t TASK_INDEX)
    SCH_tasks_G[TASK_INDEX].Period = 0;
 
    SCH_tasks_G[TASK_INDEX].RunMe = 0;
+   SCH_tasks_G[TASK_INDEX].Flags = 0;
 
    return Return_code; // return status
 }
@@ -281,9 +463,84 @@ void SCH_Report_Status(void)
 
   *** ADAPT AS REQUIRED FOR YOUR HARDWARE ***
 
+  Tickless version: when no task is ready, the port sleeps until the
+  next task is due (or any interrupt), with the scheduler tick
+  suppressed meanwhile. The ticks that passed are replayed here, so
+  task delays stay exact. See SCH_IDLE() in Sch51_config.h.
+
 -*------------------------------------------------------------------*/
 void SCH_Go_To_Sleep()
 {
+   uint8_t Index;
+   uint32_t Idle_ticks = 0xFFFF;
+   uint32_t Start_us;
+   uint16_t Skipped;
+
+   SCH_ENTER_CRITICAL(); // a task triggered from an ISR from here on still wakes the core
+
+   for (Index = 0; Index < SCH_MAX_TASKS; Index++)
+   {
+      if (SCH_tasks_G[Index].pTask == 0)
+      {
+         continue;
+      }
+      if (SCH_tasks_G[Index].RunMe > 0)
+      {
+         Idle_ticks = 0;
+         break;
+      }
+      if (SCH_tasks_G[Index].Flags == SCH_TASK_EVENT)
+      {
+         continue; // parked
+      }
+      // A task with Delay d is released at the (d + 1)th tick from now
+      if ((uint32_t)SCH_tasks_G[Index].Delay + 1 < Idle_ticks)
+      {
+         Idle_ticks = (uint32_t)SCH_tasks_G[Index].Delay + 1;
+      }
+   }
+
+   if (Idle_ticks > 0)
+   {
+      Start_us = SCH_TIME_US();
+      if (SCH_Wakes_G != 0 && Start_us - SCH_Busy_Start_us_G > SCH_Busy_Max_us_G)
+      {
+         SCH_Busy_Max_us_G = Start_us - SCH_Busy_Start_us_G;
+      }
+      Skipped = SCH_IDLE((uint16_t)Idle_ticks);
+      while (Skipped--)
+      {
+         SCH_Dispatch_IT(); // ticks the timer ISR did not see while suppressed
+      }
+      SCH_Busy_Start_us_G = SCH_TIME_US();
+      SCH_Idle_us_G += SCH_Busy_Start_us_G - Start_us;
+      SCH_Idle_ms_G += SCH_Idle_us_G / 1000;
+      SCH_Idle_us_G %= 1000;
+      SCH_Wakes_G++;
+   }
+
+   SCH_EXIT_CRITICAL();
+}
+
+// ------ Idle statistics ------------------------------------------
+// Wakes: number of returns from sleep, Idle_ms: time spent asleep
+void SCH_Get_Idle_Stats(uint32_t *pWakes, uint32_t *pIdle_ms)
+{
+   SCH_ENTER_CRITICAL();
+   *pWakes = SCH_Wakes_G;
+   *pIdle_ms = SCH_Idle_ms_G;
+   SCH_EXIT_CRITICAL();
+}
+
+// Longest time the dispatcher stayed awake since the last call, then restarts the measurement
+uint32_t SCH_Take_Busy_Max_us(void)
+{
+   uint32_t Busy_max_us;
+   SCH_ENTER_CRITICAL();
+   Busy_max_us = SCH_Busy_Max_us_G;
+   SCH_Busy_Max_us_G = 0;
+   SCH_EXIT_CRITICAL();
+   return Busy_max_us;
 }
 
 // ------ Scheduler timer ISR -------------------------------------
@@ -292,14 +549,19 @@ void SCH_Go_To_Sleep()
 void SCH_Dispatch_IT(void)
 {
    uint8_t Index;
+   SCH_Tick_G++;
    for (Index = 0; Index < SCH_MAX_TASKS; Index++)
    {
-      // Check if there is a task at this location
-      if (SCH_tasks_G[Index].pTask)
+      // Check if there is a task at this location (parked event tasks are skipped)
+      if (SCH_tasks_G[Index].pTask && SCH_tasks_G[Index].Flags != SCH_TASK_EVENT)
       {
          if (SCH_tasks_G[Index].Delay == 0)
          {
             // The task is due to run
+            if (SCH_tasks_G[Index].RunMe == 0)
+            {
+               SCH_tasks_G[Index].Release = SCH_Tick_G;
+            }
             SCH_tasks_G[Index].RunMe += 1; // Inc. the 'RunMe' flag
 
             if (SCH_tasks_G[Index].Period)
@@ -307,6 +569,11 @@ void SCH_Dispatch_IT(void)
                // Schedule regular tasks to run again
                SCH_tasks_G[Index].Delay = SCH_tasks_G[Index].Period-1;
             }
+            else
+            {
+               // Event task: released once, parked until armed again
+               SCH_tasks_G[Index].Flags &= ~SCH_TASK_ARMED;
+            }
          }
          else
          {
@@ -316,3 +583,57 @@ void SCH_Dispatch_IT(void)
       }
    }
 }
+
+// ------ Priorities and statistics --------------------------------
+void SCH_Set_Priority(const uint8_t TASK_INDEX, const uint8_t PRIORITY)
+{
+   if (TASK_INDEX >= SCH_MAX_TASKS || SCH_tasks_G[TASK_INDEX].pTask == 0)
+   {
+      return;
+   }
+   SCH_tasks_G[TASK_INDEX].Priority = PRIORITY;
+}
+
+uint8_t SCH_Get_Task_Stats(const uint8_t TASK_INDEX, sTaskStats *pStats)
+{
+   if (TASK_INDEX >= SCH_MAX_TASKS || SCH_tasks_G[TASK_INDEX].pTask == 0)
+   {
+      return RETURN_ERROR;
+   }
+   *pStats = SCH_tasks_G[TASK_INDEX].Stats;
+   return RETURN_NORMAL;
+}
+
+uint32_t SCH_Task_Avg_us(const sTaskStats *pStats)
+{
+   if (pStats->Runs == 0)
+   {
+      return 0;
+   }
+   return (uint32_t)(pStats->Total_us / pStats->Runs);
+}
+
+// ------ Event trigger --------------------------------------------
+// Make the task run on the next SCH_Dispatch_Tasks() pass instead of
+// waiting for its period, e.g. from a receive ISR.
+// A pending run is not stacked: RunMe is only raised from 0 to 1.
+void SCH_Trigger_Task(const uint8_t TASK_INDEX)
+{
+   if (TASK_INDEX >= SCH_MAX_TASKS || SCH_tasks_G[TASK_INDEX].pTask == 0)
+   {
+      return;
+   }
+   if (SCH_tasks_G[TASK_INDEX].RunMe == 0)
+   {
+      SCH_tasks_G[TASK_INDEX].Release = SCH_Tick_G;
+      SCH_tasks_G[TASK_INDEX].RunMe = 1;
+   }
+}
+
+// ------ Tick count -----------------------------------------------
+// Scheduler ticks since start, including ticks replayed after a
+// tickless sleep. Lets callers share data sampled within one tick.
+uint32_t SCH_Get_Tick(void)
+{
+   return SCH_Tick_G;
+}
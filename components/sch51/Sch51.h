@@ -27,9 +27,26 @@
 #include "stdint.h"
 #include "Sch51_config.h"
 
+// ------ Execution time histogram ---------------------------------
+// Bucket edges are powers of two, SCH_PROF_HIST_STEP bits apart:
+// bucket 0 < 16us, 1 < 64us, 2 < 256us ... the last bucket holds the rest
+#define SCH_PROF_HIST_SIZE (8)
+#define SCH_PROF_HIST_BASE (4) // log2 of the upper edge of bucket 0
+#define SCH_PROF_HIST_STEP (2)
+
 // ------ Public data type declarations ----------------------------
-// Store in DATA area, if possible, for rapid access
-// Total memory per task is 7 bytes
+// Per-task timing statistics, updated by the dispatcher
+typedef struct
+{
+   uint32_t Runs;             // Completed runs
+   uint32_t Bcet_us;          // Best case execution time (us)
+   uint32_t Wcet_us;          // Worst case execution time (us)
+   uint64_t Total_us;         // Sum of execution times, for the average
+   uint16_t Overruns;         // Runs that took longer than one period
+   uint16_t Deadline_misses;  // Runs started after the next release was already due
+   uint16_t Backlog;          // Runs started with RunMe > 1 (at least one release queued behind)
+   uint16_t Hist[SCH_PROF_HIST_SIZE]; // Execution time histogram, saturating
+} sTaskStats;
 
 typedef struct
 {
@@ -46,22 +63,57 @@ typedef struct
 
    // Incremented (by scheduler) when task is due to execute
    uint8_t RunMe;
+
+   // Dispatch priority, lower value runs first - see SCH_Set_Priority()
+   uint8_t Priority;
+
+   // SCH_TASK_xx, see SCH_Add_Event_Task()
+   uint8_t Flags;
+
+   // Tick at which the pending run was released (RunMe 0 -> 1)
+   uint32_t Release;
+
+   sTaskStats Stats;
 } sTask;
 
+// ------ Task priorities ------------------------------------------
+// All tasks run from SCH_Dispatch_Tasks(), highest priority first,
+// equal priorities in array order. A running task is not preempted:
+// a due task waits at most for the longest run of any other task.
+#define SCH_PRIO_HIGH 32
+#define SCH_PRIO_DEFAULT 128
+#define SCH_PRIO_LOW 192
+
+// ------ Task flags -----------------------------------------------
+#define SCH_TASK_EVENT 0x01 // Stays in the array after a one-shot run
+#define SCH_TASK_ARMED 0x02 // Event task counting down to its next run
+
 // ------ Public function prototypes -------------------------------
 // Core scheduler functions
 void SCH_Report_Status(void);
 uint8_t SCH_Delete_Task(const uint8_t);                                        // Delete a task from the scheduler
 uint8_t SCH_Add_Task(void (*pFunction)(void), const uint16_t, const uint16_t); // Add a new task to the scheduler
+uint8_t SCH_Add_Event_Task(void (*pFunction)(void));                           // Add a task that only runs when armed
+uint8_t SCH_Arm_Task(const uint8_t, const uint16_t);                           // Run an event task once after a delay
+void SCH_Disarm_Task(const uint8_t);                                           // Cancel the pending run of an event task
 void SCH_Dispatch_Tasks(void);                                                 // Run a task (if one is ready) put it into main loop
 void SCH_Dispatch_IT(void);                                                    // Put this into Timer ISR, with the period set by the user
+void SCH_Trigger_Task(const uint8_t);                                          // Make a task due now (safe to call from ISR)
+void SCH_Set_Priority(const uint8_t, const uint8_t);                           // Change task priority, SCH_PRIO_xx
+uint8_t SCH_Get_Task_Stats(const uint8_t, sTaskStats *);                       // Copy timing statistics of a task
+uint32_t SCH_Task_Avg_us(const sTaskStats *);                                  // Average execution time of a task
+void SCH_Get_Idle_Stats(uint32_t *, uint32_t *);                               // Wake count and time asleep (ms)
+uint32_t SCH_Take_Busy_Max_us(void);                                           // Longest awake stretch since the last call
+uint32_t SCH_Get_Tick(void);                                                   // Ticks since start
 
 // ------ Public constants -----------------------------------------
 // The maximum number of tasks required at any one time
 // during the execution of the program
 //
 // MUST BE ADJUSTED FOR EACH NEW PROJECT
-#define SCH_MAX_TASKS (16)
+// 6 periodic tasks, 3 event tasks (scan, dual watch, TX/RX switch)
+// and one free slot for one-shot tasks
+#define SCH_MAX_TASKS (10)
 
 #endif
 
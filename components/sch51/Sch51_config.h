@@ -7,6 +7,27 @@
 
 #define SCH_REPORT_ERRORS
 
+// ------ Port hooks ------------------------------------------------
+// May be predefined, e.g. by a host build with a simulated tick
+#ifndef SCH_TIME_US
+#include "millis.h"
+#define SCH_TIME_US() micros() // free-running us counter for execution time
+#endif
+
+#ifndef SCH_ENTER_CRITICAL
+#include "py32f0xx.h"
+#define SCH_ENTER_CRITICAL() uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define SCH_EXIT_CRITICAL() __set_PRIMASK(primask)
+#endif
+
+#ifndef SCH_IDLE
+// Called with interrupts disabled. Sleeps until any interrupt, at most
+// MAX_TICKS scheduler ticks; returns the ticks that passed whose timer
+// interrupt will not be delivered (see osTimer.c)
+uint16_t osTimerIdle(uint16_t maxTicks);
+#define SCH_IDLE(MAX_TICKS) osTimerIdle(MAX_TICKS)
+#endif
+
 
 #ifndef TRUE
 #define FALSE 0
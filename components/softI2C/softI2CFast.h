@@ -0,0 +1,189 @@
+#ifndef __SOFT_I2C_FAST_H__
+#define __SOFT_I2C_FAST_H__
+/*
+ * 软件IIC快速实现,仅头文件
+ * 引脚固定为开漏输出,高电平由上拉释放,读SDA直接读IDR,不再切换输入输出方向
+ * 引脚操作直接写BSRR/BRR,编译期内联,接口与softI2C.h一致,handler只用到isErr
+ * 使用前可重新定义下列宏选择端口/引脚/速率
+ */
+#include "py32f0xx.h"
+#include "softI2C.h"
+
+#ifndef SOFT_I2C_FAST_PORT
+#define SOFT_I2C_FAST_PORT GPIOA
+#endif
+#ifndef SOFT_I2C_FAST_SCL_PIN
+#define SOFT_I2C_FAST_SCL_PIN GPIO_PIN_10
+#endif
+#ifndef SOFT_I2C_FAST_SDA_PIN
+#define SOFT_I2C_FAST_SDA_PIN GPIO_PIN_9
+#endif
+#ifndef SOFT_I2C_FAST_HZ
+#define SOFT_I2C_FAST_HZ 400000 // 总线时钟
+#endif
+#define SOFT_I2C_FAST_LOOP_CYCLES 4 // 延时循环每次迭代的指令周期数(M0+: nop + subs + bne)
+
+#define SOFT_I2C_FAST_SCL_H() (SOFT_I2C_FAST_PORT->BSRR = SOFT_I2C_FAST_SCL_PIN)
+#define SOFT_I2C_FAST_SCL_L() (SOFT_I2C_FAST_PORT->BRR = SOFT_I2C_FAST_SCL_PIN)
+#define SOFT_I2C_FAST_SDA_H() (SOFT_I2C_FAST_PORT->BSRR = SOFT_I2C_FAST_SDA_PIN)
+#define SOFT_I2C_FAST_SDA_L() (SOFT_I2C_FAST_PORT->BRR = SOFT_I2C_FAST_SDA_PIN)
+#define SOFT_I2C_FAST_SDA_READ() ((SOFT_I2C_FAST_PORT->IDR & SOFT_I2C_FAST_SDA_PIN) ? 1 : 0)
+
+// 半个时钟周期的循环次数,softI2cFastInit中按SystemCoreClock计算
+static uint32_t softI2cFastDelayCnt = 1;
+
+static inline void softI2cFastDelay(void)
+{
+    uint32_t i = softI2cFastDelayCnt;
+    while (i--)
+    {
+        __NOP();
+    }
+}
+
+// 引脚时钟需由调用者提前打开
+static inline void softI2cFastInit(SoftI2cHandler *handler)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    uint32_t cnt = SystemCoreClock / (SOFT_I2C_FAST_HZ * 2 * SOFT_I2C_FAST_LOOP_CYCLES);
+    softI2cFastDelayCnt = cnt ? cnt : 1;
+
+    SOFT_I2C_FAST_SCL_H();
+    SOFT_I2C_FAST_SDA_H();
+    GPIO_InitStruct.Pin = SOFT_I2C_FAST_SCL_PIN | SOFT_I2C_FAST_SDA_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    HAL_GPIO_Init(SOFT_I2C_FAST_PORT, &GPIO_InitStruct);
+    handler->isErr = 0;
+}
+
+// 重复START时SCL为低,释放SDA后先保持半个周期再拉高SCL
+static inline void softI2cFastStart(void)
+{
+    SOFT_I2C_FAST_SDA_H();
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SCL_H();
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SDA_L();
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SCL_L();
+}
+
+static inline void softI2cFastStop(void)
+{
+    SOFT_I2C_FAST_SDA_L();
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SCL_H();
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SDA_H();
+    softI2cFastDelay();
+}
+
+// ack: 0应答 1不应答
+static inline void softI2cFastSendAck(unsigned char nack)
+{
+    if (nack)
+    {
+        SOFT_I2C_FAST_SDA_H();
+    }
+    else
+    {
+        SOFT_I2C_FAST_SDA_L();
+    }
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SCL_H();
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SCL_L();
+    SOFT_I2C_FAST_SDA_H();
+}
+
+// 发送一个字节并返回从机应答位,0为应答
+static inline unsigned char softI2cFastSendByte(unsigned char data)
+{
+    unsigned char i, ack;
+    for (i = 0; i < 8; i++)
+    {
+        if (data & 0x80)
+        {
+            SOFT_I2C_FAST_SDA_H();
+        }
+        else
+        {
+            SOFT_I2C_FAST_SDA_L();
+        }
+        data <<= 1;
+        softI2cFastDelay();
+        SOFT_I2C_FAST_SCL_H();
+        softI2cFastDelay();
+        SOFT_I2C_FAST_SCL_L();
+    }
+    SOFT_I2C_FAST_SDA_H(); // 释放SDA,由从机拉低应答
+    softI2cFastDelay();
+    SOFT_I2C_FAST_SCL_H();
+    softI2cFastDelay();
+    ack = SOFT_I2C_FAST_SDA_READ();
+    SOFT_I2C_FAST_SCL_L();
+    return ack;
+}
+
+static inline unsigned char softI2cFastReadByte(void)
+{
+    unsigned char i, data = 0;
+    SOFT_I2C_FAST_SDA_H();
+    for (i = 0; i < 8; i++)
+    {
+        softI2cFastDelay();
+        SOFT_I2C_FAST_SCL_H();
+        softI2cFastDelay();
+        data <<= 1;
+        data |= SOFT_I2C_FAST_SDA_READ();
+        SOFT_I2C_FAST_SCL_L();
+    }
+    return data;
+}
+
+// 读取指定地址的数据 word,高字节在前
+static inline unsigned int softI2cFastReadWordFromAddr(SoftI2cHandler *handler, unsigned char devAddr7Bit, unsigned char reg)
+{
+    unsigned int data;
+    handler->isErr = 0;
+    softI2cFastStart();
+    if (softI2cFastSendByte(devAddr7Bit << 1) || softI2cFastSendByte(reg))
+    {
+        goto err;
+    }
+    softI2cFastStart();
+    if (softI2cFastSendByte(devAddr7Bit << 1 | 0x01))
+    {
+        goto err;
+    }
+    data = softI2cFastReadByte();
+    softI2cFastSendAck(0);
+    data <<= 8;
+    data |= softI2cFastReadByte();
+    softI2cFastSendAck(1);
+    softI2cFastStop();
+    return data;
+err:
+    softI2cFastStop(); // 出错也释放总线
+    handler->isErr = 1;
+    return 0;
+}
+
+// 写入指定地址的数据 word,高字节在前
+static inline void softI2cFastWriteWordToAddr(SoftI2cHandler *handler, unsigned char devAddr7Bit, unsigned char reg, unsigned int data)
+{
+    handler->isErr = 0;
+    softI2cFastStart();
+    if (softI2cFastSendByte(devAddr7Bit << 1) ||
+        softI2cFastSendByte(reg) ||
+        softI2cFastSendByte((unsigned char)(data >> 8)) ||
+        softI2cFastSendByte((unsigned char)data))
+    {
+        handler->isErr = 1;
+    }
+    softI2cFastStop();
+}
+
+#endif
@@ -2,6 +2,10 @@
 #include "main.h"
 #include "osTimer.h"
 
+#define OS_TIMER_PRESCALER 10                                   // TIM16计数时钟 = 内核时钟 / 10
+#define OS_TIMER_TICK_COUNTS 3200                               // 每个调度节拍的计数值
+#define OS_TIMER_IDLE_MAX_TICKS (0x10000 / OS_TIMER_TICK_COUNTS) // 16位计数器一次最多休眠的节拍数
+
 TIM_HandleTypeDef Tim16Handle;
 
 void osTimerInit()
@@ -12,8 +16,8 @@ void osTimerInit()
     /* Enable TIM1 interrupt */
     HAL_NVIC_EnableIRQ(TIM16_IRQn);
     Tim16Handle.Instance = TIM16;
-    Tim16Handle.Init.Period = 3200 - 1;                                  /* Auto-reload value */
-    Tim16Handle.Init.Prescaler = 10 - 1;                               /* Prescaler of 1000-1 */
+    Tim16Handle.Init.Period = OS_TIMER_TICK_COUNTS - 1;                  /* Auto-reload value */
+    Tim16Handle.Init.Prescaler = OS_TIMER_PRESCALER - 1;                 /* Prescaler of 1000-1 */
     Tim16Handle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;             /* Clock not divided */
     Tim16Handle.Init.CounterMode = TIM_COUNTERMODE_UP;                   /* Up counting mode */
     Tim16Handle.Init.RepetitionCounter = 1 - 1;                          /* No repetition */
@@ -29,6 +33,14 @@ void osTimerInit()
         log_e("Error in starting TIM16");
     }
 }
+// 毫秒换算为调度节拍数(向上取整),用于 SCH_Add_Task 的延时参数
+uint16_t osTimerMsToTicks(uint32_t ms)
+{
+    uint32_t countsPerMs = SystemCoreClock / 1000 / OS_TIMER_PRESCALER;
+    uint32_t ticks = (ms * countsPerMs + OS_TIMER_TICK_COUNTS - 1) / OS_TIMER_TICK_COUNTS;
+    return ticks > 0xFFFF ? 0xFFFF : (uint16_t)ticks;
+}
+
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
     if (htim->Instance == TIM16)
@@ -36,3 +48,73 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
         SCH_Dispatch_IT();
     }
 }
+
+// 低功耗空闲,由 SCH_Go_To_Sleep 在关中断下调用
+// 下一个任务还差不到2个节拍时直接WFI,节拍照常
+// 否则暂停SysTick中断,把TIM16的下一次更新推迟到第maxTicks个节拍,WFI直到任意中断唤醒(串口/PTT/TIM16)
+// 唤醒后按TIM16计数补齐HAL节拍,使millis()连续,返回期间经过而TIM16中断不会上报的节拍数
+// Stop模式下TIM16与USART2都停止,无法按时唤醒也会丢失串口数据,因此只使用Sleep模式
+uint16_t osTimerIdle(uint16_t maxTicks)
+{
+    uint32_t load = SysTick->LOAD + 1;
+    uint32_t cntEnter, cntExit, counts, ticks;
+    int32_t progress, wraps;
+
+    if (maxTicks < 2)
+    {
+        __WFI();
+        return 0;
+    }
+    if (maxTicks > OS_TIMER_IDLE_MAX_TICKS)
+    {
+        maxTicks = OS_TIMER_IDLE_MAX_TICKS;
+    }
+
+    HAL_SuspendTick();
+    if (TIM16->SR & TIM_SR_UIF)
+    {
+        // 进入临界区后节拍已到,由挂起的TIM16中断上报,本次不休眠
+        HAL_ResumeTick();
+        return 0;
+    }
+    progress = (int32_t)(load - 1 - SysTick->VAL); // 当前毫秒内已走过的内核周期
+    cntEnter = TIM16->CNT;
+    TIM16->ARR = (uint32_t)maxTicks * OS_TIMER_TICK_COUNTS - 1;
+    if (TIM16->SR & TIM_SR_UIF)
+    {
+        // 读CNT与写ARR之间按旧ARR回绕,CNT已从0重新计数,cntEnter失效
+        TIM16->ARR = OS_TIMER_TICK_COUNTS - 1;
+        HAL_ResumeTick();
+        return 0;
+    }
+    __DSB();
+    __WFI();
+
+    TIM16->CR1 &= ~TIM_CR1_CEN; // 修正计数时暂停,避免CNT越过新的ARR
+    cntExit = TIM16->CNT;
+    progress -= (int32_t)(load - 1 - SysTick->VAL);
+    if (TIM16->SR & TIM_SR_UIF)
+    {
+        // 到达设定节拍,最后一个节拍由挂起的TIM16中断上报
+        counts = (uint32_t)maxTicks * OS_TIMER_TICK_COUNTS - cntEnter + cntExit;
+        ticks = maxTicks - 1;
+    }
+    else
+    {
+        // 被其它中断提前唤醒
+        counts = cntExit - cntEnter;
+        ticks = cntExit / OS_TIMER_TICK_COUNTS;
+        TIM16->CNT = cntExit - ticks * OS_TIMER_TICK_COUNTS;
+    }
+    TIM16->ARR = OS_TIMER_TICK_COUNTS - 1;
+    TIM16->CR1 |= TIM_CR1_CEN;
+
+    // 休眠期间SysTick回绕次数,按进入/退出时的相位精确计算,四舍五入吸收两个时钟源的读取误差
+    wraps = (progress + (int32_t)(counts * OS_TIMER_PRESCALER) + (int32_t)(load / 2)) / (int32_t)load;
+    while (wraps-- > 0)
+    {
+        HAL_IncTick();
+    }
+    HAL_ResumeTick();
+    return (uint16_t)ticks;
+}
@@ -4,4 +4,6 @@
 void osTimerInit(void);
 void osTimerStart(void);
 void osTimerStop(void);
+uint16_t osTimerIdle(uint16_t maxTicks); // tickless sleep, see SCH_Go_To_Sleep
+uint16_t osTimerMsToTicks(uint32_t ms);  // scheduler ticks covering ms, rounded up
 #endif
@@ -0,0 +1,124 @@
+/*
+ *BK4802 PLL主机端测试: 支持频段内每个6.25kHz信道(包含12.5kHz信道),收发两个方向及几个频偏,
+ *整数分频字必须与128位精确参考值逐位一致;同时给出旧的单精度浮点算法的误差作对比
+ */
+#include "BK4802Pll.h"
+#include <stdio.h>
+
+#define CHANNEL_STEP_HZ 6250
+
+static int failures = 0;
+
+// floor(loHz * nDiv * 2^24 / 21.25MHz)
+static uint32_t refWord(uint32_t loHz, uint8_t nDiv)
+{
+    unsigned __int128 vco = (unsigned __int128)loHz * nDiv;
+    return (uint32_t)((vco << 24) / BK4802_CRYSTAL_HZ);
+}
+
+// 原实现: adjFreq * nDiv * TWO24 / CRYSTAL,频率单位MHz,单精度
+static uint32_t floatWord(float loMHz, uint8_t nDiv)
+{
+    return (uint32_t)(loMHz * (float)nDiv * 16777216.0f / 21.25f);
+}
+
+int main(void)
+{
+    static const int32_t offsets[] = {0, -5000, 3250};
+    uint32_t checked = 0;
+    uint32_t floatWrong = 0;
+    uint32_t floatMaxErrHz = 0;
+    uint32_t floatMaxErrAt = 0;
+    uint16_t regs[3];
+    for (uint8_t b = 0; b < BK4802_BAND_NUM; b++)
+    {
+        // 第一个在频段内的信道
+        const BK4802Band *band = NULL;
+        uint32_t minHz = 0, maxHz = 0;
+        for (uint32_t hz = 24000000UL; hz <= 512000000UL; hz += 1000000UL)
+        {
+            if (BK4802PllBandIndex(hz) == b)
+            {
+                band = BK4802PllBand(hz);
+                minHz = band->minHz;
+                maxHz = band->maxHz;
+                break;
+            }
+        }
+        if (band == NULL)
+        {
+            printf("FAIL band %d not reachable\n", b);
+            failures++;
+            continue;
+        }
+        for (uint32_t hz = (minHz + CHANNEL_STEP_HZ - 1) / CHANNEL_STEP_HZ * CHANNEL_STEP_HZ; hz <= maxHz; hz += CHANNEL_STEP_HZ)
+        {
+            if (BK4802PllBand(hz) != band)
+            {
+                continue; // 重叠区由前面的频段处理
+            }
+            if (BK4802MHzToHz((float)(hz / 1e6)) != hz)
+            {
+                printf("FAIL MHzToHz %lu -> %lu\n", (unsigned long)hz, (unsigned long)BK4802MHzToHz((float)(hz / 1e6)));
+                failures++;
+            }
+            for (int tx = 0; tx < 2; tx++)
+            {
+                for (unsigned o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++)
+                {
+                    uint32_t rfHz = (uint32_t)((int32_t)hz + offsets[o]);
+                    const BK4802Band *rfBand = BK4802PllBand(rfHz);
+                    uint32_t loHz = tx ? rfHz : rfHz - BK4802_IF_HZ;
+                    uint32_t word;
+                    if (rfBand == NULL)
+                    {
+                        if (BK4802PllRegs(rfHz, tx, regs))
+                        {
+                            printf("FAIL %lu Hz out of band accepted\n", (unsigned long)rfHz);
+                            failures++;
+                        }
+                        continue;
+                    }
+                    if (!BK4802PllRegs(rfHz, tx, regs))
+                    {
+                        printf("FAIL %lu Hz rejected\n", (unsigned long)rfHz);
+                        failures++;
+                        continue;
+                    }
+                    word = ((uint32_t)regs[0] << 16) | regs[1];
+                    checked++;
+                    if (word != refWord(loHz, rfBand->nDiv) || regs[2] != rfBand->reg2)
+                    {
+                        printf("FAIL %lu Hz tx:%d word %08lx ref %08lx\n", (unsigned long)rfHz, tx,
+                               (unsigned long)word, (unsigned long)refWord(loHz, rfBand->nDiv));
+                        failures++;
+                    }
+                    if (offsets[o] == 0)
+                    {
+                        uint32_t fw = floatWord((float)(loHz / 1e6), rfBand->nDiv);
+                        if (fw != word)
+                        {
+                            // 分频字1 LSB = 21.25MHz / 2^24 / nDiv
+                            uint32_t diff = fw > word ? fw - word : word - fw;
+                            uint32_t errHz = (uint32_t)((uint64_t)diff * BK4802_CRYSTAL_HZ / 16777216UL / rfBand->nDiv);
+                            floatWrong++;
+                            if (errHz > floatMaxErrHz)
+                            {
+                                floatMaxErrHz = errHz;
+                                floatMaxErrAt = hz;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    // 请求中提到的438.5MHz
+    BK4802PllRegs(438500000UL, 1, regs);
+    printf("438.5MHz tx word int %08lx float %08lx\n",
+           (unsigned long)(((uint32_t)regs[0] << 16) | regs[1]), (unsigned long)floatWord(438.5f, 4));
+    printf("PLL: %lu words bit-exact, float differs on %lu (max %lu Hz at %lu Hz)\n", (unsigned long)checked,
+           (unsigned long)floatWrong, (unsigned long)floatMaxErrHz, (unsigned long)floatMaxErrAt);
+    printf("BK4802PllTest: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
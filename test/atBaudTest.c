@@ -0,0 +1,159 @@
+/*
+ *AT+BAUD主机端测试: 真实的at.c/atCommand.c/kvStore.c运行在uartSim.c的模拟时钟和串口上
+ *切换: 回复按旧波特率发出后才切换
+ *确认: 主机用新波特率在确认窗口内发送有效指令,新波特率写入kvStore
+ *超时: 主机无法使用新波特率,确认窗口结束后回退到切换前的波特率,不保存
+ *重新加载: 重新初始化kvStore和串口,使用已确认的波特率
+ */
+#include "uartSim.h"
+#include "at.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_PAGES 4
+#define SIM_REPLY_US 100000 // 足够收发一条指令和回复
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                  \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);   \
+            printf(__VA_ARGS__);                          \
+            printf("\n");                                 \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+// RAM中的Flash,与kvStoreTest相同: 擦除为0xFF,编程只能把1变成0
+static uint8_t simFlash[SIM_PAGES * KV_STORE_PAGE_SIZE];
+
+static int simErase(uint16_t page)
+{
+    memset(&simFlash[page * KV_STORE_PAGE_SIZE], 0xFF, KV_STORE_PAGE_SIZE);
+    return 0;
+}
+
+static int simProgram(uint16_t page, const uint32_t *data)
+{
+    uint32_t *p = (uint32_t *)&simFlash[page * KV_STORE_PAGE_SIZE];
+    for (int i = 0; i < KV_STORE_PAGE_SIZE / 4; i++)
+    {
+        p[i] &= data[i];
+    }
+    return 0;
+}
+
+static const KvStorePort simPort = {
+    .base = simFlash,
+    .pages = SIM_PAGES,
+    .erase = simErase,
+    .program = simProgram,
+};
+
+static SHARECom com;
+static char reply[256];
+
+// 与main.c中syncTask的E_AT_CMD_BAUD分支相同: 回复已入队,切换波特率
+static void syncTaskSim(void)
+{
+    ATCmd atCmd;
+    while ((atCmd = FetchATCmd()) != E_AT_CMD_NONE)
+    {
+        if (atCmd == E_AT_CMD_BAUD)
+        {
+            atBaudSwitch(com.baud);
+        }
+    }
+}
+
+// 主机发送一行并等待回复
+static const char *hostCmd(const char *line)
+{
+    uartSimHostSend(line);
+    simUntil(simUs + SIM_REPLY_US);
+    uartSimHostRecv(reply, sizeof(reply));
+    return reply;
+}
+
+static uint32_t savedBaud(void)
+{
+    uint32_t baud = 0;
+    kvStoreGet(SETTINGS_KEY_BAUD, &baud, sizeof(baud));
+    return baud;
+}
+
+static void testSwitchConfirm(void)
+{
+    CHECK(uartSimBaud() == UART_BAUD_DEFAULT, "initial baud %u", (unsigned)uartSimBaud());
+    CHECK(strcmp(hostCmd("AT+BAUD=9600\r\n"), "FAILED\n") == 0, "unsupported baud: %s", reply);
+    CHECK(uartSimBaud() == UART_BAUD_DEFAULT, "switched to an unsupported baud");
+
+    // 回复按旧波特率发出,主机能读到
+    CHECK(strcmp(hostCmd("AT+BAUD=115200\r\n"), "SUCCESS\n") == 0, "switch reply: %s", reply);
+    CHECK(uartSimBaud() == 115200 && com.baud == 115200, "baud %u after switch", (unsigned)uartSimBaud());
+    CHECK(savedBaud() == 0, "saved before confirm");
+
+    // 旧波特率的指令在新波特率下是乱码,不能确认
+    CHECK(hostCmd("AT+SQL?\r\n")[0] == '\0', "reply to a mismatched command: %s", reply);
+    CHECK(savedBaud() == 0, "confirmed by a mismatched command");
+
+    uartSimHostBaud(115200);
+    CHECK(strcmp(hostCmd("AT+SQL?\r\n"), "SQL:5\nOK\n") == 0, "reply at the new baud: %s", reply);
+    CHECK(savedBaud() == 115200, "confirmed baud saved as %u", (unsigned)savedBaud());
+
+    // 已确认,确认窗口结束后不回退
+    simUntil(simUs + (UART_BAUD_CONFIRM_MS + 500) * 1000);
+    CHECK(uartSimBaud() == 115200, "confirmed baud fell back to %u", (unsigned)uartSimBaud());
+}
+
+static void testTimeoutFallback(void)
+{
+    uint32_t switchUs;
+    CHECK(strcmp(hostCmd("AT+BAUD=230400\r\n"), "SUCCESS\n") == 0, "switch reply: %s", reply);
+    switchUs = simUs;
+    CHECK(uartSimBaud() == 230400, "baud %u after switch", (unsigned)uartSimBaud());
+
+    // 主机停留在115200,确认窗口内只有乱码
+    CHECK(hostCmd("AT+SQL?\r\n")[0] == '\0', "reply to a mismatched command: %s", reply);
+    simUntil(switchUs + (UART_BAUD_CONFIRM_MS - 200) * 1000);
+    CHECK(uartSimBaud() == 230400, "fell back %u ms early", (unsigned)((simUs - switchUs) / 1000));
+
+    simUntil(switchUs + (UART_BAUD_CONFIRM_MS + 200) * 1000);
+    CHECK(uartSimBaud() == 115200 && com.baud == 115200, "fallback to %u, com %u", (unsigned)uartSimBaud(),
+          (unsigned)com.baud);
+    CHECK(savedBaud() == 115200, "unconfirmed baud saved as %u", (unsigned)savedBaud());
+    CHECK(strcmp(hostCmd("AT+SQL?\r\n"), "SQL:5\nOK\n") == 0, "reply after fallback: %s", reply);
+}
+
+// 重新上电: 只有写入Flash的已确认波特率生效
+static void testReload(void)
+{
+    CHECK(kvStoreFlush() == 0, "flush");
+    CHECK(kvStoreInit(&simPort), "reload kvStore");
+    CHECK(savedBaud() == 115200, "reloaded baud %u", (unsigned)savedBaud());
+    com.baud = 0;
+    atInit(&com);
+    CHECK(uartSimBaud() == 115200 && com.baud == 115200, "baud %u after reload, com %u", (unsigned)uartSimBaud(),
+          (unsigned)com.baud);
+    CHECK(strcmp(hostCmd("AT+SQL?\r\n"), "SQL:5\nOK\n") == 0, "reply after reload: %s", reply);
+}
+
+int main(void)
+{
+    uartSimInit();
+    memset(simFlash, 0xFF, sizeof(simFlash));
+    kvStoreInit(&simPort);
+    com.sql = 5;
+    atInit(&com);
+    atSetTaskId(SCH_Add_Task(atTask, 0, 10));
+    SCH_Add_Task(syncTaskSim, 0, 10);
+
+    testSwitchConfirm();
+    testTimeoutFallback();
+    testReload();
+    printf("atBaudTest: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
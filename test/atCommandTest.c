@@ -0,0 +1,112 @@
+/*
+ *AT解析器回归测试: 逐行送入语料,比较应答、产生的设置事件和SHARECom中的结果
+ *语料的期望结果由改为命令表之前的if/else解析器生成,表格解析器必须逐条一致,
+ *有意改变的行为在语料中单独注明
+ *语料格式: 命令<TAB>期望结果, #开头为注释
+ */
+#include "atCommand.h"
+#include <stdio.h>
+#include <string.h>
+
+extern uint32_t atTestMs;
+
+static char inBuf[300];
+static uint16_t inLen = 0;
+static uint16_t inPos = 0;
+static char outBuf[512];
+static uint16_t outLen = 0;
+
+static uint16_t testRecv(uint8_t *buf, uint16_t len)
+{
+    uint16_t n = inLen - inPos;
+    if (n > len)
+    {
+        n = len;
+    }
+    memcpy(buf, inBuf + inPos, n);
+    inPos += n;
+    return n;
+}
+
+static void testSend(uint8_t *buf, uint16_t len)
+{
+    if (outLen + len < sizeof(outBuf))
+    {
+        memcpy(outBuf + outLen, buf, len);
+        outLen += len;
+    }
+}
+
+// 执行一条命令,结果格式: 应答(换行替换为|) ev[设置事件] 相关SHARECom字段
+static void runLine(SHARECom *com, const char *line, char *result, size_t size)
+{
+    char ev[64] = "";
+    ATCmd cmd;
+    inLen = (uint16_t)snprintf(inBuf, sizeof(inBuf), "%s\r\n", line);
+    inPos = 0;
+    outLen = 0;
+    atTestMs += 100;
+    ATCmdHandler(com);
+    outBuf[outLen] = '\0';
+    for (char *p = outBuf; *p; p++)
+    {
+        if (*p == '\n')
+        {
+            *p = '|';
+        }
+    }
+    while ((cmd = FetchATCmd()) != E_AT_CMD_NONE)
+    {
+        snprintf(ev + strlen(ev), sizeof(ev) - strlen(ev), "%d ", cmd);
+    }
+    snprintf(result, size, "%s ev[%s] sql=%d tx=%.4f rx=%.4f vol=%d/%d tune=%d pwr=%d rf=%d", outBuf, ev, com->sql,
+             com->txFreq, com->rxFreq, com->rxVol, com->txVol, (int)com->freqTune, com->txPwr, com->rfEnable);
+}
+
+int main(int argc, char **argv)
+{
+    static SHARECom com;
+    ATCmdPort port = {testRecv, testSend};
+    char line[512];
+    char result[512];
+    int cases = 0;
+    int failures = 0;
+    FILE *fp = fopen(argc > 1 ? argv[1] : "atCorpus.txt", "r");
+    if (fp == NULL)
+    {
+        printf("atCommandTest: no corpus\n");
+        return 1;
+    }
+    com.bandCap = 3;
+    com.sql = 5;
+    com.txFreq = 438.5f;
+    com.rxFreq = 145.1f;
+    com.rxVol = 7;
+    com.txVol = 6;
+    com.freqTune = -120;
+    com.txPwr = 1;
+    com.smeter = 4;
+    com.rfEnable = 1;
+    com.baud = 19200;
+    ATCmdInit(&port);
+    while (fgets(line, sizeof(line), fp))
+    {
+        char *expect;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0' || (expect = strchr(line, '\t')) == NULL)
+        {
+            continue;
+        }
+        *expect++ = '\0';
+        runLine(&com, line, result, sizeof(result));
+        cases++;
+        if (strcmp(result, expect) != 0)
+        {
+            printf("FAIL \"%s\"\n  expect: %s\n  got:    %s\n", line, expect, result);
+            failures++;
+        }
+    }
+    fclose(fp);
+    printf("atCommandTest: %d cases, %s\n", cases, failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+/*
+ *atCommandTest单独测试解析器时,at.c、Sch51和时钟的桩函数,返回固定值
+ *uartTxSimTest/atBaudTest链接真实的at.c、Sch51.c和模拟时钟,不使用本文件
+ */
+#include "at.h"
+
+uint32_t atTestMs = 0;
+
+uint32_t millis(void)
+{
+    return atTestMs;
+}
+
+void atGetTxStats(uint32_t *queued, uint32_t *dropped, uint32_t *peak)
+{
+    *queued = 1;
+    *dropped = 2;
+    *peak = 3;
+}
+
+xBool atBaudIsValid(uint32_t baud)
+{
+    return baud == 19200 || baud == 115200 || baud == 230400 || baud == 460800 || baud == 921600;
+}
+
+void atBaudConfirm(void)
+{
+}
+
+void atGetLatencyHist(uint32_t *hist)
+{
+    for (int i = 0; i < AT_LATENCY_HIST_SIZE; i++)
+    {
+        hist[i] = i;
+    }
+}
+
+uint16_t atSendFree(void)
+{
+    return UART_SEND_BUF_SIZE;
+}
+
+uint8_t SCH_Get_Task_Stats(const uint8_t index, sTaskStats *stats)
+{
+    if (index > 1)
+    {
+        return RETURN_ERROR;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->Runs = 10 + index;
+    stats->Bcet_us = 5;
+    stats->Wcet_us = 900;
+    stats->Total_us = 1000;
+    stats->Hist[0] = 3;
+    stats->Hist[SCH_PROF_HIST_SIZE - 1] = 1;
+    return RETURN_NORMAL;
+}
+
+uint32_t SCH_Task_Avg_us(const sTaskStats *stats)
+{
+    return stats->Runs ? (uint32_t)(stats->Total_us / stats->Runs) : 0;
+}
+
+void SCH_Get_Idle_Stats(uint32_t *wakeups, uint32_t *sleepMs)
+{
+    *wakeups = 1234;
+    *sleepMs = atTestMs / 2;
+}
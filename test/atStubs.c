@@ -0,0 +1,82 @@
+/*
+ *atCommand.c主机端测试用的桩函数: 解析器只需要这些模块提供查询接口,返回固定值
+ *at.c、Sch51和时钟的桩函数在atPortStubs.c中,使用真实模块的测试不链接它
+ */
+#include "at.h"
+#include "BK4802.h"
+#include "cpuLoad.h"
+#include "channel.h"
+#include "scan.h"
+#include "dualWatch.h"
+#include "radio.h"
+
+void elog_output(uint8_t level, const char *tag, const char *file, const char *func, const long line, const char *format, ...)
+{
+}
+
+void BK4802GetPllCacheStats(uint32_t *hit, uint32_t *miss)
+{
+    *hit = 3;
+    *miss = 4;
+}
+
+void cpuLoadGet(CpuLoadStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->load1s = 123;
+    stats->load10s = 456;
+    stats->busyMaxUs = 7890;
+    stats->isrMaxUs = 44;
+}
+
+void radioGetTrxLatency(uint32_t *pinLastUs, uint32_t *pinMaxUs, uint32_t *lastUs, uint32_t *maxUs)
+{
+    *pinLastUs = 100200;
+    *pinMaxUs = 101000;
+    *lastUs = 130500;
+    *maxUs = 140000;
+}
+
+static ChannelEntry chStub[CHANNEL_NUM];
+static uint32_t chUsed = 0;
+
+const ChannelEntry *channelGet(uint8_t index)
+{
+    return (index < CHANNEL_NUM && (chUsed & (1UL << index))) ? &chStub[index] : NULL;
+}
+
+xBool channelSave(uint8_t index, ChannelEntry *entry)
+{
+    if (index >= CHANNEL_NUM)
+    {
+        return xFalse;
+    }
+    chStub[index] = *entry;
+    chUsed |= 1UL << index;
+    return xTrue;
+}
+
+uint32_t channelUsedMask(void)
+{
+    return chUsed;
+}
+
+void scanGetStatus(ScanStatus *status)
+{
+    memset(status, 0, sizeof(*status));
+}
+
+uint16_t scanGetOccupancy(uint8_t index)
+{
+    return 0;
+}
+
+uint16_t scanGetSettleUs(uint8_t band)
+{
+    return 0;
+}
+
+void watchGetStatus(WatchStatus *status)
+{
+    memset(status, 0, sizeof(*status));
+}
@@ -0,0 +1,185 @@
+/*
+ *binProto主机端测试: 随机帧编码后逐字节解码必须还原;
+ *在帧之间插入含SYNC的随机噪声,CRC错误后从缓冲中的下一个SYNC重新同步,每一帧都不能丢
+ */
+#include "binProto.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_NUM 20000
+#define NOISE_MAX 12
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                \
+    do                                                  \
+    {                                                   \
+        if (!(cond))                                    \
+        {                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            failures++;                                 \
+        }                                               \
+    } while (0)
+
+static void randomFrame(BinFrame *frame, uint8_t seq)
+{
+    uint8_t tlvNum = (uint8_t)(rand() % 6);
+    binFrameInit(frame, (uint8_t)rand(), seq);
+    for (uint8_t i = 0; i < tlvNum; i++)
+    {
+        uint8_t size = (uint8_t)(1 + rand() % 4);
+        if (!binTlvPut(frame, (uint8_t)rand(), (uint32_t)rand() ^ ((uint32_t)rand() << 16), size))
+        {
+            break;
+        }
+    }
+}
+
+static int frameEqual(const BinFrame *a, const BinFrame *b)
+{
+    return a->op == b->op && a->seq == b->seq && a->tlvLen == b->tlvLen && memcmp(a->tlv, b->tlv, a->tlvLen) == 0;
+}
+
+static void testTlv(void)
+{
+    BinFrame frame;
+    uint8_t pos = 0, tag, len;
+    const uint8_t *value;
+    uint8_t bytes[3] = {1, 2, 3};
+    binFrameInit(&frame, BIN_OP_SET, 7);
+    CHECK(binTlvPut(&frame, BIN_TAG_TXFREQ, 438500000UL, 4), "put u32");
+    CHECK(binTlvPut(&frame, BIN_TAG_FREQTUNE, (uint32_t)-500, 4), "put i32");
+    CHECK(binTlvPutBytes(&frame, BIN_TAG_TELEMETRY, bytes, 3), "put bytes");
+    CHECK(binTlvNext(&frame, &pos, &tag, &len, &value) == 1 && tag == BIN_TAG_TXFREQ && len == 4 &&
+              binTlvGetU32(value, len) == 438500000UL,
+          "u32 tlv");
+    CHECK(binTlvNext(&frame, &pos, &tag, &len, &value) == 1 && (int32_t)binTlvGetU32(value, len) == -500, "i32 tlv");
+    CHECK(binTlvNext(&frame, &pos, &tag, &len, &value) == 1 && len == 3 && memcmp(value, bytes, 3) == 0, "bytes tlv");
+    CHECK(binTlvNext(&frame, &pos, &tag, &len, &value) == 0, "tlv end");
+    // L超出帧长度
+    frame.tlv[1] = 40;
+    pos = 0;
+    CHECK(binTlvNext(&frame, &pos, &tag, &len, &value) == -1, "truncated tlv");
+    // 超出最大长度
+    binFrameInit(&frame, BIN_OP_SET, 0);
+    while (binTlvPut(&frame, 1, 0, 4))
+    {
+    }
+    CHECK(frame.tlvLen <= BIN_PROTO_MAX_TLV, "tlv overflow");
+}
+
+// 校验值取自CCITT-FALSE的标准测试向量
+static void testCrc(void)
+{
+    CHECK(binProtoCrc16((const uint8_t *)"123456789", 9) == 0x29B1, "crc16 check value");
+}
+
+// 噪声为SYNC加一个合法长度,是最难的情况: 解码器会把后面的真实帧当作这一帧的内容
+static uint16_t putNoise(uint8_t *out)
+{
+    uint16_t num = (uint16_t)(rand() % (NOISE_MAX + 1));
+    for (uint16_t i = 0; i < num; i++)
+    {
+        switch (rand() % 4)
+        {
+        case 0:
+            out[i] = BIN_PROTO_SYNC;
+            break;
+        case 1:
+            out[i] = (uint8_t)(2 + rand() % (BIN_PROTO_MAX_BODY - 1));
+            break;
+        default:
+            out[i] = (uint8_t)rand();
+            break;
+        }
+    }
+    return num;
+}
+
+static void testStream(int noise)
+{
+    static uint8_t stream[FRAME_NUM * (BIN_PROTO_MAX_FRAME + NOISE_MAX) + 64];
+    static BinFrame sent[FRAME_NUM];
+    BinDecoder dec;
+    BinFrame frame;
+    uint32_t len = 0, got = 0, crcErrors = 0;
+    for (uint32_t i = 0; i < FRAME_NUM; i++)
+    {
+        if (noise)
+        {
+            len += putNoise(&stream[len]);
+        }
+        randomFrame(&sent[i], (uint8_t)i);
+        len += binProtoEncode(&sent[i], &stream[len], BIN_PROTO_MAX_FRAME);
+    }
+    // 末尾补0,让最后一个假帧头收满长度后报CRC错误
+    memset(&stream[len], 0, 64);
+    len += 64;
+    binProtoDecoderInit(&dec);
+    for (uint32_t i = 0; i < len; i++)
+    {
+        int ret = binProtoFeed(&dec, stream[i], &frame);
+        if (ret < 0)
+        {
+            crcErrors++;
+        }
+        else if (ret > 0)
+        {
+            if (got >= FRAME_NUM || !frameEqual(&frame, &sent[got]))
+            {
+                CHECK(0, "frame %u mismatch (noise:%d)", (unsigned)got, noise);
+                return;
+            }
+            got++;
+        }
+    }
+    CHECK(got == FRAME_NUM, "noise:%d decoded %u of %u frames", noise, (unsigned)got, FRAME_NUM);
+    CHECK(noise || crcErrors == 0, "crc errors on a clean stream");
+    printf("binProto: %u frames, noise:%d, %u crc errors, all recovered\n", (unsigned)got, noise, (unsigned)crcErrors);
+}
+
+// 单个假帧头吞掉了后面的两个完整帧
+static void testResync(void)
+{
+    uint8_t stream[2 + BIN_PROTO_MAX_FRAME * 2 + BIN_PROTO_MAX_BODY];
+    BinFrame a, b, frame;
+    BinDecoder dec;
+    uint16_t len = 0;
+    int ret, frames = 0;
+    binFrameInit(&a, BIN_OP_GET, 1);
+    binTlvPut(&a, BIN_TAG_SQL, 0, 0);
+    binFrameInit(&b, BIN_OP_SET, 2);
+    binTlvPut(&b, BIN_TAG_SQL, 3, 1);
+    stream[len++] = BIN_PROTO_SYNC;
+    stream[len++] = BIN_PROTO_MAX_BODY;
+    len += binProtoEncode(&a, &stream[len], BIN_PROTO_MAX_FRAME);
+    len += binProtoEncode(&b, &stream[len], BIN_PROTO_MAX_FRAME);
+    memset(&stream[len], 0, BIN_PROTO_MAX_BODY);
+    len += BIN_PROTO_MAX_BODY;
+    binProtoDecoderInit(&dec);
+    for (uint16_t i = 0; i < len; i++)
+    {
+        ret = binProtoFeed(&dec, stream[i], &frame);
+        if (ret > 0)
+        {
+            CHECK(frameEqual(&frame, frames == 0 ? &a : &b), "resync frame %d", frames);
+            frames++;
+        }
+    }
+    CHECK(frames == 2, "resync recovered %d frames", frames);
+}
+
+int main(void)
+{
+    srand(2);
+    testCrc();
+    testTlv();
+    testResync();
+    testStream(0);
+    testStream(1);
+    printf("binProtoTest: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+/*
+ *kvStore主机端测试: RAM模拟Flash页区,随机修改后写入,在任意一次编程/擦除中途掉电,
+ *重新上电后读出的键值必须完整等于上一次写入成功的内容或正在写入的内容
+ */
+#include "kvStore.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_PAGES 4
+#define SIM_KEYS 12
+#define SIM_MAX_LEN 8
+#define SIM_ROUNDS 20000
+
+typedef struct
+{
+    uint8_t len; // 0: 不存在
+    uint8_t val[SIM_MAX_LEN];
+} SimEntry;
+
+static uint8_t simFlash[SIM_PAGES * KV_STORE_PAGE_SIZE];
+static int simBudget = -1; // 剩余可完成的字编程/擦除次数,-1不掉电
+static int simPowerLost = 0;
+static int failures = 0;
+
+#define CHECK(cond, ...)                                  \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);   \
+            printf(__VA_ARGS__);                          \
+            printf("\n");                                 \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+// 消耗一次操作,预算用完即掉电
+static int simStep(void)
+{
+    if (simPowerLost)
+    {
+        return 0;
+    }
+    if (simBudget == 0)
+    {
+        simPowerLost = 1;
+        return 0;
+    }
+    if (simBudget > 0)
+    {
+        simBudget--;
+    }
+    return 1;
+}
+
+static int simErase(uint16_t page)
+{
+    uint8_t *p = &simFlash[page * KV_STORE_PAGE_SIZE];
+    if (!simStep())
+    {
+        // 擦除中途掉电,页内容不确定
+        for (int i = 0; i < KV_STORE_PAGE_SIZE; i++)
+        {
+            p[i] |= (uint8_t)rand();
+        }
+        return -1;
+    }
+    memset(p, 0xFF, KV_STORE_PAGE_SIZE);
+    return 0;
+}
+
+static int simProgram(uint16_t page, const uint32_t *data)
+{
+    uint32_t *p = (uint32_t *)&simFlash[page * KV_STORE_PAGE_SIZE];
+    for (int i = 0; i < KV_STORE_PAGE_SIZE / 4; i++)
+    {
+        if (!simStep())
+        {
+            // 编程中途掉电,当前字只有部分位被清零
+            p[i] &= data[i] | (uint32_t)rand();
+            return -1;
+        }
+        p[i] &= data[i]; // Flash编程只能把1变成0
+    }
+    return 0;
+}
+
+static const KvStorePort simPort = {
+    .base = simFlash,
+    .pages = SIM_PAGES,
+    .erase = simErase,
+    .program = simProgram,
+};
+
+static int simMatch(const SimEntry *model)
+{
+    uint8_t buf[SIM_MAX_LEN];
+    for (uint8_t key = 0; key < SIM_KEYS; key++)
+    {
+        if (model[key].len == 0)
+        {
+            for (uint8_t len = 1; len <= SIM_MAX_LEN; len++)
+            {
+                if (kvStoreGet(key, buf, len))
+                {
+                    return 0;
+                }
+            }
+        }
+        else if (!kvStoreGet(key, buf, model[key].len) || memcmp(buf, model[key].val, model[key].len) != 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void testSpaceCheck(void)
+{
+    uint8_t value[SIM_MAX_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t big[KV_STORE_DATA_SIZE];
+    uint8_t buf[SIM_MAX_LEN];
+    memset(simFlash, 0xFF, sizeof(simFlash));
+    CHECK(kvStoreInit(&simPort) == 0, "blank flash must be empty");
+    CHECK(kvStoreSet(1, value, 4), "set key 1");
+    // 剩余空间只够再加几字节,key1改为更长的长度放不下
+    memset(big, 0x5A, sizeof(big));
+    CHECK(kvStoreSet(2, big, KV_STORE_DATA_SIZE - 6 - 2), "fill store");
+    CHECK(kvStoreSet(1, value, 8) == 0, "longer value must not fit");
+    CHECK(kvStoreGet(1, buf, 4) && memcmp(buf, value, 4) == 0, "old value must survive a failed resize");
+    CHECK(kvStoreSet(1, value, 3), "shorter value fits");
+    CHECK(kvStoreGet(1, buf, 3) && memcmp(buf, value, 3) == 0, "resized value");
+    CHECK(kvStoreSet(KV_STORE_KEY_END, value, 1) == 0, "end key is reserved");
+}
+
+static void testPowerCut(void)
+{
+    SimEntry committed[SIM_KEYS];
+    SimEntry pending[SIM_KEYS];
+    uint32_t cuts = 0;
+    uint32_t rolledBack = 0;
+    memset(simFlash, 0xFF, sizeof(simFlash));
+    memset(committed, 0, sizeof(committed));
+    kvStoreInit(&simPort);
+    for (uint32_t round = 0; round < SIM_ROUNDS; round++)
+    {
+        int changes = 1 + rand() % 4;
+        memcpy(pending, committed, sizeof(pending));
+        for (int i = 0; i < changes; i++)
+        {
+            uint8_t key = (uint8_t)(rand() % SIM_KEYS);
+            uint8_t len = (uint8_t)(1 + rand() % SIM_MAX_LEN);
+            uint8_t val[SIM_MAX_LEN];
+            for (int j = 0; j < len; j++)
+            {
+                val[j] = (uint8_t)rand();
+            }
+            if (kvStoreSet(key, val, len))
+            {
+                pending[key].len = len;
+                memcpy(pending[key].val, val, len);
+            }
+        }
+        // 大约一半的写入在中途掉电,掉电点覆盖擦除和编程的每一步
+        simPowerLost = 0;
+        simBudget = (rand() & 1) ? rand() % (KV_STORE_PAGE_SIZE / 4 + 2) : -1;
+        if (kvStoreFlush() == 0 && !simPowerLost)
+        {
+            memcpy(committed, pending, sizeof(committed));
+        }
+        if (!simPowerLost)
+        {
+            CHECK(simMatch(committed), "round %u: lost data without power cut", (unsigned)round);
+            continue;
+        }
+        cuts++;
+        simPowerLost = 0;
+        simBudget = -1;
+        kvStoreInit(&simPort);
+        if (simMatch(pending))
+        {
+            memcpy(committed, pending, sizeof(committed));
+        }
+        else if (simMatch(committed))
+        {
+            rolledBack++;
+        }
+        else
+        {
+            CHECK(0, "round %u: store is neither old nor new after power cut", (unsigned)round);
+            return;
+        }
+    }
+    printf("kvStore power cut: %u rounds, %u cuts, %u rolled back\n", SIM_ROUNDS, (unsigned)cuts, (unsigned)rolledBack);
+}
+
+int main(void)
+{
+    srand(1);
+    testSpaceCheck();
+    testPowerCut();
+    printf("kvStoreTest: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
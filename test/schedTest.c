@@ -0,0 +1,329 @@
+/*
+ *Sch51主机端测试: 模拟时钟驱动节拍中断,任务按设定的执行时间推进时钟,验证按优先级调度的最坏延迟
+ *任务在主循环中运行且不可抢占,一个任务从就绪到开始运行最多等待一次更低优先级任务的运行
+ *PTT边沿在随机时刻由"中断"触发高优先级任务,与固件中EXTI触发radioTask相同
+ */
+#include "Sch51.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TICK_US 720 // 与osTimer的节拍一致
+#define SIM_TICKS 200000
+
+#define HI_MIN_US 100
+#define HI_MAX_US 300
+#define DEF_MIN_US 200
+#define DEF_MAX_US 1500
+#define LO_MIN_US 500
+#define LO_MAX_US 3000
+#define EDGE_MIN_US 2000
+#define EDGE_MAX_US 20000
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                  \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);   \
+            printf(__VA_ARGS__);                          \
+            printf("\n");                                 \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+extern sTask SCH_tasks_G[SCH_MAX_TASKS];
+
+static uint32_t simUs = 0;
+static uint32_t simNextTickUs = TICK_US;
+static uint32_t simEdgeAtUs = 0; // 下一次PTT边沿,0: 无
+static uint32_t simEdgeUs = 0;   // 已触发、尚未处理的边沿时间
+static uint8_t simEdgePending = 0;
+static uint8_t hiId = SCH_MAX_TASKS;
+static uint32_t simWakes = 0;
+
+static uint32_t randRange(uint32_t min, uint32_t max)
+{
+    return min + (uint32_t)rand() % (max - min + 1);
+}
+
+uint32_t simNowUs(void)
+{
+    return simUs;
+}
+
+// PTT边沿中断: 记录时间并触发高优先级任务
+static void simEdge(void)
+{
+    if (!simEdgePending)
+    {
+        simEdgeUs = simUs;
+        simEdgePending = 1;
+    }
+    SCH_Trigger_Task(hiId);
+    simEdgeAtUs = simUs + randRange(EDGE_MIN_US, EDGE_MAX_US);
+}
+
+// 任务执行us,期间节拍中断和边沿中断按时发生
+static void simRun(uint32_t us)
+{
+    uint32_t end = simUs + us;
+    for (;;)
+    {
+        uint32_t next = simNextTickUs;
+        if (simEdgeAtUs != 0 && simEdgeAtUs < next)
+        {
+            next = simEdgeAtUs;
+        }
+        if (next > end)
+        {
+            break;
+        }
+        simUs = next;
+        if (next == simNextTickUs)
+        {
+            simNextTickUs += TICK_US;
+            SCH_Dispatch_IT();
+        }
+        else
+        {
+            simEdge();
+        }
+    }
+    simUs = end;
+}
+
+// 节拍被抑制: 休眠到第maxTicks个节拍,或被边沿中断提前唤醒
+uint16_t simIdle(uint16_t maxTicks)
+{
+    uint32_t wakeUs = simNextTickUs + (uint32_t)(maxTicks - 1) * TICK_US;
+    uint16_t passed = maxTicks;
+    simWakes++;
+    if (simEdgeAtUs != 0 && simEdgeAtUs < wakeUs)
+    {
+        passed = simEdgeAtUs < simNextTickUs ? 0 : (uint16_t)((simEdgeAtUs - simNextTickUs) / TICK_US + 1);
+        wakeUs = simEdgeAtUs;
+        simUs = wakeUs;
+        simEdge();
+    }
+    simUs = wakeUs;
+    simNextTickUs += (uint32_t)passed * TICK_US;
+    return passed;
+}
+
+typedef struct
+{
+    uint8_t id;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t latMaxUs; // 从释放节拍到开始运行
+    uint32_t execMaxUs;
+    uint64_t execTotalUs;
+} SimTask;
+
+static SimTask hi = {SCH_MAX_TASKS, HI_MIN_US, HI_MAX_US, 0, 0, 0};
+static SimTask def = {SCH_MAX_TASKS, DEF_MIN_US, DEF_MAX_US, 0, 0, 0};
+static SimTask lo = {SCH_MAX_TASKS, LO_MIN_US, LO_MAX_US, 0, 0, 0};
+static uint32_t edgeLatMaxUs = 0;
+static uint32_t edges = 0;
+
+static void simTaskRun(SimTask *task)
+{
+    uint32_t lat = simUs - SCH_tasks_G[task->id].Release * TICK_US;
+    uint32_t exec = randRange(task->minUs, task->maxUs);
+    if (lat > task->latMaxUs)
+    {
+        task->latMaxUs = lat;
+    }
+    if (exec > task->execMaxUs)
+    {
+        task->execMaxUs = exec;
+    }
+    task->execTotalUs += exec;
+    simRun(exec);
+}
+
+static void hiTask(void)
+{
+    if (simEdgePending)
+    {
+        uint32_t lat = simUs - simEdgeUs;
+        simEdgePending = 0;
+        edges++;
+        if (lat > edgeLatMaxUs)
+        {
+            edgeLatMaxUs = lat;
+        }
+    }
+    simTaskRun(&hi);
+}
+
+static void defTask(void)
+{
+    simTaskRun(&def);
+}
+
+static void loTask(void)
+{
+    simTaskRun(&lo);
+}
+
+static void simClear(void)
+{
+    for (uint8_t i = 0; i < SCH_MAX_TASKS; i++)
+    {
+        if (SCH_tasks_G[i].pTask != 0)
+        {
+            SCH_Delete_Task(i);
+        }
+    }
+    simEdgeAtUs = 0;
+    simEdgePending = 0;
+}
+
+static void simUntil(uint32_t endUs)
+{
+    while (simUs < endUs)
+    {
+        SCH_Dispatch_Tasks();
+    }
+}
+
+static void testLatency(void)
+{
+    sTaskStats stats;
+    uint32_t wakes, idleMs, startUs = simUs;
+    uint64_t busyUs;
+    simClear();
+    // 低优先级任务排在前面,验证按优先级而不是按数组顺序调度
+    lo.id = SCH_Add_Task(loTask, 0, 14);
+    SCH_Set_Priority(lo.id, SCH_PRIO_LOW);
+    def.id = SCH_Add_Task(defTask, 0, 5);
+    hi.id = SCH_Add_Task(hiTask, 0, 10);
+    SCH_Set_Priority(hi.id, SCH_PRIO_HIGH);
+    hiId = hi.id;
+    simEdgeAtUs = simUs + EDGE_MAX_US;
+    SCH_Get_Idle_Stats(&wakes, &idleMs);
+    CHECK(wakes == 0, "no sleep before the first dispatch");
+
+    simUntil(startUs + SIM_TICKS * TICK_US);
+
+    // 不可抢占: 边沿到高优先级任务开始运行,最多等一次最长的低优先级任务
+    CHECK(edges > 1000, "edges handled: %u", (unsigned)edges);
+    CHECK(edgeLatMaxUs <= LO_MAX_US, "edge latency %u us > %u", (unsigned)edgeLatMaxUs, LO_MAX_US);
+    CHECK(edgeLatMaxUs > LO_MAX_US / 2, "edge never blocked by a long task (%u us)", (unsigned)edgeLatMaxUs);
+    // 默认优先级: 一次低优先级任务,加上此期间最多两次边沿和一次周期释放的高优先级任务
+    CHECK(def.latMaxUs <= LO_MAX_US + 3 * HI_MAX_US, "default latency %u us", (unsigned)def.latMaxUs);
+
+    CHECK(SCH_Get_Task_Stats(def.id, &stats) == RETURN_NORMAL, "default stats");
+    CHECK(stats.Wcet_us == def.execMaxUs, "default wcet %u != %u", (unsigned)stats.Wcet_us, (unsigned)def.execMaxUs);
+    CHECK(stats.Overruns == 0 && stats.Deadline_misses == 0, "default misses %u overruns %u",
+          stats.Deadline_misses, stats.Overruns);
+    CHECK(SCH_Get_Task_Stats(lo.id, &stats) == RETURN_NORMAL, "low stats");
+    CHECK(stats.Wcet_us == lo.execMaxUs, "low wcet %u != %u", (unsigned)stats.Wcet_us, (unsigned)lo.execMaxUs);
+    CHECK(stats.Overruns == 0 && stats.Deadline_misses == 0, "low misses %u overruns %u", stats.Deadline_misses,
+          stats.Overruns);
+    CHECK(stats.Runs >= SIM_TICKS / 14 - 1 && stats.Runs <= SIM_TICKS / 14 + 1, "low runs %u", (unsigned)stats.Runs);
+
+    // 无节拍休眠: 空闲时间等于总时间减去任务执行时间,节拍补发后任务仍按时释放
+    busyUs = hi.execTotalUs + def.execTotalUs + lo.execTotalUs;
+    SCH_Get_Idle_Stats(&wakes, &idleMs);
+    CHECK(wakes == simWakes, "wakes %u != %u", (unsigned)wakes, (unsigned)simWakes);
+    CHECK(idleMs == (uint32_t)((simUs - startUs - busyUs) / 1000), "idle %u ms, expected %u", (unsigned)idleMs,
+          (unsigned)((simUs - startUs - busyUs) / 1000));
+    printf("sched: %u edges, latency max edge %u us, default %u us, low %u us\n", (unsigned)edges,
+           (unsigned)edgeLatMaxUs, (unsigned)def.latMaxUs, (unsigned)lo.latMaxUs);
+}
+
+// 执行时间超过周期: 记为超时,下一次释放已到也记为错过截止时间
+static void testOverrun(void)
+{
+    sTaskStats stats;
+    simClear();
+    def.minUs = def.maxUs = 2 * TICK_US + 100;
+    def.id = SCH_Add_Task(defTask, 0, 2);
+    simUntil(simUs + 1000 * TICK_US);
+    CHECK(SCH_Get_Task_Stats(def.id, &stats) == RETURN_NORMAL, "overrun stats");
+    CHECK(stats.Runs > 0 && stats.Overruns == stats.Runs, "overruns %u of %u", stats.Overruns, (unsigned)stats.Runs);
+    CHECK(stats.Deadline_misses > 0 && stats.Backlog > 0, "misses %u backlog %u", stats.Deadline_misses,
+          stats.Backlog);
+}
+
+// 事件任务: 自身按步设定延时,模拟扫描/双守候/收发切换的多步流程
+static uint8_t evtId = SCH_MAX_TASKS;
+static uint32_t evtRuns = 0;
+static uint32_t evtChain = 0; // 剩余的自身重新设定次数
+static uint32_t evtLastTick = 0;
+
+static void evtTask(void)
+{
+    evtRuns++;
+    evtLastTick = SCH_Get_Tick();
+    if (evtChain > 0)
+    {
+        evtChain--;
+        CHECK(SCH_Arm_Task(evtId, (uint16_t)(evtChain % 3)) == RETURN_NORMAL, "re-arm from own run");
+    }
+}
+
+static void fillTask(void)
+{
+}
+
+static void testEventTask(void)
+{
+    uint32_t tick, wakes, idleMs, wakesBefore;
+    simClear();
+    evtId = SCH_Add_Event_Task(evtTask);
+    CHECK(evtId < SCH_MAX_TASKS, "add event task");
+    CHECK(SCH_Arm_Task(SCH_MAX_TASKS, 0) == RETURN_ERROR, "arm invalid index");
+
+    // 未设定时不运行,也不限制休眠时长
+    SCH_Get_Idle_Stats(&wakesBefore, &idleMs);
+    simUntil(simUs + 1000 * TICK_US);
+    SCH_Get_Idle_Stats(&wakes, &idleMs);
+    CHECK(evtRuns == 0, "parked task ran %u times", (unsigned)evtRuns);
+    CHECK(wakes - wakesBefore <= 2, "parked task woke the idle loop %u times", (unsigned)(wakes - wakesBefore));
+
+    // 与SCH_Add_Task(fn, 5, 0)相同: 第6个节拍释放,只运行一次
+    tick = SCH_Get_Tick();
+    CHECK(SCH_Arm_Task(evtId, 5) == RETURN_NORMAL, "arm");
+    simUntil(simUs + 100 * TICK_US);
+    CHECK(evtRuns == 1 && evtLastTick == tick + 6, "armed run %u at tick +%u", (unsigned)evtRuns,
+          (unsigned)(evtLastTick - tick));
+
+    // 重新设定替换未执行的一次,取消后不运行
+    tick = SCH_Get_Tick();
+    SCH_Arm_Task(evtId, 50);
+    SCH_Arm_Task(evtId, 2);
+    simUntil(simUs + 100 * TICK_US);
+    CHECK(evtRuns == 2 && evtLastTick == tick + 3, "re-armed run %u at tick +%u", (unsigned)evtRuns,
+          (unsigned)(evtLastTick - tick));
+    SCH_Arm_Task(evtId, 2);
+    SCH_Disarm_Task(evtId);
+    simUntil(simUs + 100 * TICK_US);
+    CHECK(evtRuns == 2, "disarmed task ran");
+
+    // 任务表已满时自身重新设定的流程照常推进,单次任务则无法加入
+    while (SCH_Add_Task(fillTask, 0, 50) < SCH_MAX_TASKS)
+    {
+    }
+    CHECK(SCH_Add_Task(fillTask, 0, 0) == SCH_MAX_TASKS, "task list full");
+    evtRuns = 0;
+    evtChain = 1000;
+    SCH_Arm_Task(evtId, 0);
+    simUntil(simUs + 3000 * TICK_US);
+    CHECK(evtRuns == 1001 && evtChain == 0, "chain ran %u steps with a full task list", (unsigned)evtRuns);
+}
+
+int main(void)
+{
+    srand(16);
+    testLatency();
+    testOverrun();
+    testEventTask();
+    printf("schedTest: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,352 @@
+/*
+ *softI2CFast.h主机端总线波形测试
+ *开漏总线 = 主机输出 & 从机输出,从机按BK4802(0x48, 16位寄存器)建模,
+ *逐个边沿检查: 数据只在SCL低电平时变化,START/STOP、应答位、重复START正确,
+ *SCL高/低电平、START保持和STOP建立时间都不短于半个时钟周期的延时
+ */
+#include "py32f0xx.h"
+#include "softI2CFast.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCL SOFT_I2C_FAST_SCL_PIN
+#define SDA SOFT_I2C_FAST_SDA_PIN
+#define SLAVE_ADDR 0x48
+
+typedef enum
+{
+    S_IDLE,    // 等待START,不驱动总线
+    S_RX,      // 接收字节
+    S_ACK_OUT, // 从机输出应答位
+    S_TX,      // 从机发送字节
+    S_ACK_IN,  // 主机应答位
+} SlaveState;
+
+uint32_t SystemCoreClock = 24000000;
+
+static GPIO_TypeDef gpio;
+static int masterScl = 1, masterSda = 1, slaveSda = 1;
+static int scl = 1, sda = 1;
+static uint32_t now = 0; // 以延时循环的一次迭代为单位
+static uint32_t sclEdge = 0, sdaEdge = 0, startTime = 0;
+static int startPending = 0;
+
+static SlaveState slave = S_IDLE;
+static uint8_t bitCnt, shift, byteIdx, readMode, masterAck, txByte;
+static uint8_t regAddr;
+static uint16_t regs[32];
+
+static uint32_t starts, stops, violations;
+static uint8_t bytes[16];
+static uint8_t acks[16];
+static uint8_t byteNum;
+static int failures = 0;
+
+#define CHECK(cond, ...)                                \
+    do                                                  \
+    {                                                   \
+        if (!(cond))                                    \
+        {                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            failures++;                                 \
+        }                                               \
+    } while (0)
+
+static void violation(const char *what)
+{
+    if (violations++ < 5)
+    {
+        printf("timing: %s at t=%u\n", what, (unsigned)now);
+    }
+}
+
+static void logByte(uint8_t value, uint8_t ack)
+{
+    if (byteNum < sizeof(bytes))
+    {
+        bytes[byteNum] = value;
+        acks[byteNum] = ack;
+    }
+    byteNum++;
+}
+
+static void slaveLoad(void)
+{
+    uint16_t reg = regs[regAddr & 31];
+    txByte = byteIdx == 0 ? (uint8_t)(reg >> 8) : (uint8_t)reg;
+    byteIdx++;
+    bitCnt = 0;
+    slaveSda = (txByte & 0x80) ? 1 : 0;
+    slave = S_TX;
+}
+
+static void sclRise(void)
+{
+    if (now - sclEdge < softI2cFastDelayCnt)
+    {
+        violation("SCL low too short");
+    }
+    if (now - sdaEdge < softI2cFastDelayCnt && slave != S_TX && slave != S_ACK_OUT)
+    {
+        violation("SDA setup too short");
+    }
+    sclEdge = now;
+    if (slave == S_RX)
+    {
+        shift = (uint8_t)(shift << 1) | (uint8_t)sda;
+        bitCnt++;
+    }
+    else if (slave == S_ACK_IN)
+    {
+        masterAck = (uint8_t)sda;
+    }
+}
+
+static void sclFall(void)
+{
+    if (now - sclEdge < softI2cFastDelayCnt)
+    {
+        violation("SCL high too short");
+    }
+    if (startPending && now - startTime < softI2cFastDelayCnt)
+    {
+        violation("START hold too short");
+    }
+    startPending = 0;
+    sclEdge = now;
+    switch (slave)
+    {
+    case S_RX:
+        if (bitCnt < 8)
+        {
+            break;
+        }
+        if (byteIdx == 0)
+        {
+            // 地址字节,其它地址不应答
+            readMode = shift & 1;
+            if ((shift >> 1) != SLAVE_ADDR)
+            {
+                logByte(shift, 1);
+                slave = S_IDLE;
+                break;
+            }
+        }
+        else if (byteIdx == 1)
+        {
+            regAddr = shift;
+        }
+        else if (byteIdx == 2)
+        {
+            regs[regAddr & 31] = (uint16_t)shift << 8;
+        }
+        else
+        {
+            regs[regAddr & 31] |= shift;
+        }
+        logByte(shift, 0);
+        byteIdx++;
+        slaveSda = 0;
+        slave = S_ACK_OUT;
+        break;
+    case S_ACK_OUT:
+        slaveSda = 1;
+        if (readMode)
+        {
+            byteIdx = 0;
+            slaveLoad();
+        }
+        else
+        {
+            bitCnt = 0;
+            shift = 0;
+            slave = S_RX;
+        }
+        break;
+    case S_TX:
+        bitCnt++;
+        if (bitCnt == 8)
+        {
+            slaveSda = 1;
+            slave = S_ACK_IN;
+        }
+        else
+        {
+            slaveSda = (txByte >> (7 - bitCnt)) & 1;
+        }
+        break;
+    case S_ACK_IN:
+        logByte(txByte, masterAck);
+        if (masterAck == 0)
+        {
+            slaveLoad();
+        }
+        else
+        {
+            slave = S_IDLE;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// 按写入顺序处理主机输出,更新总线电平和从机状态
+static void simBus(void)
+{
+    int newScl = masterScl;
+    int newSda = masterSda & slaveSda;
+    if (newScl != scl)
+    {
+        scl = newScl;
+        if (scl)
+        {
+            sclRise();
+        }
+        else
+        {
+            sclFall();
+        }
+        newSda = masterSda & slaveSda; // 从机在SCL下降沿更新输出
+    }
+    if (newSda != sda)
+    {
+        sda = newSda;
+        if (scl)
+        {
+            if (now - sclEdge < softI2cFastDelayCnt)
+            {
+                violation(sda ? "STOP setup too short" : "START setup too short");
+            }
+            if (sda)
+            {
+                stops++;
+                slave = S_IDLE;
+                slaveSda = 1;
+            }
+            else
+            {
+                starts++;
+                startPending = 1;
+                startTime = now;
+                slave = S_RX;
+                bitCnt = 0;
+                shift = 0;
+                byteIdx = 0;
+            }
+        }
+        sdaEdge = now;
+    }
+    gpio.IDR = (scl ? SCL : 0) | (sda ? SDA : 0);
+}
+
+static void simCommit(void)
+{
+    if (gpio.BSRR)
+    {
+        masterScl |= (gpio.BSRR & SCL) ? 1 : 0;
+        masterSda |= (gpio.BSRR & SDA) ? 1 : 0;
+        gpio.BSRR = 0;
+        simBus();
+    }
+    if (gpio.BRR)
+    {
+        masterScl &= (gpio.BRR & SCL) ? 0 : 1;
+        masterSda &= (gpio.BRR & SDA) ? 0 : 1;
+        gpio.BRR = 0;
+        simBus();
+    }
+}
+
+GPIO_TypeDef *simGpio(void)
+{
+    simCommit();
+    return &gpio;
+}
+
+void simNop(void)
+{
+    simCommit();
+    now++;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    CHECK(GPIO_Init->Mode == GPIO_MODE_OUTPUT_OD, "pins must be open-drain");
+    CHECK(GPIO_Init->Pin == (SCL | SDA), "pin mask");
+}
+
+static void traceReset(void)
+{
+    simCommit();
+    starts = stops = violations = 0;
+    byteNum = 0;
+    memset(bytes, 0, sizeof(bytes));
+    memset(acks, 0, sizeof(acks));
+}
+
+static void busIdleCheck(const char *what)
+{
+    simCommit();
+    CHECK(scl == 1 && sda == 1, "%s: bus not released (scl:%d sda:%d)", what, scl, sda);
+    CHECK(violations == 0, "%s: %u timing violations", what, (unsigned)violations);
+}
+
+int main(void)
+{
+    SoftI2cHandler port = {0};
+    uint32_t data;
+    uint32_t readLoops;
+
+    softI2cFastInit(&port);
+    CHECK(softI2cFastDelayCnt == SystemCoreClock / (SOFT_I2C_FAST_HZ * 2 * SOFT_I2C_FAST_LOOP_CYCLES),
+          "delay not calibrated from SystemCoreClock: %u", (unsigned)softI2cFastDelayCnt);
+    busIdleCheck("init");
+
+    // 写寄存器: START 0x90 reg hi lo STOP,每字节从机应答
+    traceReset();
+    softI2cFastWriteWordToAddr(&port, SLAVE_ADDR, 5, 0x1234);
+    CHECK(port.isErr == 0, "write reported error");
+    CHECK(regs[5] == 0x1234, "reg5 = %04x", regs[5]);
+    CHECK(starts == 1 && stops == 1, "write: %u starts %u stops", (unsigned)starts, (unsigned)stops);
+    CHECK(byteNum == 4 && bytes[0] == 0x90 && bytes[1] == 5 && bytes[2] == 0x12 && bytes[3] == 0x34, "write bytes");
+    busIdleCheck("write");
+
+    // 读寄存器: START 0x90 reg 重复START 0x91 hi(ACK) lo(NACK) STOP
+    regs[24] = 0xABCD;
+    traceReset();
+    readLoops = now;
+    data = softI2cFastReadWordFromAddr(&port, SLAVE_ADDR, 24);
+    readLoops = now - readLoops;
+    CHECK(port.isErr == 0, "read reported error");
+    CHECK(data == 0xABCD, "read %04x", (unsigned)data);
+    CHECK(starts == 2 && stops == 1, "read: %u starts %u stops", (unsigned)starts, (unsigned)stops);
+    CHECK(byteNum == 5 && bytes[2] == 0x91 && bytes[3] == 0xAB && acks[3] == 0 && bytes[4] == 0xCD && acks[4] == 1,
+          "read bytes/acks");
+    busIdleCheck("read");
+
+    // 从机不应答: 报错并用STOP释放总线
+    traceReset();
+    data = softI2cFastReadWordFromAddr(&port, SLAVE_ADDR + 1, 24);
+    CHECK(port.isErr == 1 && data == 0, "nack not reported");
+    CHECK(starts == 1 && stops == 1 && byteNum == 1, "nack: %u starts %u stops %u bytes", (unsigned)starts,
+          (unsigned)stops, (unsigned)byteNum);
+    busIdleCheck("read nack");
+    traceReset();
+    softI2cFastWriteWordToAddr(&port, SLAVE_ADDR + 1, 5, 0x5678);
+    CHECK(port.isErr == 1 && regs[5] == 0x1234, "write nack");
+    busIdleCheck("write nack");
+
+    // 错误后总线可以继续使用
+    traceReset();
+    softI2cFastWriteWordToAddr(&port, SLAVE_ADDR, 6, 0x00FF);
+    CHECK(port.isErr == 0 && regs[6] == 0x00FF, "write after error");
+    busIdleCheck("recover");
+
+    printf("softI2CFast: %u delay loops per half clock, %u for one register read\n",
+           (unsigned)softI2cFastDelayCnt, (unsigned)readLoops);
+    printf("softI2CFastTest: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
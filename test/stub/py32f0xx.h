@@ -0,0 +1,37 @@
+/*
+ *主机端测试用的最小py32f0xx.h: GPIO寄存器由测试中的总线模拟器实现
+ *每次访问端口都经过simGpio(),模拟器据此按顺序处理上一次的BSRR/BRR写入并更新IDR
+ */
+#ifndef __PY32F0XX_STUB_H__
+#define __PY32F0XX_STUB_H__
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t BSRR;
+    uint32_t BRR;
+    uint32_t IDR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_9 ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_MODE_OUTPUT_OD 0x00000011U
+#define GPIO_PULLUP 0x00000001U
+#define GPIO_SPEED_FREQ_VERY_HIGH 0x00000003U
+
+extern uint32_t SystemCoreClock;
+GPIO_TypeDef *simGpio(void);
+void simNop(void);
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+
+#define GPIOA simGpio()
+#define __NOP() simNop()
+#endif
@@ -0,0 +1,17 @@
+/*
+ *主机端测试用的Sch51端口钩子: 时间由测试中的模拟时钟提供,节拍中断由模拟时钟推进时调用SCH_Dispatch_IT()
+ *编译Sch51.c时用 -include 引入,先于Sch51_config.h定义各钩子
+ */
+#ifndef __SCH_SIM_H__
+#define __SCH_SIM_H__
+#include <stdint.h>
+
+uint32_t simNowUs(void);
+// 关中断休眠: 节拍被抑制,最多休眠maxTicks个节拍,返回休眠期间经过的节拍数
+uint16_t simIdle(uint16_t maxTicks);
+
+#define SCH_TIME_US() simNowUs()
+#define SCH_ENTER_CRITICAL()
+#define SCH_EXIT_CRITICAL()
+#define SCH_IDLE(MAX_TICKS) simIdle(MAX_TICKS)
+#endif
@@ -0,0 +1,367 @@
+/*
+ *模拟时钟和USART2,见uartSim.h
+ *时钟: 节拍中断每SIM_TICK_US调用一次SCH_Dispatch_IT,空闲时由simIdle跳到下一个节拍或串口事件
+ *串口: 每字节10位,发送完成和接收(满64字节的接收完成/最后一段的空闲中断)都在线上时间结束时产生
+ */
+#include "uartSim.h"
+#include "at.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define SIM_PERIPH_SIZE 0x22000 // 到RCC为止的外设寄存器
+#define SIM_HOST_TX_SIZE 512
+#define SIM_HOST_RX_SIZE 4096
+
+uint32_t simUs = 0;
+static uint32_t simNextTickUs = SIM_TICK_US;
+static uint8_t simInIrq = 0; // 中断中读取时间不推进时钟
+static uint32_t simStopUs = 0;
+
+// 模块侧
+static uint32_t uartBaud = 0;
+static uint8_t uartIrqEnabled = 0;
+static uint8_t uartBlocking = 0;
+static uint8_t uartTxBuf[UART_SEND_CHUNK_SIZE];
+static uint16_t uartTxLen = 0;
+static uint32_t uartTxBaud = 0;
+static uint8_t uartTxBusy = 0;
+static uint32_t uartTxDoneUs = 0;
+static UART_HandleTypeDef *uartTxHandle = NULL;
+static UART_HandleTypeDef *uartRxHandle = NULL;
+static uint8_t *uartRxBuf = NULL;
+static uint16_t uartRxSize = 0;
+
+// 主机侧
+static uint32_t hostBaud = UART_BAUD_DEFAULT;
+static uint8_t hostTx[SIM_HOST_TX_SIZE];
+static uint16_t hostTxLen = 0;
+static uint16_t hostTxPos = 0;
+static uint32_t hostTxArriveUs = 0; // 下一段数据到达模块的时刻
+static char hostRx[SIM_HOST_RX_SIZE];
+static uint16_t hostRxLen = 0;
+
+static uint32_t uartCharUs(uint32_t baud)
+{
+    return 10000000 / baud;
+}
+
+void uartSimInit(void)
+{
+    void *base = mmap((void *)PERIPH_BASE, SIM_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (base != (void *)PERIPH_BASE)
+    {
+        printf("uartSim: cannot map peripheral registers at 0x%08x\n", (unsigned)PERIPH_BASE);
+        exit(1);
+    }
+}
+
+void uartSimSetBlocking(uint8_t blocking)
+{
+    uartBlocking = blocking;
+}
+
+uint32_t uartSimBaud(void)
+{
+    return uartBaud;
+}
+
+void uartSimHostBaud(uint32_t baud)
+{
+    hostBaud = baud;
+}
+
+// 下一段主机数据: 接收缓冲区的剩余长度,最后一段再加一个字节的空闲时间
+static uint16_t uartHostPiece(uint32_t *wireUs)
+{
+    uint16_t n = hostTxLen - hostTxPos;
+    uint16_t size = uartRxSize ? uartRxSize : 64;
+    if (n > size)
+    {
+        n = size;
+    }
+    *wireUs = n * uartCharUs(hostBaud) + (hostTxPos + n == hostTxLen ? uartCharUs(hostBaud) : 0);
+    return n;
+}
+
+void uartSimHostSend(const char *text)
+{
+    uint16_t len = (uint16_t)strlen(text);
+    uint32_t wireUs;
+    if (hostTxPos == hostTxLen)
+    {
+        hostTxLen = hostTxPos = 0;
+    }
+    if (hostTxLen + len > SIM_HOST_TX_SIZE)
+    {
+        printf("uartSim: host send overflow\n");
+        exit(1);
+    }
+    memcpy(hostTx + hostTxLen, text, len);
+    if (hostTxPos == hostTxLen)
+    {
+        hostTxLen += len;
+        uartHostPiece(&wireUs);
+        hostTxArriveUs = simUs + wireUs;
+    }
+    else
+    {
+        hostTxLen += len;
+    }
+}
+
+uint16_t uartSimHostRecv(char *buf, uint16_t size)
+{
+    uint16_t n = hostRxLen < size - 1 ? hostRxLen : size - 1;
+    memcpy(buf, hostRx, n);
+    buf[n] = '\0';
+    memmove(hostRx, hostRx + n, hostRxLen - n);
+    hostRxLen -= n;
+    return n;
+}
+
+// 下一个串口事件的时刻,0: 没有。中断关闭期间不处理,使能时补上
+static uint32_t uartNextUs(void)
+{
+    uint32_t next = 0;
+    if (!uartIrqEnabled)
+    {
+        return 0;
+    }
+    if (uartTxBusy)
+    {
+        next = uartTxDoneUs;
+    }
+    if (hostTxPos < hostTxLen && uartRxBuf != NULL && (next == 0 || hostTxArriveUs < next))
+    {
+        next = hostTxArriveUs;
+    }
+    return next;
+}
+
+static void uartEvent(void)
+{
+    uint32_t wireUs;
+    simInIrq++;
+    if (uartTxBusy && (int32_t)(simUs - uartTxDoneUs) >= 0)
+    {
+        // 波特率不一致时主机收到乱码
+        for (uint16_t i = 0; i < uartTxLen && hostRxLen < SIM_HOST_RX_SIZE; i++)
+        {
+            hostRx[hostRxLen++] = uartTxBaud == hostBaud ? (char)uartTxBuf[i] : '?';
+        }
+        uartTxBusy = 0;
+        HAL_UART_TxCpltCallback(uartTxHandle);
+    }
+    else if (hostTxPos < hostTxLen && uartRxBuf != NULL && (int32_t)(simUs - hostTxArriveUs) >= 0)
+    {
+        uint16_t n = uartHostPiece(&wireUs);
+        for (uint16_t i = 0; i < n; i++)
+        {
+            uartRxBuf[i] = hostBaud == uartBaud ? hostTx[hostTxPos + i] : 0xFF;
+        }
+        hostTxPos += n;
+        uartRxHandle->RxXferCount = uartRxSize - n;
+        if (n == uartRxSize)
+        {
+            HAL_UART_RxCpltCallback(uartRxHandle);
+        }
+        else
+        {
+            HAL_UART_IdleFrameDetectCpltCallback(uartRxHandle);
+        }
+        if (hostTxPos < hostTxLen)
+        {
+            uartHostPiece(&wireUs);
+            hostTxArriveUs = simUs + wireUs;
+        }
+    }
+    simInIrq--;
+}
+
+static void uartService(void)
+{
+    uint32_t next;
+    while ((next = uartNextUs()) != 0 && (int32_t)(simUs - next) >= 0)
+    {
+        uartEvent();
+    }
+}
+
+void simRun(uint32_t us)
+{
+    uint32_t end = simUs + us;
+    for (;;)
+    {
+        uint32_t next = simNextTickUs;
+        uint32_t ev = uartNextUs();
+        if (ev != 0 && (int32_t)(ev - next) < 0)
+        {
+            next = ev;
+        }
+        if ((int32_t)(next - end) > 0)
+        {
+            break;
+        }
+        if ((int32_t)(next - simUs) > 0)
+        {
+            simUs = next;
+        }
+        if (next == simNextTickUs && next != ev)
+        {
+            simNextTickUs += SIM_TICK_US;
+            simInIrq++;
+            SCH_Dispatch_IT();
+            simInIrq--;
+        }
+        else
+        {
+            uartEvent();
+        }
+    }
+    if ((int32_t)(end - simUs) > 0)
+    {
+        simUs = end; // 嵌套调用(阻塞发送)可能已经超过end
+    }
+}
+
+void simUntil(uint32_t endUs)
+{
+    simStopUs = endUs;
+    while ((int32_t)(simUs - endUs) < 0)
+    {
+        SCH_Dispatch_Tasks();
+    }
+}
+
+uint32_t simNowUs(void)
+{
+    return simUs;
+}
+
+// 节拍被抑制: 休眠到第maxTicks个节拍,或被串口中断提前唤醒,simUntil的结束时刻也唤醒,便于测试在任意相位发送
+uint16_t simIdle(uint16_t maxTicks)
+{
+    uint32_t wakeUs = simNextTickUs + (uint32_t)(maxTicks - 1) * SIM_TICK_US;
+    uint32_t ev = uartNextUs();
+    uint16_t passed = maxTicks;
+    uint8_t isEvent = 0;
+    if (ev != 0 && (int32_t)(ev - wakeUs) < 0)
+    {
+        wakeUs = ev;
+        isEvent = 1;
+    }
+    if ((int32_t)(simStopUs - wakeUs) < 0 && (int32_t)(simStopUs - simUs) > 0)
+    {
+        wakeUs = simStopUs;
+        isEvent = 0;
+    }
+    if (isEvent || wakeUs == simStopUs)
+    {
+        passed = (int32_t)(wakeUs - simNextTickUs) < 0 ? 0 : (uint16_t)((wakeUs - simNextTickUs) / SIM_TICK_US + 1);
+    }
+    if ((int32_t)(wakeUs - simUs) > 0)
+    {
+        simUs = wakeUs;
+    }
+    simNextTickUs += (uint32_t)passed * SIM_TICK_US;
+    if (isEvent)
+    {
+        uartEvent();
+    }
+    return passed;
+}
+
+// 任务中的忙等待(如atSendFlush)需要时钟前进
+uint32_t millis(void)
+{
+    if (!simInIrq)
+    {
+        simRun(1);
+    }
+    return simUs / 1000;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    uartBaud = huart->Init.BaudRate;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    uint32_t wireUs = Size * uartCharUs(uartBaud);
+    if (uartTxBusy || Size > sizeof(uartTxBuf))
+    {
+        return HAL_BUSY;
+    }
+    memcpy(uartTxBuf, pData, Size);
+    uartTxLen = Size;
+    uartTxBaud = uartBaud;
+    uartTxHandle = huart;
+    if (uartBlocking)
+    {
+        // 原来的HAL_UART_Transmit: 调用者等到数据发完,完成中断随后立即产生
+        simRun(wireUs);
+        wireUs = 0;
+    }
+    uartTxBusy = 1;
+    uartTxDoneUs = simUs + wireUs;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    uartRxHandle = huart;
+    uartRxBuf = pData;
+    uartRxSize = Size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Abort(UART_HandleTypeDef *huart)
+{
+    uartTxBusy = 0; // 正在发送的数据块丢失
+    uartRxBuf = NULL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+    uartRxBuf = NULL;
+    return HAL_OK;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == USART2_IRQn)
+    {
+        uartIrqEnabled = 1;
+        uartService(); // 关闭期间挂起的中断
+    }
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == USART2_IRQn)
+    {
+        uartIrqEnabled = 0;
+    }
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+}
+
+HAL_StatusTypeDef WDT_Feed(void)
+{
+    return HAL_OK;
+}
@@ -0,0 +1,30 @@
+/*
+ *主机端测试用的模拟时钟和串口: 链接真实的at.c和Sch51.c,HAL串口函数由这里代替
+ *发送按波特率计算线上时间,到时产生发送完成中断;主机发送的数据按接收中断/空闲中断送入at.c
+ *USART2_IRQn关闭期间到期的中断推迟到重新使能时处理,与NVIC挂起相同
+ */
+#ifndef __UART_SIM_H__
+#define __UART_SIM_H__
+#include <stdint.h>
+
+#define SIM_TICK_US 720 // 与osTimer的节拍一致
+
+extern uint32_t simUs;
+
+// 映射外设寄存器窗口,atInit中的时钟使能和中断使能宏直接写寄存器
+void uartSimInit(void);
+// 推进模拟时钟,期间节拍和串口中断按时发生,用于模拟任务的执行时间
+void simRun(uint32_t us);
+// 运行调度器到指定时刻
+void simUntil(uint32_t endUs);
+// 1: 模拟原来的阻塞发送,线上时间计入调用者(任务)的执行时间
+void uartSimSetBlocking(uint8_t blocking);
+// 模块当前的波特率(最近一次HAL_UART_Init)
+uint32_t uartSimBaud(void);
+// 主机侧波特率,与模块不一致时双方收到的都是乱码
+void uartSimHostBaud(uint32_t baud);
+// 主机发送,数据按线上时间到达模块
+void uartSimHostSend(const char *text);
+// 主机已收到的数据,以'\0'结尾,读取后清空
+uint16_t uartSimHostRecv(char *buf, uint16_t size);
+#endif
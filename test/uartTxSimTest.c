@@ -0,0 +1,146 @@
+/*
+ *AT发送路径主机端测试: 真实的at.c/atCommand.c/Sch51.c运行在模拟时钟和串口上
+ *主机连续发送一组查询,回复经发送环形缓冲区由发送完成中断分块发出,缓冲区不足时接收处理暂停,
+ *验证高优先级的radioTask抖动不超过1ms,且每条回复完整、按序、无丢弃
+ *对照: 模拟原来的阻塞发送,线上时间计入atTask,抖动必然超过1ms
+ */
+#include "uartSim.h"
+#include "at.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_BURSTS 200
+#define SIM_BURST_US 200000 // 19200下一组查询和回复的线上时间约140ms
+#define RADIO_US 200        // radioTask的执行时间
+#define AT_TASK_US 300      // atTask每次运行的解析开销
+#define JITTER_MAX_US 1000
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                  \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);   \
+            printf(__VA_ARGS__);                          \
+            printf("\n");                                 \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+extern sTask SCH_tasks_G[SCH_MAX_TASKS];
+
+// 一组查询不超过接收环形缓冲区,回复比查询长,发送缓冲放不下整条回复时接收处理暂停
+static const char burstCmd[] = "AT+NAME?\r\nAT+TXFREQ?\r\nAT+RXFREQ?\r\nAT+SQL?\r\nAT+VER?\r\n"
+                               "AT+PLLCACHE?\r\nAT+NAME?\r\nAT+TXFREQ?\r\nAT+RXFREQ?\r\n";
+static const char burstReply[] = "NAME:FMO-BP-V1.0.11\nOK\nTXFREQ:438.5000\nOK\nRXFREQ:145.1000\nOK\nSQL:5\nOK\n"
+                                 "VER:V1\nOK\nPLLCACHE:3,4\nOK\nNAME:FMO-BP-V1.0.11\nOK\nTXFREQ:438.5000\nOK\n"
+                                 "RXFREQ:145.1000\nOK\n";
+
+static SHARECom com;
+static uint32_t radioReleaseTick = 1; // 下一次按周期应释放的节拍,SCH_Add_Task(fn, 0, 10)在第1个节拍首次释放
+static uint32_t radioJitterMaxUs = 0;
+static uint32_t radioRuns = 0;
+static uint32_t atHeldRuns = 0; // 因发送缓冲不足暂停接收处理的次数
+
+// 与radioTask相同的周期和优先级,记录从应释放的节拍到开始运行的时间
+// 积压时Sch51把Release改为补跑的节拍,这里按周期自行计算释放时刻
+static void radioTaskSim(void)
+{
+    uint32_t releaseUs = radioReleaseTick * SIM_TICK_US;
+    if ((int32_t)(simUs - releaseUs) >= 0)
+    {
+        if (simUs - releaseUs > radioJitterMaxUs)
+        {
+            radioJitterMaxUs = simUs - releaseUs;
+        }
+        while ((int32_t)(simUs - radioReleaseTick * SIM_TICK_US) >= 0)
+        {
+            radioReleaseTick += 10;
+        }
+    }
+    radioRuns++;
+    simRun(RADIO_US);
+}
+
+static void atTaskSim(void)
+{
+    simRun(AT_TASK_US);
+    atTask();
+    if (ATCmdIsRecvHeld())
+    {
+        atHeldRuns++;
+    }
+}
+
+// 运行若干组查询,返回回复错误的组数
+static uint32_t runBursts(uint32_t bursts)
+{
+    static char reply[1024];
+    uint32_t bad = 0;
+    for (uint32_t i = 0; i < bursts; i++)
+    {
+        simUntil(simUs + (uint32_t)rand() % (10 * SIM_TICK_US)); // 与radioTask周期的相位随机
+        uartSimHostSend(burstCmd);
+        simUntil(simUs + SIM_BURST_US);
+        uartSimHostRecv(reply, sizeof(reply));
+        if (strcmp(reply, burstReply) != 0)
+        {
+            if (bad == 0)
+            {
+                printf("burst %u reply:\n%s\n", (unsigned)i, reply);
+            }
+            bad++;
+        }
+    }
+    return bad;
+}
+
+static void testInterruptTx(void)
+{
+    uint32_t queued, dropped, peak, bad;
+    bad = runBursts(SIM_BURSTS);
+    atGetTxStats(&queued, &dropped, &peak);
+    CHECK(bad == 0, "%u of %u bursts with wrong replies", (unsigned)bad, SIM_BURSTS);
+    CHECK(dropped == 0, "%u bytes dropped", (unsigned)dropped);
+    CHECK(queued == SIM_BURSTS * (sizeof(burstReply) - 1), "%u bytes queued", (unsigned)queued);
+    CHECK(peak <= UART_SEND_BUF_SIZE, "peak %u", (unsigned)peak);
+    CHECK(atHeldRuns > 0, "receive never held for send room");
+    CHECK(radioRuns > SIM_BURSTS * SIM_BURST_US / SIM_TICK_US / 10, "radio ran %u times", (unsigned)radioRuns);
+    CHECK(radioJitterMaxUs < JITTER_MAX_US, "radio jitter %u us with AT traffic", (unsigned)radioJitterMaxUs);
+    printf("uartTxSim: %u bytes replied, peak %u, held %u times, radio jitter max %u us\n", (unsigned)queued,
+           (unsigned)peak, (unsigned)atHeldRuns, (unsigned)radioJitterMaxUs);
+}
+
+// 阻塞发送: 回复仍然完整,但atTask运行期间radioTask无法运行
+static void testBlockingTx(void)
+{
+    radioJitterMaxUs = 0;
+    uartSimSetBlocking(1);
+    CHECK(runBursts(10) == 0, "blocking replies");
+    CHECK(radioJitterMaxUs > JITTER_MAX_US, "blocking jitter %u us not detected", (unsigned)radioJitterMaxUs);
+    uartSimSetBlocking(0);
+}
+
+int main(void)
+{
+    uint8_t atId, radioId;
+    srand(8);
+    uartSimInit();
+    com.sql = 5;
+    com.txFreq = 438.5f;
+    com.rxFreq = 145.1f;
+    atInit(&com);
+    CHECK(uartSimBaud() == UART_BAUD_DEFAULT, "baud %u", (unsigned)uartSimBaud());
+    atId = SCH_Add_Task(atTaskSim, 0, 10);
+    atSetTaskId(atId);
+    radioId = SCH_Add_Task(radioTaskSim, 0, 10);
+    SCH_Set_Priority(radioId, SCH_PRIO_HIGH);
+
+    testInterruptTx();
+    testBlockingTx();
+    printf("uartTxSimTest: %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
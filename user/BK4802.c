@@ -1,11 +1,10 @@
 #include "components.h"
+#include "BK4802.h"
 #include "radio.h"
 #include "main.h"
+#include "def.h"
 #define BK4802_SNR_BAD_THRE 2
 
-#define IF 0.1370000
-#define TWO24 16777216
-#define CRYSTAL 21.2500000
 
 static uint8_t thresholdIdx = 0;
 static uint8_t softRSSIThre = 80; // default
@@ -14,15 +13,30 @@ static uint8_t softRSSIThre = 80; // default
 static const uint8_t threTable[] = {0, 64, 70, 76, 82, 89, 97, 104, 112, 118, 125};
 #define THRE_SIZE (sizeof(threTable) / sizeof(threTable[0]))
 static xBool isTx = false;
-static float g_freqOffsetMHz = 0.0f;
-static float g_lastUserFreqMHz = 0.0f;
+static int32_t g_freqOffsetHz = 0;
+static uint32_t g_lastUserFreqHz = 0;
 typedef struct
 {
     uint8_t addr;
     uint16_t value;
 } BK4802Reg;
 
-#if 1 // 软件IIC接口部分
+// PLL寄存器缓存,按用户频率和收发方向索引,频偏变化时整体失效
+#define BK4802_PLL_CACHE_SIZE 4
+typedef struct
+{
+    uint32_t freqHz;   // 用户频率(未加偏移)
+    uint32_t actualHz; // 量化后的实际频率,仅用于日志
+    uint16_t regs[3];  // reg0 reg1 reg2
+    uint8_t isTx;
+    uint8_t valid;
+} BK4802PllCacheEntry;
+static BK4802PllCacheEntry pllCache[BK4802_PLL_CACHE_SIZE];
+static uint8_t pllCacheNext = 0; // 轮换替换位置
+static uint32_t pllCacheHit = 0;
+static uint32_t pllCacheMiss = 0;
+
+#if (BK4802_BUS == BK4802_BUS_SOFT_I2C) // 软件IIC接口部分
 // SDA PA10
 // SCL PA9
 void sclIn(void)
@@ -105,6 +119,151 @@ static SoftI2cHandler SoftIICPort =
         .sdaRead = sdaRead,
 };
 
+#elif (BK4802_BUS == BK4802_BUS_SOFT_I2C_FAST) // 软件IIC快速实现,引脚在softI2CFast.h中配置
+#include "softI2CFast.h"
+static SoftI2cHandler SoftIICPort = {0}; // 仅使用isErr
+
+#elif (BK4802_BUS == BK4802_BUS_HW_I2C) // 硬件I2C接口部分
+// 传输由中断(或DMA)完成,CPU只等待完成标志,期间可响应其它中断
+#define BK4802_I2C_ADDR (0x48 << 1)
+#define BK4802_I2C_SPEED 400000     // BK4802最高支持400kHz
+#define BK4802_I2C_TIMEOUT_MS 3     // 单次寄存器访问约60us,超时仅用于总线异常
+I2C_HandleTypeDef I2cHandle;        // 中断服务函数中使用
+#if BK4802_HW_I2C_USE_DMA
+DMA_HandleTypeDef I2cDmaTxHandle;
+DMA_HandleTypeDef I2cDmaRxHandle;
+#endif
+static volatile uint8_t i2cXferDone = 0;
+static volatile uint8_t i2cXferErr = 0;
+static uint8_t i2cBusErr = 0; // 与SoftIICPort.isErr含义一致,最近一次访问是否出错
+static uint8_t i2cXferBuf[2];
+
+static void BK4802I2cInit(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    __HAL_RCC_I2C_CLK_ENABLE();
+
+    // PA10 = SCL, PA9 = SDA 与常规AF6映射相反,使用AF12
+    GPIO_InitStruct.Pin = GPIO_PIN_10 | GPIO_PIN_9;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.Alternate = GPIO_AF12_I2C;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    __HAL_RCC_I2C_FORCE_RESET();
+    __HAL_RCC_I2C_RELEASE_RESET();
+
+    I2cHandle.Instance = I2C1;
+    I2cHandle.Init.ClockSpeed = BK4802_I2C_SPEED;
+    I2cHandle.Init.DutyCycle = I2C_DUTYCYCLE_2;
+    I2cHandle.Init.OwnAddress1 = 0;
+    I2cHandle.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+    I2cHandle.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+    HAL_I2C_Init(&I2cHandle);
+
+#if BK4802_HW_I2C_USE_DMA
+    __HAL_RCC_DMA_CLK_ENABLE();
+    I2cDmaTxHandle.Instance = DMA1_Channel1;
+    I2cDmaTxHandle.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    I2cDmaTxHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+    I2cDmaTxHandle.Init.MemInc = DMA_MINC_ENABLE;
+    I2cDmaTxHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    I2cDmaTxHandle.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    I2cDmaTxHandle.Init.Mode = DMA_NORMAL;
+    I2cDmaTxHandle.Init.Priority = DMA_PRIORITY_HIGH;
+    HAL_DMA_Init(&I2cDmaTxHandle);
+    HAL_DMA_ChannelMap(&I2cDmaTxHandle, DMA_CHANNEL_MAP_I2C_TX);
+    __HAL_LINKDMA(&I2cHandle, hdmatx, I2cDmaTxHandle);
+
+    I2cDmaRxHandle.Instance = DMA1_Channel2;
+    I2cDmaRxHandle.Init = I2cDmaTxHandle.Init;
+    I2cDmaRxHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    HAL_DMA_Init(&I2cDmaRxHandle);
+    HAL_DMA_ChannelMap(&I2cDmaRxHandle, DMA_CHANNEL_MAP_I2C_RX);
+    __HAL_LINKDMA(&I2cHandle, hdmarx, I2cDmaRxHandle);
+
+    HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel2_3_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_3_IRQn);
+#endif
+
+    HAL_NVIC_SetPriority(I2C1_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(I2C1_IRQn);
+}
+
+// 等待中断回调置位完成标志,超时则复位外设
+// 等待期间WFI让出内核,由I2C/DMA完成中断或SysTick唤醒
+// 关中断下检查标志再WFI: 挂起的中断同样能唤醒,不会错过检查之后才到的完成中断
+static xBool BK4802I2cWait(void)
+{
+    uint32_t start = millis();
+    for (;;)
+    {
+        __disable_irq();
+        if (i2cXferDone)
+        {
+            __enable_irq();
+            break;
+        }
+        __WFI();
+        __enable_irq();
+        if (millis() - start > BK4802_I2C_TIMEOUT_MS)
+        {
+            HAL_I2C_DeInit(&I2cHandle);
+            HAL_I2C_Init(&I2cHandle);
+            return xFalse;
+        }
+    }
+    return i2cXferErr ? xFalse : xTrue;
+}
+
+static void BK4802I2cWrite(uint8_t addr, uint16_t data)
+{
+    HAL_StatusTypeDef status;
+    i2cXferBuf[0] = (uint8_t)(data >> 8);
+    i2cXferBuf[1] = (uint8_t)data;
+    i2cXferDone = 0;
+    i2cXferErr = 0;
+#if BK4802_HW_I2C_USE_DMA
+    status = HAL_I2C_Mem_Write_DMA(&I2cHandle, BK4802_I2C_ADDR, addr, I2C_MEMADD_SIZE_8BIT, i2cXferBuf, 2);
+#else
+    status = HAL_I2C_Mem_Write_IT(&I2cHandle, BK4802_I2C_ADDR, addr, I2C_MEMADD_SIZE_8BIT, i2cXferBuf, 2);
+#endif
+    i2cBusErr = (status != HAL_OK || !BK4802I2cWait()) ? 1 : 0;
+}
+
+static uint16_t BK4802I2cRead(uint8_t addr)
+{
+    HAL_StatusTypeDef status;
+    i2cXferDone = 0;
+    i2cXferErr = 0;
+#if BK4802_HW_I2C_USE_DMA
+    status = HAL_I2C_Mem_Read_DMA(&I2cHandle, BK4802_I2C_ADDR, addr, I2C_MEMADD_SIZE_8BIT, i2cXferBuf, 2);
+#else
+    status = HAL_I2C_Mem_Read_IT(&I2cHandle, BK4802_I2C_ADDR, addr, I2C_MEMADD_SIZE_8BIT, i2cXferBuf, 2);
+#endif
+    i2cBusErr = (status != HAL_OK || !BK4802I2cWait()) ? 1 : 0;
+    return ((uint16_t)i2cXferBuf[0] << 8) | i2cXferBuf[1];
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2cXferDone = 1;
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2cXferDone = 1;
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2cXferErr = 1;
+    i2cXferDone = 1;
+}
+
 #endif
 
 /*通用寄存器,配置后不再变化*/
@@ -165,6 +324,15 @@ static BK4802Reg dynamicConfig[] =
         {14, 0xFFE0}};
 #define BK4802DynamicRegNum (sizeof(dynamicConfig) / sizeof(BK4802Reg))
 
+/*寄存器镜像: regShadow保存期望的芯片寄存器值,只有与芯片状态不一致(脏)的寄存器才会被写入*/
+#define BK4802_REG_NUM 32
+static uint16_t regShadow[BK4802_REG_NUM];
+static uint32_t regKnownMask = 0; // bit=1:镜像值已设置过
+static uint32_t regDirtyMask = 0; // bit=1:镜像值尚未写入芯片
+// 同步顺序与原先整表写入一致：收发模式 -> 通用 -> 动态 -> 频率(从高位到低位)
+static const uint8_t regSyncOrder[] = {4, 5, 6, 9, 10, 11, 12, 13, 15, 16, 17, 18, 19, 20, 21, 22, 7, 8, 14, 2, 0, 1};
+#define BK4802SyncOrderNum (sizeof(regSyncOrder) / sizeof(regSyncOrder[0]))
+
 uint16_t BK4802GetDynamicCfg(uint8_t cfgReg)
 {
     // 遍历:dynamicConfig 找到指定的寄存器参数
@@ -206,10 +374,26 @@ uint8_t BK4802GetRSSIThre(void)
     return thresholdIdx;
 }
 
+// 最近一次总线访问是否出错
+static xBool BK4802BusError(void)
+{
+#if (BK4802_BUS == BK4802_BUS_HW_I2C)
+    return i2cBusErr;
+#else
+    return SoftIICPort.isErr;
+#endif
+}
+
 void BK4802WriteReg(uint8_t addr, uint16_t data)
 {
+#if (BK4802_BUS == BK4802_BUS_HW_I2C)
+    BK4802I2cWrite(addr, data);
+#elif (BK4802_BUS == BK4802_BUS_SOFT_I2C_FAST)
+    softI2cFastWriteWordToAddr(&SoftIICPort, 0x48, addr, data);
+#else
     softI2cWriteWordToAddr(&SoftIICPort, 0x48, addr, data);
-    if (SoftIICPort.isErr)
+#endif
+    if (BK4802BusError())
     {
         log_e("write error!");
     }
@@ -217,8 +401,14 @@ void BK4802WriteReg(uint8_t addr, uint16_t data)
 
 uint16_t BK4802ReadReg(uint8_t addr)
 {
+#if (BK4802_BUS == BK4802_BUS_HW_I2C)
+    uint16_t ret = BK4802I2cRead(addr);
+#elif (BK4802_BUS == BK4802_BUS_SOFT_I2C_FAST)
+    uint16_t ret = softI2cFastReadWordFromAddr(&SoftIICPort, 0x48, addr);
+#else
     uint16_t ret = softI2cReadWordFromAddr(&SoftIICPort, 0x48, addr);
-    if (SoftIICPort.isErr)
+#endif
+    if (BK4802BusError())
     {
         log_e("read error!");
         ret = 0;
@@ -226,11 +416,123 @@ uint16_t BK4802ReadReg(uint8_t addr)
     return ret;
 }
 
+// 设置镜像值,与芯片中已有值相同时不产生写操作
+static void BK4802RegSet(uint8_t addr, uint16_t value)
+{
+    uint32_t bit;
+    if (addr >= BK4802_REG_NUM)
+    {
+        return;
+    }
+    bit = 1UL << addr; // 先检查地址,越界的移位是未定义行为
+    if ((regKnownMask & bit) && regShadow[addr] == value)
+    {
+        return; // 值未变化,保持原有的脏标记
+    }
+    regShadow[addr] = value;
+    regKnownMask |= bit;
+    regDirtyMask |= bit;
+}
+
+// 将所有脏寄存器写入芯片,写失败的寄存器保持脏标记,下次同步时重试
+static void BK4802RegSync(void)
+{
+    uint8_t addr;
+    for (int i = 0; i < BK4802SyncOrderNum && regDirtyMask; i++)
+    {
+        addr = regSyncOrder[i];
+        if ((regDirtyMask & (1UL << addr)) == 0)
+        {
+            continue;
+        }
+        BK4802WriteReg(addr, regShadow[addr]);
+        if (BK4802BusError())
+        {
+            return; // 总线异常,由上层复位流程强制重新同步
+        }
+        regDirtyMask &= ~(1UL << addr);
+    }
+    // 不在同步顺序表中的寄存器按地址顺序写入
+    for (addr = 0; addr < BK4802_REG_NUM && regDirtyMask; addr++)
+    {
+        if ((regDirtyMask & (1UL << addr)) == 0)
+        {
+            continue;
+        }
+        BK4802WriteReg(addr, regShadow[addr]);
+        if (BK4802BusError())
+        {
+            return;
+        }
+        regDirtyMask &= ~(1UL << addr);
+    }
+}
+
+// 强制全部重新同步：所有设置过的寄存器在下次同步时都会写入芯片
+static void BK4802RegResync(void)
+{
+    regDirtyMask = regKnownMask;
+}
+
+static void BK4802RegUpdate(uint8_t addr, uint16_t value)
+{
+    BK4802RegSet(addr, value);
+    BK4802RegSync();
+}
+
+// 状态寄存器24~31快照: 每个调度节拍内每个寄存器最多读一次,第一次用到时才读取,
+// 同一节拍内RSSI/SNR/AFC等来自同一次读取,接收路径每节拍只需读reg24.BK4802没有寄存器地址自增
+#define BK4802_STATUS_FIRST 24
+#define BK4802_STATUS_NUM 8
+static uint16_t statusRegs[BK4802_STATUS_NUM];
+static uint8_t statusMask = 0;   // 本节拍已读取的寄存器,bit0对应reg24
+static uint32_t statusTick = 0;  // 快照所属的调度节拍 SCH_Get_Tick()
+static xBool statusErr = xFalse; // 本节拍读取出错,之后的读取不再访问总线,由BK4802IsError报告
+
+static uint16_t BK4802StatusRead(uint8_t addr)
+{
+    uint8_t idx = addr - BK4802_STATUS_FIRST;
+    if (statusTick != SCH_Get_Tick())
+    {
+        statusTick = SCH_Get_Tick();
+        statusMask = 0;
+        statusErr = xFalse;
+    }
+    if (statusErr)
+    {
+        return 0; // 总线异常,等待上层复位
+    }
+    if ((statusMask & (1U << idx)) == 0)
+    {
+        statusRegs[idx] = BK4802ReadReg(addr);
+        if (BK4802BusError())
+        {
+            statusErr = xTrue;
+            return 0;
+        }
+        statusMask |= 1U << idx;
+    }
+    return statusRegs[idx];
+}
+
+// 收发切换、重新配置后旧的状态无效
+void BK4802StatusInvalidate(void)
+{
+    statusMask = 0;
+    statusErr = xFalse;
+}
+
+// 返回快照采样时的调度节拍,无有效快照返回0
+uint32_t BK4802GetStatusStamp(void)
+{
+    return (statusMask && statusTick == SCH_Get_Tick()) ? statusTick : 0;
+}
+
 uint8_t BK4802SNRRead(void)
 {
     // 地址为24 读取信噪比,BIT13~BIT08为信噪比值
     uint16_t value;
-    value = BK4802ReadReg(24);
+    value = BK4802StatusRead(24);
     value = value & 0x3F00;
     value >>= 8;
     return (uint8_t)value;
@@ -240,7 +542,7 @@ uint8_t BK4802RSSIRead(void)
 {
     // 地址为24 读取信号强度,BIT07~BIT00为信号强度值
     uint16_t value;
-    value = BK4802ReadReg(24);
+    value = BK4802StatusRead(24);
     value = value & 0x00FF;
     return (uint8_t)value;
 }
@@ -249,16 +551,16 @@ uint8_t BK4802AFCResidualRead(void)
 {
     // 地址为25 读取AFC残差,BIT07~BIT00为AFC残差值
     uint16_t value;
-    value = BK4802ReadReg(25);
+    value = BK4802StatusRead(25);
     value = value & 0x00FF;
     return (uint8_t)value;
 }
 
 uint8_t BK4802ExNoiseIndicator(void)
 {
-    // 地址为25 读取外部噪声指示,BIT12~BIT00为外部噪声指示值
+    // 地址为26 读取外部噪声指示,BIT12~BIT00为外部噪声指示值
     uint16_t value;
-    value = BK4802ReadReg(26);
+    value = BK4802StatusRead(26);
     value = value & 0x1FFF;
     return (uint8_t)value;
 }
@@ -266,7 +568,7 @@ uint8_t BK4802ExNoiseIndicator(void)
 uint8_t BK4802RXVolumeRead(void)
 {
     uint16_t value;
-    value = BK4802ReadReg(30);
+    value = BK4802StatusRead(30);
     return (uint8_t)(value >> 8 & 0x00FF);
 }
 
@@ -279,13 +581,13 @@ uint8_t BK4802readASKOUT(void)
 uint8_t BK4802ExNoiseThreshodForSpeakOffConditonAcquireFromSARADC(void)
 {
     uint16_t value;
-    value = BK4802ReadReg(30);
+    value = BK4802StatusRead(30);
     return (uint8_t)(value & 0x00FF);
 }
 uint8_t BK4802RSSIThreshodForSpeakOffConditonAcquireFromSARADC(void)
 {
     uint16_t value;
-    value = BK4802ReadReg(31);
+    value = BK4802StatusRead(31);
     return (uint8_t)(value & 0x00FF);
 }
 
@@ -310,8 +612,8 @@ void BK4802SetVolLevel(uint8_t level) // 0~31
     reg14 &= ~(0x1F << 9); // 清除原有音量值
     reg14 |= (vol << 9);   // 设置新的音量值
 
-    BK4802WriteReg(14, reg14);
     BK4802SetDynamicCfg(14, reg14);
+    BK4802RegUpdate(14, reg14);
 }
 
 uint8_t BK4802GetVolLevel(void)
@@ -319,147 +621,232 @@ uint8_t BK4802GetVolLevel(void)
     return 0; // not implemented
 }
 
-xBool nDivCacl(float freq, float *outnDiv, uint16_t *outRegs)
+// 频段序号(应用频偏后),超出范围返回BK4802_BAND_NUM
+uint8_t BK4802BandIndex(uint32_t freqHz)
 {
+    return BK4802PllBandIndex((uint32_t)((int32_t)freqHz + g_freqOffsetHz));
+}
 
-    // step1:确定分批系数
-    if (freq <= 512 && freq > 384)
-    {
-        *outRegs = 0x0002;
-        *outnDiv = 4.0000; // 4x1
-        return true;
-    }
-    else if (freq <= 170 && freq >= 128)
+xBool BK4802CalcPllRegs(uint32_t freqHz, int32_t offsetHz, xBool isTxPath, uint16_t *outRegs)
+{
+    uint32_t adjHz = (uint32_t)((int32_t)freqHz + offsetHz); // 应用偏移后的目标射频频率
+    return BK4802PllRegs(adjHz, isTxPath, outRegs) ? xTrue : xFalse;
+}
+
+void BK4802Default(void)
+{
+    for (int i = 0; i < BK4802CommonRegNum; i++)
     {
-        *outRegs = 0x2004;
-        *outnDiv = 12.0000; // 4x3
-        return true;
+        BK4802RegSet(commonConfig[i].addr, commonConfig[i].value);
     }
-    else if (freq <= 57 && freq >= 43)
+}
+
+// 载入收/发模式寄存器、通用寄存器、动态寄存器及频率寄存器，只写入有变化的部分
+static void BK4802LoadConfig(const BK4802Reg *modeCfg, int modeCfgNum, const BK4802Reg *freqRegs)
+{
+    // step1:设置寄存器
+    for (int i = 0; i < modeCfgNum; i++)
     {
-        *outRegs = 0x8008;
-        *outnDiv = 36.0000; // 4x9
-        return true;
+        BK4802RegSet(modeCfg[i].addr, modeCfg[i].value);
     }
-    else if (freq <= 46 && freq >= 35)
+    BK4802Default();
+    // step2: 设置动态寄存器
+    for (int i = 0; i < BK4802DynamicRegNum; i++)
     {
-        *outRegs = 0xA00A;
-        *outnDiv = 44.0000; // 4x11
-        return true;
+        BK4802RegSet(dynamicConfig[i].addr, dynamicConfig[i].value);
     }
-    else if (freq <= 32 && freq >= 24)
+    // step3:设置频率
+    for (int i = 0; i < 3; i++)
     {
-        *outRegs = 0xC00F;
-        *outnDiv = 64.0000; // 4x16
-        return true;
+        BK4802RegSet(freqRegs[i].addr, freqRegs[i].value);
     }
-    else
+    BK4802RegSync();
+    BK4802StatusInvalidate();
+}
+
+static void BK4802PllCacheInvalidate(void)
+{
+    for (int i = 0; i < BK4802_PLL_CACHE_SIZE; i++)
     {
-        return false;
+        pllCache[i].valid = 0;
     }
 }
 
-void BK4802Default(void)
+void BK4802GetPllCacheStats(uint32_t *hit, uint32_t *miss)
 {
-    for (int i = 0; i < BK4802CommonRegNum; i++)
+    *hit = pllCacheHit;
+    *miss = pllCacheMiss;
+}
+
+// 写入预先计算的寄存器(如信道存储),之后按该频率加载时直接命中
+xBool BK4802PllCachePut(uint32_t freqHz, int32_t offsetHz, xBool isTxPath, const uint16_t *regs)
+{
+    BK4802PllCacheEntry *entry = &pllCache[pllCacheNext];
+    const BK4802Band *band = BK4802PllBand((uint32_t)((int32_t)freqHz + offsetHz));
+    uint32_t word;
+    if (offsetHz != g_freqOffsetHz || band == NULL)
     {
-        BK4802WriteReg(commonConfig[i].addr, commonConfig[i].value);
+        return xFalse; // 按其他频偏计算的寄存器已失效
     }
+    for (int i = 0; i < BK4802_PLL_CACHE_SIZE; i++)
+    {
+        if (pllCache[i].valid && pllCache[i].freqHz == freqHz && pllCache[i].isTx == isTxPath)
+        {
+            entry = &pllCache[i];
+            break;
+        }
+    }
+    if (entry == &pllCache[pllCacheNext])
+    {
+        pllCacheNext = (pllCacheNext + 1) % BK4802_PLL_CACHE_SIZE;
+    }
+    memcpy(entry->regs, regs, sizeof(entry->regs));
+    word = ((uint32_t)regs[0] << 16) | regs[1];
+    entry->actualHz = (uint32_t)(((uint64_t)word * BK4802_PLL_DEN) >> 20) / band->nDiv;
+    entry->freqHz = freqHz;
+    entry->isTx = isTxPath;
+    entry->valid = 1;
+    return xTrue;
 }
 
-void BK4802Tx(float freq)
+// 计算频率寄存器,返回实际量化后的频率(Hz),失败返回0
+static uint32_t BK4802FreqRegs(uint32_t freqHz, xBool isTxPath, BK4802Reg *freqRegs)
 {
-    BK4802Reg freqRegs[3];
-    freqRegs[0].addr = 0;
-    freqRegs[1].addr = 1;
-    freqRegs[2].addr = 2;
-    float nDiv;
-    uint32_t txValue;
-    float adjFreq = freq + g_freqOffsetMHz; // 应用偏移后的目标射频频率
+    BK4802PllCacheEntry *entry = NULL;
+    const BK4802Band *band;
+    uint32_t word;
+    uint16_t regs[3];
 
-    g_lastUserFreqMHz = freq; // 记录原始用户频率
-
-    if (nDivCacl(adjFreq, &nDiv, &freqRegs[2].value) == false)
+    g_lastUserFreqHz = freqHz; // 记录原始用户频率
+    for (int i = 0; i < BK4802_PLL_CACHE_SIZE; i++)
     {
-        log_w("freq(含偏移)超出范围: req=%.6f MHz, offset=%.6f MHz, adj=%.6f MHz", freq, g_freqOffsetMHz, adjFreq);
-        return;
+        if (pllCache[i].valid && pllCache[i].freqHz == freqHz && pllCache[i].isTx == isTxPath)
+        {
+            entry = &pllCache[i];
+            break;
+        }
     }
-    txValue = (uint32_t)(adjFreq * nDiv * TWO24 / CRYSTAL);
-    freqRegs[0].value = (uint16_t)((txValue >> 16) & 0xFFFF);
-    freqRegs[1].value = (uint16_t)(txValue & 0xFFFF);
 
-    isTx = true;
-
-    // 等待模块切换到发射状态
-    HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, GPIO_PIN_SET); // TX
-    HAL_Delay(30);
+    if (entry != NULL)
+    {
+        pllCacheHit++;
+    }
+    else
+    {
+        pllCacheMiss++;
+        // 先算到局部数组,成功后才占用缓存槽,失败时不会清掉槽里原有的有效项
+        if (BK4802CalcPllRegs(freqHz, g_freqOffsetHz, isTxPath, regs) == xFalse)
+        {
+            log_w("freq(含偏移)超出范围: req=%lu Hz, offset=%ld Hz", (unsigned long)freqHz, (long)g_freqOffsetHz);
+            return 0;
+        }
+        entry = &pllCache[pllCacheNext];
+        memcpy(entry->regs, regs, sizeof(entry->regs));
+        // 由寄存器量化后的实际本振频率,仅用于日志
+        band = BK4802PllBand((uint32_t)((int32_t)freqHz + g_freqOffsetHz));
+        word = ((uint32_t)regs[0] << 16) | regs[1];
+        entry->actualHz = (uint32_t)(((uint64_t)word * BK4802_PLL_DEN) >> 20) / band->nDiv;
+        entry->freqHz = freqHz;
+        entry->isTx = isTxPath;
+        entry->valid = 1;
+        pllCacheNext = (pllCacheNext + 1) % BK4802_PLL_CACHE_SIZE;
+    }
 
-    // step1:设置寄存器
-    for (int i = 0; i < BK4802TxRegNum; i++)
+    for (int i = 0; i < 3; i++)
     {
-        BK4802WriteReg(txConfig[i].addr, txConfig[i].value);
+        freqRegs[i].addr = i;
+        freqRegs[i].value = entry->regs[i];
     }
-    BK4802Default();
-    // step2: 设置动态寄存器
-    for (int i = 0; i < sizeof(dynamicConfig) / sizeof(dynamicConfig[0]); i++)
+    return entry->actualHz;
+}
+
+// 扫描用快速重调谐: 只更新频率寄存器,不经过PLL缓存(避免挤掉常用信道),不输出日志
+xBool BK4802RetuneRxHz(uint32_t freqHz)
+{
+    uint16_t regs[3];
+    if (isTx || BK4802CalcPllRegs(freqHz, g_freqOffsetHz, xFalse, regs) == xFalse)
     {
-        BK4802WriteReg(dynamicConfig[i].addr, dynamicConfig[i].value);
+        return xFalse;
     }
+    BK4802RegSet(2, regs[2]);
+    BK4802RegSet(0, regs[0]);
+    BK4802RegSet(1, regs[1]);
+    BK4802RegSync();
+    BK4802StatusInvalidate();
+    return BK4802IsError() ? xFalse : xTrue;
+}
 
-    // step2:设置频率,从高位到低位
-    BK4802WriteReg(freqRegs[2].addr, freqRegs[2].value);
-    BK4802WriteReg(freqRegs[0].addr, freqRegs[0].value);
-    BK4802WriteReg(freqRegs[1].addr, freqRegs[1].value);
+// 切换TRX脚(PA8),高电平为发射,芯片需要BK4802_TRX_SETTLE_MS稳定后再加载寄存器
+void BK4802TrxPin(xBool tx)
+{
+    isTx = tx;
+    HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, tx ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
 
-    double actualMHz = ((double)txValue * (double)CRYSTAL) / ((double)nDiv * (double)TWO24);
-    log_i("TX req:%.4f MHz off:%.6f MHz adj:%.4f MHz actual:%.6f MHz nDiv:%.1f r2:%04x r0:%04x r1:%04x",
-          freq, g_freqOffsetMHz, adjFreq, actualMHz, nDiv, freqRegs[2].value, freqRegs[0].value, freqRegs[1].value);
+static void BK4802LoadRegs(uint32_t freqHz, uint32_t actualHz, const BK4802Reg *freqRegs)
+{
+    if (isTx)
+    {
+        BK4802LoadConfig(txConfig, BK4802TxRegNum, freqRegs);
+        log_i("TX req:%lu Hz off:%ld Hz actual:%lu Hz r2:%04x r0:%04x r1:%04x",
+              (unsigned long)freqHz, (long)g_freqOffsetHz, (unsigned long)actualHz, freqRegs[2].value, freqRegs[0].value, freqRegs[1].value);
+    }
+    else
+    {
+        BK4802LoadConfig(rxConfig, BK4802RxRegNum, freqRegs);
+        // 接收路径为本振=RF-IF
+        log_i("RX req:%lu Hz off:%ld Hz actualLO:%lu Hz r2:%04x r0:%04x r1:%04x",
+              (unsigned long)freqHz, (long)g_freqOffsetHz, (unsigned long)actualHz, freqRegs[2].value, freqRegs[0].value, freqRegs[1].value);
+    }
 }
 
-void BK4802Rx(float freq)
+// 按当前TRX状态加载收/发寄存器组,不等待
+void BK4802LoadHz(uint32_t freqHz)
 {
     BK4802Reg freqRegs[3];
-    freqRegs[0].addr = 0;
-    freqRegs[1].addr = 1;
-    freqRegs[2].addr = 2;
-    float nDiv;
-    uint32_t rx;
-    float adjFreq = freq + g_freqOffsetMHz; // 应用偏移后的目标射频频率
-
-    g_lastUserFreqMHz = freq; // 记录原始用户频率
-    if (nDivCacl(adjFreq, &nDiv, &freqRegs[2].value) == false)
+    uint32_t actualHz = BK4802FreqRegs(freqHz, isTx, freqRegs);
+    if (actualHz == 0)
     {
-        log_w("freq(含偏移)超出范围: req=%.6f MHz, offset=%.6f MHz, adj=%.6f MHz", freq, g_freqOffsetMHz, adjFreq);
         return;
     }
-    // 接收路径：本振 = 期望RF - IF，因此加偏移后本振应 = (adjFreq - IF)
-    rx = (uint32_t)(((adjFreq - IF * 1.000f) * nDiv * TWO24) / CRYSTAL);
-    freqRegs[0].value = (uint16_t)((rx >> 16) & 0xFFFF);
-    freqRegs[1].value = (uint16_t)(rx & 0xFFFF);
-    isTx = false;
-    HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, GPIO_PIN_RESET); // 迅速速切换到RX
-    HAL_Delay(30);
+    BK4802LoadRegs(freqHz, actualHz, freqRegs);
+}
 
-    // step1:设置寄存器
-    for (int i = 0; i < BK4802RxRegNum; i++)
+// 阻塞切换,仅TRX脚实际翻转时才等待稳定,同一状态下重调谐不再延时
+static void BK4802SwitchHz(xBool tx, uint32_t freqHz)
+{
+    BK4802Reg freqRegs[3];
+    uint32_t actualHz = BK4802FreqRegs(freqHz, tx, freqRegs);
+    if (actualHz == 0)
     {
-        BK4802WriteReg(rxConfig[i].addr, rxConfig[i].value);
+        return;
     }
-    BK4802Default();
-    // step2: 设置动态寄存器
-    for (int i = 0; i < sizeof(dynamicConfig) / sizeof(dynamicConfig[0]); i++)
+    if (isTx != tx)
     {
-        BK4802WriteReg(dynamicConfig[i].addr, dynamicConfig[i].value);
+        BK4802TrxPin(tx);
+        HAL_Delay(BK4802_TRX_SETTLE_MS);
     }
+    BK4802LoadRegs(freqHz, actualHz, freqRegs);
+}
+
+void BK4802TxHz(uint32_t freqHz)
+{
+    BK4802SwitchHz(xTrue, freqHz);
+}
 
-    // step3:设置频率,从高位到低位
-    BK4802WriteReg(freqRegs[2].addr, freqRegs[2].value);
-    BK4802WriteReg(freqRegs[0].addr, freqRegs[0].value);
-    BK4802WriteReg(freqRegs[1].addr, freqRegs[1].value);
-    // 计算由寄存器量化后的实际本振频率（接收路径为本振=RF-IF）
-    double actualRxMHz = ((double)rx * (double)CRYSTAL) / ((double)nDiv * (double)TWO24);
-    log_i("RX req:%.4f MHz off:%.6f MHz adj:%.4f MHz actualLO:%.6f MHz nDiv:%.1f r2:%04x r0:%04x r1:%04x",
-          freq, g_freqOffsetMHz, adjFreq, actualRxMHz, nDiv, freqRegs[2].value, freqRegs[0].value, freqRegs[1].value);
+void BK4802RxHz(uint32_t freqHz)
+{
+    BK4802SwitchHz(xFalse, freqHz);
+}
+
+void BK4802Tx(float freq)
+{
+    BK4802TxHz(BK4802MHzToHz(freq));
+}
+
+void BK4802Rx(float freq)
+{
+    BK4802RxHz(BK4802MHzToHz(freq));
 }
 
 void BK4802Init(void)
@@ -487,14 +874,21 @@ void BK4802Init(void)
     HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, GPIO_PIN_RESET);
 
     // 初始化BK4802
+#if (BK4802_BUS == BK4802_BUS_HW_I2C)
+    BK4802I2cInit();
+#elif (BK4802_BUS == BK4802_BUS_SOFT_I2C_FAST)
+    softI2cFastInit(&SoftIICPort);
+#else
     softI2cInit(&SoftIICPort);
+#endif
     HAL_Delay(100); // 启动延时，不能立即设置模块。
     BK4802Rx(438.5000);
 }
 
-void BK4802Reset(float freq)
+void BK4802Reset(uint32_t freqHz)
 {
-    BK4802Rx(freq);
+    BK4802RegResync(); // 芯片状态未知,强制全部寄存器重新写入
+    BK4802RxHz(freqHz);
 }
 
 void BK4802DebugTask(void)
@@ -526,14 +920,19 @@ void BK4802Disable(void)
 }
 
 void BK4802Flush(float freq)
+{
+    BK4802FlushHz(BK4802MHzToHz(freq));
+}
+
+void BK4802FlushHz(uint32_t freqHz)
 {
     if (isTx)
     {
-        BK4802Tx(freq);
+        BK4802TxHz(freqHz);
     }
     else
     {
-        BK4802Rx(freq);
+        BK4802RxHz(freqHz);
     }
 }
 
@@ -542,9 +941,10 @@ xBool BK4802IsTx(void)
     return isTx;
 }
 
+// 最近一次访问出错,或本节拍状态快照读取出错
 xBool BK4802IsError(void)
 {
-    return SoftIICPort.isErr;
+    return BK4802BusError() || statusErr;
 }
 
 // RSSI滤波相关变量
@@ -564,24 +964,26 @@ xBool BK4802IsRx(void)
     if (!lastRxState)
     {
         filteredRssi = rxNotDetectedAlpha * rssi + (1.0f - rxNotDetectedAlpha) * filteredRssi;
-        // 当前不是接收状态，检查是否进入接收
-        if ((filteredRssi > softRSSIThre + hysteresis) && (snr >= BK4802_SNR_BAD_THRE) && (isTx == xFalse))
-        {
-            lastRxState = xTrue;
-        }
     }
     else
     {
         filteredRssi = rxDetectedAlpha * rssi + (1.0f - rxDetectedAlpha) * filteredRssi;
-        if (filteredRssi < softRSSIThre - hysteresis || (snr < BK4802_SNR_BAD_THRE))
-        {
-            lastRxState = xFalse;
-        }
     }
-
+    lastRxState = BK4802RxDetect(filteredRssi, snr, lastRxState);
     return lastRxState;
 }
 
+// 滞后比较: 未接收时需高于阈值+滞后值才进入接收,接收中低于阈值-滞后值才退出
+xBool BK4802RxDetect(float rssi, uint8_t snr, xBool isOpen)
+{
+    if (!isOpen)
+    {
+        // 当前不是接收状态，检查是否进入接收
+        return (rssi > softRSSIThre + hysteresis) && (snr >= BK4802_SNR_BAD_THRE) && (isTx == xFalse);
+    }
+    return (rssi < softRSSIThre - hysteresis || (snr < BK4802_SNR_BAD_THRE)) ? xFalse : xTrue;
+}
+
 uint8_t BK4802GetSMeter(void)
 {
     // RSSI量化，返回1~9
@@ -644,7 +1046,8 @@ uint8_t BK4802GetSMeter(void)
     return smeter;
 }
 
-void BK4802SetPower(uint8_t level)
+// 只更新动态配置中的功率,不写芯片,下次BK4802Flush时随其它寄存器一起同步
+xBool BK4802SetPowerCfg(uint8_t level)
 {
     uint16_t readVal = 0;
     if (level > 2)
@@ -657,7 +1060,7 @@ void BK4802SetPower(uint8_t level)
     if (readVal == 0)
     {
         log_e("Failed to read register 8");
-        return;
+        return xFalse;
     }
 
     // 量化功率,分为3档
@@ -678,32 +1081,46 @@ void BK4802SetPower(uint8_t level)
         break;
     }
     log_d("setting reg 8 to 0x%04X", readVal);
-    BK4802WriteReg(8, readVal);
     BK4802SetDynamicCfg(8, readVal);
+    return xTrue;
+}
+
+void BK4802SetPower(uint8_t level)
+{
+    if (BK4802SetPowerCfg(level))
+    {
+        BK4802RegUpdate(8, BK4802GetDynamicCfg(8));
+    }
 }
 
 void BK4802SetFreqOffsetHz(float offsetHz)
 {
-    g_freqOffsetMHz = offsetHz / 1e6f;
-    log_i("Set Freq Offset: %.2f Hz (内部=%.6f MHz)", offsetHz, g_freqOffsetMHz);
+    int32_t newOffsetHz = (int32_t)(offsetHz >= 0 ? offsetHz + 0.5f : offsetHz - 0.5f);
+    if (newOffsetHz != g_freqOffsetHz)
+    {
+        BK4802PllCacheInvalidate(); // 缓存的寄存器值包含旧的偏移
+    }
+    g_freqOffsetHz = newOffsetHz;
+    log_i("Set Freq Offset: %ld Hz", (long)g_freqOffsetHz);
 }
 
 void BK4802SetFreqOffsetPPM(float ppm)
 {
     // ppm = 1e-6，相对频率误差
-    float offsetMHz = g_lastUserFreqMHz * (ppm * 1e-6f);
-    g_freqOffsetMHz = offsetMHz;
-    log_i("Set Freq Offset by PPM: ppm=%.2f -> off=%.6f MHz (lastUser=%.6f MHz)", ppm, g_freqOffsetMHz, g_lastUserFreqMHz);
+    float offsetHz = (float)g_lastUserFreqHz * (ppm * 1e-6f);
+    g_freqOffsetHz = (int32_t)(offsetHz >= 0 ? offsetHz + 0.5f : offsetHz - 0.5f);
+    BK4802PllCacheInvalidate();
+    log_i("Set Freq Offset by PPM: ppm=%.2f -> off=%ld Hz (lastUser=%lu Hz)", ppm, (long)g_freqOffsetHz, (unsigned long)g_lastUserFreqHz);
 }
 
 float BK4802GetFreqOffsetHz(void)
 {
-    return g_freqOffsetMHz * 1e6f;
+    return (float)g_freqOffsetHz;
 }
 
 float BK4802GetFreqOffsetMHz(void)
 {
-    return g_freqOffsetMHz;
+    return (float)g_freqOffsetHz / 1e6f;
 }
 
 float BK4802QuantizeFreq(float freqMHz, float stepHz)
@@ -735,7 +1152,7 @@ void BK4802IFGainLevel(uint8_t level)
     dynamicConfig[0].value &= ~(0x07 << 13); // 清除B15~B13位
     dynamicConfig[0].value |= (level << 13);
     writeLevel = dynamicConfig[0].value;
-    BK4802WriteReg(7, writeLevel);
+    BK4802RegUpdate(7, writeLevel);
     log_d("setting IF Gain Level to %d, reg7=0x%04X", level, writeLevel);
 }
 uint8_t BK4802GetCurThre(void)
@@ -1,6 +1,7 @@
 #ifndef __BK4802_H__
 #define __BK4802_H__
 #include "components.h"
+#include "BK4802Pll.h"
 
 void BK4802Init(void);
 
@@ -13,20 +14,32 @@ uint8_t BK4802GetRSSIThre(void);
 // void BK4802Enable(void);
 // void BK4802Disable(void);
 void BK4802SetPower(uint8_t level);
+xBool BK4802SetPowerCfg(uint8_t level); // 只更新配置,下次BK4802Flush时写入
 uint16_t BK4802GetDynamicCfg(uint8_t cfgReg); // 从配置数组中获取指定的寄存器参数
 void BK4802SetDynamicCfg(uint8_t cfgReg, uint16_t value);
 uint8_t BK4802SNRRead(void);
 uint8_t BK4802RSSIRead(void);
+uint8_t BK4802AFCResidualRead(void);
+uint32_t BK4802GetStatusStamp(void);
 uint8_t BK4802RXVolumeRead(void);
 uint8_t BK4802readASKOUT(void);
 void BK4802Tx(float freq);
 void BK4802Rx(float freq);
+void BK4802TxHz(uint32_t freqHz);
+void BK4802RxHz(uint32_t freqHz);
+// 非阻塞收发切换: 先切TRX脚,等待BK4802_TRX_SETTLE_MS后再按当前状态加载寄存器
+#define BK4802_TRX_SETTLE_MS 30
+void BK4802TrxPin(xBool tx);
+void BK4802LoadHz(uint32_t freqHz);
 // 可以通过此函数刷新状态
 void BK4802Flush(float freq);
+void BK4802FlushHz(uint32_t freqHz);
 xBool BK4802IsTx(void); // 是否在发送状态
 xBool BK4802IsRx(void); // 是否在接收状态
-xBool BK4802IsError(void);
-void BK4802Reset(float freq);
+xBool BK4802RxDetect(float rssi, uint8_t snr, xBool isOpen); // BK4802IsRx的滞后判定,isOpen为当前状态
+void BK4802StatusInvalidate(void); // 状态寄存器在下次读取时重新采样
+xBool BK4802IsError(void); // 最近一次访问或本节拍的状态读取出错
+void BK4802Reset(uint32_t freqHz);
 void BK4802DebugTask(void);
 uint8_t BK4802GetSMeter(void); // 量化RSSI,返回1~9
 uint8_t BK4802GetCurThre(void); // 获取当前RSSI阈值
@@ -40,4 +53,14 @@ float BK4802GetFreqOffsetMHz(void);                       // 获取当前偏移(
 float BK4802QuantizeFreq(float freqMHz, float stepHz);    // 辅助量化
 void BK4802FlushWithStep(float reqFreqMHz, float stepHz); // 刷新时应用量化
 void BK4802IFGainLevel(uint8_t level);                    // IF增益设置 0~7
+
+// 整数频率计算接口(Hz)
+// 计算频率寄存器 outRegs[0]=reg0 outRegs[1]=reg1 outRegs[2]=reg2,频率超出范围时返回xFalse
+xBool BK4802CalcPllRegs(uint32_t freqHz, int32_t offsetHz, xBool isTxPath, uint16_t *outRegs);
+// 扫描: 接收状态下只写频率寄存器,不经过PLL缓存;频段序号用于按频段标定PLL稳定时间
+xBool BK4802RetuneRxHz(uint32_t freqHz);
+uint8_t BK4802BandIndex(uint32_t freqHz); // 超出范围返回BK4802_BAND_NUM
+void BK4802GetPllCacheStats(uint32_t *hit, uint32_t *miss); // PLL寄存器缓存命中/未命中次数
+// 放入预先计算的频率寄存器(BK4802CalcPllRegs的结果),offsetHz与当前频偏不一致时返回xFalse
+xBool BK4802PllCachePut(uint32_t freqHz, int32_t offsetHz, xBool isTxPath, const uint16_t *regs);
 #endif
\ No newline at end of file
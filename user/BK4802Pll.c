@@ -0,0 +1,79 @@
+/*
+ *BK4802 PLL frequency word calculation
+ */
+#include "BK4802Pll.h"
+#include <stddef.h>
+
+// 分频段表,按顺序匹配(43~46MHz重叠区优先使用36分频)
+static const BK4802Band bandTable[] =
+    {
+        {384000001UL, 512000000UL, 0x0002, 4}, // 4x1
+        {128000000UL, 170000000UL, 0x2004, 12}, // 4x3
+        {43000000UL, 57000000UL, 0x8008, 36},   // 4x9
+        {35000000UL, 46000000UL, 0xA00A, 44},   // 4x11
+        {24000000UL, 32000000UL, 0xC00F, 64},   // 4x16
+};
+#define BK4802BandNum (sizeof(bandTable) / sizeof(bandTable[0]))
+
+// BK4802_BAND_NUM must match bandTable (sizeof不能用于#if)
+typedef char BK4802BandNumCheck[(BK4802BandNum == BK4802_BAND_NUM) ? 1 : -1];
+
+const BK4802Band *BK4802PllBand(uint32_t rfHz)
+{
+    for (uint8_t i = 0; i < BK4802BandNum; i++)
+    {
+        if (rfHz >= bandTable[i].minHz && rfHz <= bandTable[i].maxHz)
+        {
+            return &bandTable[i];
+        }
+    }
+    return NULL;
+}
+
+uint8_t BK4802PllBandIndex(uint32_t rfHz)
+{
+    const BK4802Band *band = BK4802PllBand(rfHz);
+    return band == NULL ? BK4802_BAND_NUM : (uint8_t)(band - bandTable);
+}
+
+// floor(vcoHz * 2^20 / 1328125),拆成3次32位除法,耗时固定且结果精确
+uint32_t BK4802PllWord(uint32_t vcoHz)
+{
+    uint32_t word;
+    uint32_t rem;
+    word = (vcoHz / BK4802_PLL_DEN) << 20;
+    rem = (vcoHz % BK4802_PLL_DEN) << 10;
+    word |= (rem / BK4802_PLL_DEN) << 10;
+    rem = (rem % BK4802_PLL_DEN) << 10;
+    word |= rem / BK4802_PLL_DEN;
+    return word;
+}
+
+int BK4802PllRegs(uint32_t rfHz, int isTxPath, uint16_t *outRegs)
+{
+    const BK4802Band *band = BK4802PllBand(rfHz);
+    uint32_t loHz = rfHz;
+    uint32_t word;
+    if (band == NULL)
+    {
+        return 0;
+    }
+    if (!isTxPath)
+    {
+        // 接收路径：本振 = 期望RF - IF
+        loHz = rfHz - BK4802_IF_HZ;
+    }
+    word = BK4802PllWord(loHz * band->nDiv);
+    outRegs[0] = (uint16_t)((word >> 16) & 0xFFFF);
+    outRegs[1] = (uint16_t)(word & 0xFFFF);
+    outRegs[2] = band->reg2;
+    return 1;
+}
+
+uint32_t BK4802MHzToHz(float freqMHz)
+{
+    uint32_t mhz = (uint32_t)freqMHz;
+    uint32_t hz = mhz * 1000000UL + (uint32_t)((freqMHz - (float)mhz) * 1e6f + 0.5f);
+    // 单精度在430MHz附近的分辨率约30Hz,还原到50Hz栅格
+    return (hz + BK4802_FREQ_GRID_HZ / 2) / BK4802_FREQ_GRID_HZ * BK4802_FREQ_GRID_HZ;
+}
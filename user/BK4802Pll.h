@@ -0,0 +1,37 @@
+/*
+ *BK4802 PLL frequency word calculation
+ *纯C实现,不依赖HAL,主机端可直接编译使用
+ *
+ *N分频字 = floor(本振Hz * 分频系数 * 2^24 / 21.25MHz), reg0为高16位, reg1为低16位
+ *reg2为频段的分频设置, 接收路径本振 = RF - IF
+ */
+#ifndef __BK4802_PLL_H__
+#define __BK4802_PLL_H__
+#include <stdint.h>
+
+#define BK4802_IF_HZ 137000UL
+#define BK4802_CRYSTAL_HZ 21250000UL
+// 2^24 / 21.25MHz 约去公因子2^4后为 2^20 / 1328125
+#define BK4802_PLL_DEN (BK4802_CRYSTAL_HZ >> 4)
+#define BK4802_FREQ_GRID_HZ 50 // 6.25k/12.5k信道及AT的100Hz分辨率均为50Hz的整数倍
+#define BK4802_BAND_NUM 5
+
+typedef struct
+{
+    uint32_t minHz;
+    uint32_t maxHz;
+    uint16_t reg2; // 分频设置寄存器
+    uint8_t nDiv;
+} BK4802Band;
+
+// 按RF频率(已含频偏)查找频段,超出范围返回NULL
+const BK4802Band *BK4802PllBand(uint32_t rfHz);
+// 频段序号,超出范围返回BK4802_BAND_NUM
+uint8_t BK4802PllBandIndex(uint32_t rfHz);
+// N分频字,vcoHz = 本振Hz * 分频系数
+uint32_t BK4802PllWord(uint32_t vcoHz);
+// outRegs[0]=reg0 outRegs[1]=reg1 outRegs[2]=reg2,频率超出范围返回0
+int BK4802PllRegs(uint32_t rfHz, int isTxPath, uint16_t *outRegs);
+// MHz转Hz,还原到50Hz栅格
+uint32_t BK4802MHzToHz(float freqMHz);
+#endif
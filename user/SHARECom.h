@@ -17,6 +17,61 @@ typedef struct
     uint8_t txPwr;   // 0 low 1 mid 2 high
     uint8_t smeter;  // S meter level 1~9
     uint8_t rfEnable; // 1: allow TX 0: forbid TX (AT+RF=ENABLE/DISABLE)
+    uint32_t baud;    // AT link baud rate
+    uint16_t trxAntMs;  // PTT: antenna path settle before TRX pin
+    uint16_t trxPinMs;  // TRX pin settle before register load
+    uint16_t trxRampMs; // TX power ramp step, 0 no ramp
+    uint8_t chSel;      // last recalled memory channel (AT+CHSEL), CHANNEL_NONE if none
+    uint8_t scanMode;     // AT+SCAN request: SHARE_SCAN_MODE_xx
+    uint8_t scanHold;     // 1: stop on activity, 0: sweep continuously
+    uint32_t scanStartHz; // range mode only
+    uint32_t scanStopHz;
+    uint32_t scanStepHz;
+    uint16_t watchPeriodMs; // AT+DUALW priority channel check period, 0 off
+    uint32_t watchHz;       // priority channel
 } SHARECom;
 
+// telemetry snapshot filled by the radio module, pushed by AT+STREAM
+#define SHARE_TELEM_ERR_BUS 0x01         // BK4802 bus error
+#define SHARE_TELEM_ERR_RF_DISABLED 0x02 // PTT ignored, RF disabled via AT+RF
+#define SHARE_TELEM_ERR_OVERLOAD 0x04    // RSSI overload at minimum IF gain
+typedef struct
+{
+    uint8_t rssi;     // reg24 RSSI
+    uint8_t snr;      // reg24 SNR
+    uint8_t smeter;   // S meter level 1~9
+    uint8_t sqlOpen;  // 1: squelch open (audio out)
+    uint8_t ptt;      // 1: PTT active
+    uint8_t ifGain;   // AGC IF gain level 0~7
+    uint8_t afc;      // reg25 AFC residual
+    uint8_t errFlags; // SHARE_TELEM_ERR_xx
+} SHARETelemetry;
+
+// squelch/PTT edge events kept by the radio module, queried by AT+EVENTS
+#define SHARE_EVENT_SQL 'S'     // squelch open(1)/close(0)
+#define SHARE_EVENT_PTT 'P'     // PTT on(1)/off(0)
+#define SHARE_EVENT_RING_SIZE 8 // latest events kept, power of 2
+typedef struct
+{
+    uint8_t type;  // SHARE_EVENT_xx
+    uint8_t state; // new state after the edge
+    uint32_t us;   // micros() at detection
+} SHAREEvent;
+
+// scanner results kept by the scan module, pushed while AT+SCAN is running
+#define SHARE_SCAN_MODE_OFF 0
+#define SHARE_SCAN_MODE_LIST 1  // memory channels (AT+CHMEM)
+#define SHARE_SCAN_MODE_RANGE 2 // startHz..stopHz by stepHz
+#define SHARE_SCAN_HIT 'H'      // activity: value=Hz, rssi/snr of the sample
+#define SHARE_SCAN_SWEEP 'W'    // sweep done: value=channels per second
+#define SHARE_SCAN_RING_SIZE 8  // latest results kept, power of 2
+typedef struct
+{
+    uint8_t type;  // SHARE_SCAN_xx
+    uint8_t index; // channel index in the scan list, channel count for SWEEP
+    uint8_t rssi;
+    uint8_t snr;
+    uint32_t value;
+} SHAREScan;
+
 #endif
\ No newline at end of file
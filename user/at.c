@@ -5,6 +5,28 @@ static xRingBuf_t uartRecvBufHandler;
 static uint8_t uartRecvBufData[UART_RECV_BUF_SIZE + 2];
 static uint8_t uartIsrBuffer[64]; // 中断接收缓冲区
 static bool isATEnable = xTrue;
+// 发送环形缓冲区,由发送完成中断分块搬运,AT回复不再阻塞调度器
+static xRingBuf_t uartSendBufHandler;
+static uint8_t uartSendBufData[UART_SEND_BUF_SIZE + 2];
+#if (UART_SEND_BUF_SIZE < AT_CMD_SEND_BYTE_MAX)
+#error "UART_SEND_BUF_SIZE must hold a full AT reply"
+#endif
+static uint8_t uartTxChunk[UART_SEND_CHUNK_SIZE]; // 正在发送的数据块
+static volatile uint8_t uartTxBusy = 0;
+static uint32_t uartTxQueued = 0;  // 累计入队字节
+static uint32_t uartTxDropped = 0; // 缓冲区放不下而整条丢弃的字节
+static uint32_t uartTxPeak = 0;    // 缓冲区最高占用
+// 波特率切换: 旧波特率回复后切换,确认窗口内收到有效指令才保存,否则回退
+static const uint32_t uartBaudList[] = {UART_BAUD_DEFAULT, 115200, 230400, 460800, 921600};
+static xBool uartBaudPending = xFalse;
+static uint32_t uartBaudFallback = UART_BAUD_DEFAULT;
+static uint32_t uartBaudDeadline = 0;
+// 接收中断检测到行结束后立即触发atTask,不再等待10ms轮询
+static uint8_t atTaskId = SCH_MAX_TASKS;
+static volatile uint8_t atLinePending = 0;
+static volatile uint8_t atTxWaitRoom = 0;                // 接收处理因发送缓冲不足暂停,腾出空间后由发送完成中断触发atTask
+static volatile uint32_t atLineStamp = 0;                // 最早未处理行的接收时刻
+static uint32_t atLatencyHist[AT_LATENCY_HIST_SIZE] = {0}; // 行结束到处理完成的耗时,log2(ms)分桶
 uint16_t atRecvCb(uint8_t *bytes, uint16_t len)
 {
     uint16_t tmp;
@@ -12,9 +34,156 @@ uint16_t atRecvCb(uint8_t *bytes, uint16_t len)
     return tmp;
 }
 
+// 启动下一块发送,仅在发送空闲时调用(主循环关中断调用或发送完成中断中调用)
+static void atTxKick(void)
+{
+    uint16_t len;
+    if (uartTxBusy)
+    {
+        return;
+    }
+    len = xRingBufGet(&uartSendBufHandler, uartTxChunk, sizeof(uartTxChunk));
+    if (len == 0)
+    {
+        return;
+    }
+    uartTxBusy = 1;
+    if (HAL_UART_Transmit_IT(&UartHandle, uartTxChunk, len) != HAL_OK)
+    {
+        uartTxBusy = 0;
+        uartTxDropped += len;
+    }
+}
+
+// 每次调用是一条完整的回复或推送,放不下时整条丢弃,线路上不会出现半条
 void atSendCb(uint8_t *bytes, uint16_t len)
 {
-    HAL_UART_Transmit(&UartHandle, bytes, len, 1000);
+    uint16_t used;
+    HAL_NVIC_DisableIRQ(USART2_IRQn); // 环形缓冲区与发送完成中断共享
+    if (xRingBufFree(&uartSendBufHandler) < len)
+    {
+        uartTxDropped += len;
+    }
+    else
+    {
+        xRingBufPut(&uartSendBufHandler, bytes, len);
+        uartTxQueued += len;
+        used = xRingBufLen(&uartSendBufHandler);
+        if (used > uartTxPeak)
+        {
+            uartTxPeak = used;
+        }
+    }
+    atTxKick();
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+// 发送缓冲区剩余空间,调用者可据此决定是否推迟输出
+uint16_t atSendFree(void)
+{
+    return xRingBufFree(&uartSendBufHandler);
+}
+
+// 等待发送完成,用于复位/跳转bootloader前
+void atSendFlush(uint32_t timeoutMs)
+{
+    uint32_t start = millis();
+    while ((uartTxBusy || !xRingBufEmpty(&uartSendBufHandler)) && (millis() - start < timeoutMs))
+    {
+    }
+}
+
+void atGetTxStats(uint32_t *queued, uint32_t *dropped, uint32_t *peak)
+{
+    *queued = uartTxQueued;
+    *dropped = uartTxDropped;
+    *peak = uartTxPeak;
+}
+
+xBool atBaudIsValid(uint32_t baud)
+{
+    for (int i = 0; i < sizeof(uartBaudList) / sizeof(uartBaudList[0]); i++)
+    {
+        if (uartBaudList[i] == baud)
+        {
+            return xTrue;
+        }
+    }
+    return xFalse;
+}
+
+// 波特率保存在settings的kvStore中
+static uint32_t atBaudLoad(void)
+{
+    uint32_t baud;
+    if (kvStoreGet(SETTINGS_KEY_BAUD, &baud, sizeof(baud)) && atBaudIsValid(baud))
+    {
+        return baud;
+    }
+    return UART_BAUD_DEFAULT;
+}
+
+// 与其他设置合并延迟写入
+static void atBaudSave(uint32_t baud)
+{
+    if (!kvStoreSet(SETTINGS_KEY_BAUD, &baud, sizeof(baud)))
+    {
+        log_e("save baud failed");
+    }
+}
+
+static void atUartApplyBaud(uint32_t baud)
+{
+    HAL_NVIC_DisableIRQ(USART2_IRQn);
+    HAL_UART_Abort(&UartHandle);
+    uartTxBusy = 0;
+    UartHandle.Init.BaudRate = baud;
+    HAL_UART_Init(&UartHandle);
+    __HAL_UART_ENABLE_IT(&UartHandle, UART_IT_IDLE); // 使能空闲中断
+    HAL_UART_Receive_IT(&UartHandle, uartIsrBuffer, sizeof(uartIsrBuffer));
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
+    atTxKick(); // 切换期间入队的数据
+}
+
+// 切换波特率,进入确认窗口,应在AT+BAUD的回复入队后调用
+void atBaudSwitch(uint32_t baud)
+{
+    if (baud == UartHandle.Init.BaudRate || !atBaudIsValid(baud))
+    {
+        return;
+    }
+    atSendFlush(100); // 旧波特率下发完回复
+    if (!uartBaudPending)
+    {
+        uartBaudFallback = UartHandle.Init.BaudRate;
+    }
+    atUartApplyBaud(baud);
+    uartBaudDeadline = millis() + UART_BAUD_CONFIRM_MS;
+    uartBaudPending = xTrue;
+    log_i("baud switch to %d, waiting confirm", baud);
+}
+
+// 新波特率下收到有效指令,确认切换并保存
+void atBaudConfirm(void)
+{
+    if (!uartBaudPending)
+    {
+        return;
+    }
+    uartBaudPending = xFalse;
+    atBaudSave(UartHandle.Init.BaudRate);
+    log_i("baud %d confirmed", UartHandle.Init.BaudRate);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *UartHandle)
+{
+    uartTxBusy = 0;
+    atTxKick();
+    if (atTxWaitRoom && xRingBufFree(&uartSendBufHandler) >= AT_CMD_SEND_BYTE_MAX)
+    {
+        atTxWaitRoom = 0;
+        SCH_Trigger_Task(atTaskId);
+    }
 }
 
 uint32_t atMillisCb(void)
@@ -35,6 +204,7 @@ void atInit(SHARECom *SHARECom)
     __HAL_RCC_GPIOA_CLK_ENABLE();
 
     xRingBufInit(&uartRecvBufHandler, uartRecvBufData, sizeof(uartRecvBufData));
+    xRingBufInit(&uartSendBufHandler, uartSendBufData, sizeof(uartSendBufData));
 
     GPIO_InitStruct.Pin = GPIO_PIN_2 | GPIO_PIN_3;
     GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
@@ -47,7 +217,7 @@ void atInit(SHARECom *SHARECom)
     HAL_NVIC_EnableIRQ(USART2_IRQn);
 
     UartHandle.Instance = USART2;
-    UartHandle.Init.BaudRate = 19200;
+    UartHandle.Init.BaudRate = atBaudLoad();
     UartHandle.Init.WordLength = UART_WORDLENGTH_8B;
     UartHandle.Init.StopBits = UART_STOPBITS_1;
     UartHandle.Init.Parity = UART_PARITY_NONE;
@@ -60,9 +230,58 @@ void atInit(SHARECom *SHARECom)
     __HAL_UART_ENABLE_IT(&UartHandle, UART_IT_IDLE); // 使能空闲中断
     HAL_UART_Receive_IT(&UartHandle, uartIsrBuffer, sizeof(uartIsrBuffer));
     atCOM = SHARECom;
+    atCOM->baud = UartHandle.Init.BaudRate;
     ATCmdInit(&atPort);
 }
 
+// 由main在SCH_Add_Task后传入,接收中断据此触发任务
+void atSetTaskId(uint8_t taskId)
+{
+    atTaskId = taskId;
+}
+
+// 桶0: <1ms, 桶n: [2^(n-1), 2^n) ms, 最后一桶包含更大的值
+static void atLatencyRecord(uint32_t ms)
+{
+    uint8_t bucket = 0;
+    while (ms != 0 && bucket < AT_LATENCY_HIST_SIZE - 1)
+    {
+        ms >>= 1;
+        bucket++;
+    }
+    atLatencyHist[bucket]++;
+}
+
+void atGetLatencyHist(uint32_t *hist)
+{
+    memcpy(hist, atLatencyHist, sizeof(atLatencyHist));
+}
+
+// 将中断接收的数据放入环形缓冲区,遇到行结束触发atTask
+static void atRecvPut(uint8_t *bytes, uint16_t len)
+{
+    xRingBufPut(&uartRecvBufHandler, bytes, len);
+    if (ATCmdIsBinaryMode())
+    {
+        // 二进制帧没有行结束符,收到数据即处理
+        SCH_Trigger_Task(atTaskId);
+        return;
+    }
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (bytes[i] == '\n' || bytes[i] == '\r')
+        {
+            if (!atLinePending)
+            {
+                atLinePending = 1;
+                atLineStamp = millis();
+            }
+            SCH_Trigger_Task(atTaskId);
+            break;
+        }
+    }
+}
+
 uint32_t tCnt = 0;
 void atTask(void)
 {
@@ -73,7 +292,45 @@ void atTask(void)
         log_e("At COM is NULL!");
         return;
     }
-    ATCmdHandler(atCOM);
+    if (uartBaudPending && (int32_t)(millis() - uartBaudDeadline) >= 0)
+    {
+        // 确认窗口内没有收到有效指令,主机可能无法使用新波特率
+        uartBaudPending = xFalse;
+        atUartApplyBaud(uartBaudFallback);
+        atCOM->baud = uartBaudFallback;
+        log_w("baud not confirmed, fallback to %d", uartBaudFallback);
+    }
+    if (atLinePending)
+    {
+        uint32_t stamp = atLineStamp;
+        atLinePending = 0; // 处理期间到达的新行重新计时
+        ATCmdHandler(atCOM);
+        if (ATCmdIsRecvHeld())
+        {
+            atLineStamp = stamp; // 未处理完的行继续计时
+            atLinePending = 1;
+        }
+        else
+        {
+            atLatencyRecord(millis() - stamp);
+        }
+    }
+    else
+    {
+        ATCmdHandler(atCOM);
+    }
+    if (ATCmdIsRecvHeld())
+    {
+        atTxWaitRoom = 1;
+        if (atSendFree() >= AT_CMD_SEND_BYTE_MAX)
+        {
+            SCH_Trigger_Task(atTaskId); // 置标志前发送已完成,不会再有发送完成中断
+        }
+    }
+    else
+    {
+        atTxWaitRoom = 0;
+    }
 }
 
 void HAL_UART_IdleFrameDetectCpltCallback(UART_HandleTypeDef *UartHandle)
@@ -84,7 +341,7 @@ void HAL_UART_IdleFrameDetectCpltCallback(UART_HandleTypeDef *UartHandle)
 
     if (len > 0 && isATEnable)
     {
-        xRingBufPut(&uartRecvBufHandler, uartIsrBuffer, len);
+        atRecvPut(uartIsrBuffer, len);
         memset(uartIsrBuffer, 0, sizeof(uartIsrBuffer));
     }
     else if (isATEnable == xFalse)
@@ -92,8 +349,18 @@ void HAL_UART_IdleFrameDetectCpltCallback(UART_HandleTypeDef *UartHandle)
         log_d("AT is disabled, ignore uart data.");
     }
 
-    // 重新开启接收中断
-    HAL_UART_Abort_IT(UartHandle);
+    // 重新开启接收中断,只终止接收,不影响正在进行的发送
+    HAL_UART_AbortReceive(UartHandle);
+    HAL_UART_Receive_IT(UartHandle, uartIsrBuffer, sizeof(uartIsrBuffer));
+}
+
+// 接收缓冲区填满时(长指令或连续指令)先转存,避免等待空闲期间溢出
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *UartHandle)
+{
+    if (isATEnable)
+    {
+        atRecvPut(uartIsrBuffer, UartHandle->RxXferSize);
+    }
     HAL_UART_Receive_IT(UartHandle, uartIsrBuffer, sizeof(uartIsrBuffer));
 }
 
@@ -5,8 +5,22 @@
 #include "atCommand.h"
 #include "SHARECom.h"
 #include "wdt.h"
+#include "settings.h"
 #define UART_RECV_BUF_SIZE 128
+#define UART_SEND_BUF_SIZE 160 // 可容纳连续几条AT回复
+#define UART_SEND_CHUNK_SIZE 32 // 每次中断发送的最大字节数
+#define UART_BAUD_DEFAULT 19200
+#define UART_BAUD_CONFIRM_MS 3000                                // 切换后等待确认的时间
+#define AT_LATENCY_HIST_SIZE 8 // 指令延迟直方图桶数
 void atInit(SHARECom *SHARECom);
 void atTask(void);
 void atCtrl(xBool isEnable);
+uint16_t atSendFree(void);
+void atSendFlush(uint32_t timeoutMs);
+void atGetTxStats(uint32_t *queued, uint32_t *dropped, uint32_t *peak);
+xBool atBaudIsValid(uint32_t baud);
+void atBaudSwitch(uint32_t baud);
+void atBaudConfirm(void);
+void atSetTaskId(uint8_t taskId);
+void atGetLatencyHist(uint32_t *hist);
 #endif
\ No newline at end of file
@@ -8,8 +8,19 @@
 #include "SHARECom.h"
 #include "components.h"
 #include "radioConvert.h"
+#include "BK4802.h"
+#include "at.h"
+#include "binProto.h"
+#include "cpuLoad.h"
+#include "radio.h"
+#include "channel.h"
+#include "scan.h"
+#include "dualWatch.h"
 #include <stdint.h>
 #include <math.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 
 #undef LOG_TAG
 #define LOG_TAG "AT"
@@ -17,10 +28,8 @@
 #define AT_CMD_BUF_LEN (256)            // min required buffer length
 
 // Command Basic Define
-#define AT_CMD_HANDLER_PERIOD 10                             // command handler period unit ms
 #define AT_CMD_COMSUME_TIMEOUT 1000                          // command comsume timeout, if the command is not comsumed in this time, the command will be discard unit ms
 #define AT_CMD_RECV_BYTE_MAX 32                              // max byte received once
-#define AT_CMD_SEND_BYTE_MAX 32                              // max byte send once
 #define AT_CMD_MAX_LEN 128                                   // max command length
 #define AT_CMD_MAX_ARG 8                                     // max arguments
 #define AT_CMD_MAX_ARG_LEN (AT_CMD_MAX_LEN / AT_CMD_MAX_ARG) // max argument length
@@ -32,6 +41,10 @@
 #error "AT_CMD_MAX_ARG_LEN must be greater than 8"
 #endif
 
+#if (AT_LATENCY_HIST_SIZE > AT_CMD_MAX_ARG)
+#error "AT_LATENCY_HIST_SIZE must not exceed AT_CMD_MAX_ARG"
+#endif
+
 // AT Command List
 #define AT_CMD_NAME "NAME"
 
@@ -82,6 +95,98 @@
 // bootloader
 #define AT_CMD_BOOTLOAD "BOOTLOAD"
 
+// PLL register cache statistics: hits,misses
+#define AT_CMD_PLLCACHE "PLLCACHE"
+
+// AT link baud rate 19200/115200/230400/460800/921600
+// reply at the old rate, then switch; confirmed by the first valid command at the new rate
+#define AT_CMD_BAUD "BAUD"
+
+// switch channel in one retune: txHz,rxHz,sql(0~10),pwr(0~2),ctcss; validated as a whole
+// ctcss must be 0 (off), BK4802 does not support CTCSS, same as TCTCSS/RCTCSS
+#define AT_CMD_CH "CH"
+#define AT_CMD_CH_ARG_NUM 5
+
+// memory channel store: index,txHz,rxHz,sql,pwr,ctcss(0),name(max CHANNEL_NAME_LEN chars)
+// the PLL registers are computed with the current FREQTUNE; query returns the used slot bitmask
+#define AT_CMD_CHMEM "CHMEM"
+#define AT_CMD_CHMEM_ARG_NUM 7
+
+// memory channel recall by index; query returns index,name (CHANNEL_NONE if none recalled)
+#define AT_CMD_CHSEL "CHSEL"
+
+// scanner: mode(0 off,1 memory channels,2 range),hold(1: stop on activity),startHz,stopHz,stepHz
+// query: mode,hold,channels,holding,sweeps,channels/s,holdHz
+// results are unsolicited: "+SCAN:H,index,Hz,rssi,snr" per hit, "+SCAN:W,channels,channels/s" per sweep
+#define AT_CMD_SCAN "SCAN"
+#define AT_CMD_SCAN_ARG_NUM 5
+// per band PLL settle time calibrated by the scanner (us, 0 not calibrated yet)
+#define AT_CMD_SCANCAL "SCANCAL"
+// occupancy per mille of the last scan, AT+SCANOCC=page selects channels page*8..page*8+7
+#define AT_CMD_SCANOCC "SCANOCC"
+#define AT_CMD_SCANOCC_PAGE (SCAN_MAX_CHANNELS / AT_CMD_MAX_ARG)
+
+// dual watch: periodMs(0 off, WATCH_MIN_PERIOD_MS~WATCH_MAX_PERIOD_MS),priorityHz
+// query: periodMs,priorityHz,state(0 main,1 hop,2 on priority),hops,switches,blind(0.01% of main time),last hop us
+#define AT_CMD_DUALW "DUALW"
+#if (BK4802_BAND_NUM > AT_CMD_MAX_ARG)
+#error "BK4802_BAND_NUM must not exceed AT_CMD_MAX_ARG"
+#endif
+
+// telemetry subscription: period ms (0 off, 50~60000), delta (1: only push when changed)
+// records are unsolicited: "+STREAM:rssi,snr,smeter,sql,ptt,ifgain,afc,err" or a BIN_OP_TELEMETRY frame
+#define AT_CMD_STREAM "STREAM"
+#define AT_CMD_STREAM_MIN_PERIOD 50
+#define AT_CMD_STREAM_MAX_PERIOD 60000
+#define AT_CMD_STREAM_DEADBAND 3    // delta模式下RSSI/SNR/AFC的变化阈值,避免噪声抖动触发推送
+#define AT_CMD_STREAM_RECORD_MAX 48 // 单条记录最大字节数,发送缓冲不足时跳过本次推送
+
+// squelch/PTT edge events, query: latest events as <type><state>@<micros>, e.g. S1@12345678
+// set ON/OFF: push each new event unsolicited as "+EVENT:S1@12345678"
+#define AT_CMD_EVENTS "EVENTS"
+#define AT_CMD_EVENTS_LIST_0 "OFF"
+#define AT_CMD_EVENTS_LIST_1 "ON"
+#if (SHARE_EVENT_RING_SIZE > AT_CMD_MAX_ARG)
+#error "SHARE_EVENT_RING_SIZE must not exceed AT_CMD_MAX_ARG"
+#endif
+
+// scheduler task profile, AT+PROF=<task>,<view> selects, AT+PROF? reports the selected task
+// view 0: runs,min,avg,max(us),backlog,overruns,deadline misses; view 1: execution time histogram, see Sch51.h
+#define AT_CMD_PROF "PROF"
+#define AT_CMD_PROF_VIEW_SUMMARY 0
+#define AT_CMD_PROF_VIEW_HIST 1
+#if (SCH_PROF_HIST_SIZE > AT_CMD_MAX_ARG)
+#error "SCH_PROF_HIST_SIZE must not exceed AT_CMD_MAX_ARG"
+#endif
+
+// scheduler sleep statistics since boot: wakes from sleep,time asleep ms,idle percent
+#define AT_CMD_IDLE "IDLE"
+
+// CPU load: load 1s,load 10s (0.1%),longest busy stretch in 10s (us),
+// USART2/TIM16/SysTick ISR time in the last second (us),longest single ISR (us)
+#define AT_CMD_LOAD "LOAD"
+
+// TX/RX switchover timing, set: antenna settle ms,TRX pin settle ms,power ramp step ms (0 off)
+// query adds PTT edge to TRX pin: last us,max us; PTT edge to TX registers loaded: last us,max us
+#define AT_CMD_TRX "TRX"
+#define AT_CMD_TRX_ARG_NUM 3
+#define AT_CMD_TRX_ANT_MAX 500
+#define AT_CMD_TRX_PIN_MAX 200
+#define AT_CMD_TRX_RAMP_MAX 100
+
+// pending settings queue between AT and syncTask: peak depth,dropped
+#define AT_CMD_CMDQ "CMDQ"
+
+// command latency histogram, line end to reply queued, log2(ms) buckets: <1,1,2~3,4~7,...,>=64
+#define AT_CMD_LATENCY "LATENCY"
+
+// UART transmit statistics: queued,dropped,peak bytes
+#define AT_CMD_UARTTX "UARTTX"
+
+// switch to binary frame mode, see binProto.h; back to text by EXIT frame or idle timeout
+#define AT_CMD_BINARY "BINARY"
+#define AT_CMD_BINARY_IDLE_TIMEOUT 30000 // ms without a valid frame
+
 // report command
 #define AT_CMD_OK "OK"
 
@@ -138,9 +243,11 @@ typedef struct
     } raw;
 } ATCmdArg;
 
+typedef struct ATCmdEntry ATCmdEntry;
 typedef struct
 {
     ATCmd cmd;                     // command
+    const ATCmdEntry *entry;       // command table entry, NULL for AT? and invalid command
     ATCmdResult result;            // result
     ATCmdType type;                // set or get
     uint8_t argNum;                // argument number
@@ -151,7 +258,8 @@ static char atFeatureRing[AT_CMD_FEATURE_BUFFERING_MAX * sizeof(ATCmd) + 2]; //
 static char atCmdRing[AT_CMD_BUF_LEN + 2];                                   // extra 2 bytes for the ring buffer
 static char atCmdProcRaw[AT_CMD_BUF_LEN];
 static uint32_t atCmdComsumeTimeout = 0;
-static uint32_t atCmdPeriond = 0;
+static uint32_t atFeaturePeak = 0;    // 待同步指令队列深度最高水位
+static uint32_t atFeatureDropped = 0; // 队列满丢弃的指令数
 static ATCmdArgs recvCmdArgs; // received command arguments
 static ATCmdPort ctrl =
     {
@@ -160,6 +268,7 @@ static ATCmdPort ctrl =
 };
 static xRingBuf_t serialRingHandler;
 static xRingBuf_t featureCmdRingHandler;
+static void ATCmdTableCheck(void);
 void ATCmdInit(const ATCmdPort *port)
 {
     if (port == NULL)
@@ -170,12 +279,31 @@ void ATCmdInit(const ATCmdPort *port)
     ctrl.sendBytes = port->sendBytes;
     xRingBufInit(&serialRingHandler, (unsigned char *)atCmdRing, sizeof(atCmdRing));
     xRingBufInit(&featureCmdRingHandler, (unsigned char *)atFeatureRing, sizeof(atFeatureRing));
+    ATCmdTableCheck();
 }
 
 void fetchPut(ATCmd cmd)
 {
+    uint32_t depth;
     log_d("fetchPut:%d", cmd);
+    if (xRingBufFree(&featureCmdRingHandler) < sizeof(ATCmd))
+    {
+        atFeatureDropped++; // 放不下完整的一条,避免写入半条导致后续错位
+        log_w("feature queue full, drop cmd:%d", cmd);
+        return;
+    }
     xRingBufPut(&featureCmdRingHandler, (uint8_t *)&cmd, sizeof(ATCmd));
+    depth = xRingBufLen(&featureCmdRingHandler) / sizeof(ATCmd);
+    if (depth > atFeaturePeak)
+    {
+        atFeaturePeak = depth;
+    }
+}
+
+void ATCmdGetQueueStats(uint32_t *peak, uint32_t *dropped)
+{
+    *peak = atFeaturePeak;
+    *dropped = atFeatureDropped;
 }
 ATCmd fetchGet(void)
 {
@@ -199,1170 +327,1070 @@ ATCmd fetchGet(void)
     return cmd;
 }
 
-// will parse command as outArgs not related to the SHARECom
-xBool ATCmdParse(ATCmdArgs *outArgs)
+// SHARECom中绑定字段的类型
+typedef enum
 {
-    // step1 find "AT"
-    uint16_t startIdx = 0;
-    memset(outArgs, 0, sizeof(ATCmdArgs));
-    if (xStringStartIdxFinder(atCmdProcRaw, "AT", &startIdx) == xFalse)
+    E_AT_FIELD_NONE,
+    E_AT_FIELD_U8,
+    E_AT_FIELD_U16,
+    E_AT_FIELD_U32,
+    E_AT_FIELD_I32,
+    E_AT_FIELD_FLOAT,
+} ATCmdFieldType;
+
+#define AT_CMD_FLAG_GET 0x01    // 支持 AT+XX?
+#define AT_CMD_FLAG_SET 0x02    // 支持 AT+XX=
+#define AT_CMD_FLAG_ACTION 0x04 // 无参数动作,不区分?和=,如 AT+BOOTLOAD
+#define AT_CMD_FLAG_LOCAL 0x08  // 在AT模块内处理,不通知syncTask
+#define AT_CMD_FLAG_FREQ 0x10   // 直接修改频率,COM不再对应已调出的存储信道,清除chSel
+
+#define AT_CMD_FIELD(type, member) (type), (uint8_t)offsetof(SHARECom, member)
+#define AT_CMD_NO_FIELD E_AT_FIELD_NONE, 0
+
+typedef xBool (*ATCmdArgCheck)(ATCmdArg *arg);            // SET参数额外检查,可规整参数
+typedef void (*ATCmdGetter)(ATCmdArgs *args, SHARECom *base); // 自定义GET,替代字段绑定
+typedef void (*ATCmdSetter)(ATCmdArgs *args, SHARECom *base); // 自定义SET,替代字段绑定
+typedef xBool (*ATCmdArgsCheck)(ATCmdArgs *args, uint8_t given); // 多参数之间的联合检查,given为实际给出的参数个数
+
+// 多参数SET中单个参数的描述
+typedef struct
+{
+    ATCmdArgType argType; // UINT/INT/FLOAT/HEX/STRING
+    int32_t min;          // INT/UINT参数范围,STRING为长度范围
+    int32_t max;
+    ATCmdArgCheck check;  // 额外检查,可规整参数
+} ATCmdArgSpec;
+
+// 多参数SET的参数列表,按逗号分隔,未给出的可选参数补0
+typedef struct
+{
+    const ATCmdArgSpec *spec;
+    uint8_t num;          // 参数个数
+    uint8_t minNum;       // 至少给出的参数个数
+    ATCmdArgsCheck check; // 联合检查
+} ATCmdArgList;
+
+// 命令描述表项
+struct ATCmdEntry
+{
+    const char *name;             // 命令名,表按字典序排列
+    ATCmd cmd;                    // 命令
+    uint8_t flags;                // AT_CMD_FLAG_xx
+    ATCmdArgType argType;         // 参数类型,GET返回和SET解析共用
+    uint8_t fieldType;            // 绑定的SHARECom字段类型
+    uint8_t fieldOffset;          // 绑定的SHARECom字段偏移
+    int32_t min;                  // INT/UINT参数范围
+    int32_t max;
+    const char *const *enumList;  // STRING参数可选值,下标即字段值
+    uint8_t enumNum;
+    ATCmdArgCheck check;          // SET参数额外检查
+    ATCmdGetter get;              // 自定义GET
+    const ATCmdArgList *argList;  // 多参数SET描述,NULL时按argType解析单个参数
+    ATCmdSetter set;              // 自定义SET
+    ATCmdResult setResult;        // SET成功时的返回
+};
+
+static const char *const txPwrList[] = {AT_CMD_TXPWR_LIST_0, AT_CMD_TXPWR_LIST_1, AT_CMD_TXPWR_LIST_2}; // 下标对应TX_PWR_xx
+static const char *const rfList[] = {AT_CMD_RF_DISABLE, AT_CMD_RF_ENABLE};                             // 下标对应rfEnable
+static const char *const sysList[] = {AT_CMD_SYS_RESET};
+
+// 整数Hz转为SHARECom中的MHz;float在440MHz处精度约30Hz,BK4802MHzToHz还原到50Hz栅格时不丢失
+static float ATCmdHzToMHz(uint32_t hz)
+{
+    return (float)((double)hz / 1000000.0);
+}
+
+static xBool ATCmdCheckFreq(ATCmdArg *arg)
+{
+    arg->raw.floatValue = _roundFreq4(arg->raw.floatValue);
+    return isVailideHamFreq(arg->raw.floatValue);
+}
+
+static xBool ATCmdCheckBaud(ATCmdArg *arg)
+{
+    return atBaudIsValid(arg->raw.uintValue);
+}
+
+static xBool ATCmdCheckCTCSS(ATCmdArg *arg)
+{
+    return isValideCTCSS(arg->raw.floatValue);
+}
+
+// 多参数命令中的CTCSS: BK4802 不支持,只接受0(关闭)
+static xBool ATCmdCheckNoCTCSS(ATCmdArg *arg)
+{
+    return arg->raw.floatValue == 0.0f ? xTrue : xFalse;
+}
+
+static xBool ATCmdCheckHamHz(ATCmdArg *arg)
+{
+    return isVailideHamFreq(ATCmdHzToMHz(arg->raw.uintValue));
+}
+
+static void ATCmdGetName(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = 1;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
+    xStringnCopy(args->args[0].raw.strValue, NAME, sizeof(NAME));
+}
+
+static void ATCmdGetVer(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = 1;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
+    xStringnCopy(args->args[0].raw.strValue, VERSION, sizeof(VERSION));
+}
+
+static void ATCmdGetUartTx(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = 3;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[1].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[2].argType = E_AT_CMD_ARG_TYPE_UINT;
+    atGetTxStats(&args->args[0].raw.uintValue, &args->args[1].raw.uintValue, &args->args[2].raw.uintValue);
+}
+
+static void ATCmdGetLatency(ATCmdArgs *args, SHARECom *base)
+{
+    uint32_t hist[AT_LATENCY_HIST_SIZE];
+    atGetLatencyHist(hist);
+    args->argNum = AT_LATENCY_HIST_SIZE;
+    for (int i = 0; i < AT_LATENCY_HIST_SIZE; i++)
     {
-        return xFalse;
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
+        args->args[i].raw.uintValue = hist[i];
     }
-    startIdx = startIdx + xStringLen("AT"); // go to content.
-    if (atCmdProcRaw[startIdx] == '?')      // AT?
+}
+
+static void ATCmdGetCmdQueue(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = 2;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[1].argType = E_AT_CMD_ARG_TYPE_UINT;
+    ATCmdGetQueueStats(&args->args[0].raw.uintValue, &args->args[1].raw.uintValue);
+}
+
+static void ATCmdGetPllCache(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = 2;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[1].argType = E_AT_CMD_ARG_TYPE_UINT;
+    BK4802GetPllCacheStats(&args->args[0].raw.uintValue, &args->args[1].raw.uintValue);
+}
+
+static void ATCmdGetChannel(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = AT_CMD_CH_ARG_NUM;
+    for (int i = 0; i < AT_CMD_CH_ARG_NUM - 1; i++)
     {
-        outArgs->cmd = E_AT_CMD_TEST;
-        outArgs->result = E_AT_RESULT_OK;
-        outArgs->type = E_AT_CMD_TYPE_GET;
-        outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_INVALID;
-        outArgs->argNum = 0;
-        log_d("query command");
-        return xTrue;
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
     }
-    else if (atCmdProcRaw[startIdx] == '+') // AT+
-    {
-        startIdx = startIdx + 1; // go to command
-        if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_NAME, xStringLen(AT_CMD_NAME)) == xTrue)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_NAME); // goto cmdType
-            if (atCmdProcRaw[startIdx] == '?')             // query command
-            {
-                outArgs->cmd = E_AT_CMD_NAME;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query name");
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE; // the command not support
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not supprot edit name");
-                return xTrue;
-            }
-        }
-        // version
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_VER, xStringLen(AT_CMD_VER)) == xTrue)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_VER); // goto cmdType
-            if (atCmdProcRaw[startIdx] == '?')            // query command
-            {
-                outArgs->cmd = E_AT_CMD_VER;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query version");
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE; // the command not support
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not supprot edit version");
-                return xTrue;
-            }
-        }
-        // BAND CAP
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_BANDCAP, xStringLen(AT_CMD_BANDCAP)) == xTrue)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_BANDCAP);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_BANDCAP;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query band capability");
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE; // the command not support
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support edit band capability");
-                return xTrue;
-            }
-        }
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_SMETER, xStringLen(AT_CMD_SMETER)) == xTrue)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_SMETER);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_SMETER;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query S meter level");
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE; // the command not support
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support edit S meter level");
-                return xTrue;
-            }
-        }
-        // SQL LEVEL
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_SQL, xStringLen(AT_CMD_SQL)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_SQL);
-            // parse string to uint32
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_SQL;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query SQL");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to uint32
-                if (xStringnToUint32(sepPtr[0], sepLen[0], &outArgs->args[0].raw.uintValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse SQL failed");
-                    return xTrue;
-                }
-
-                // check the value
-                if (outArgs->args[0].raw.uintValue > 10)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SQL value out of range");
-                    return xTrue;
-                }
-
-                log_d("set SQL level:%d", outArgs->args[0].raw.intValue);
-                outArgs->cmd = E_AT_CMD_SQL;
-                outArgs->result = E_AT_RESULT_SUCC;
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[0].raw.uintValue = BK4802MHzToHz(base->txFreq);
+    args->args[1].raw.uintValue = BK4802MHzToHz(base->rxFreq);
+    args->args[2].raw.uintValue = base->sql;
+    args->args[3].raw.uintValue = base->txPwr;
+    args->args[4].argType = E_AT_CMD_ARG_TYPE_FLOAT;
+    args->args[4].raw.floatValue = base->tCTCSS;
+}
 
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE;
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support SQL");
-                return xTrue;
-            }
-        }
-        // TX Freq
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_TXFREQ, xStringLen(AT_CMD_TXFREQ)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_TXFREQ);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_TXFREQ;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query TX freq");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to float
-                if (xStringnToFloat(sepPtr[0], sepLen[0], &outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse TX freq failed");
-                    return xTrue;
-                }
-                // 解析成功后进行四舍五入，避免 146.67999 漂移
-                outArgs->args[0].raw.floatValue = _roundFreq4(outArgs->args[0].raw.floatValue);
-
-                // check the value
-                if (isVailideHamFreq(outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("TX freq value out of range");
-                    return xTrue;
-                }
-
-                log_d("set TX freq:%.4f", outArgs->args[0].raw.floatValue);
-                outArgs->cmd = E_AT_CMD_TXFREQ;
-                outArgs->result = E_AT_RESULT_SUCC;
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
+static void ATCmdSetChannel(ATCmdArgs *args, SHARECom *base)
+{
+    base->txFreq = ATCmdHzToMHz(args->args[0].raw.uintValue);
+    base->rxFreq = ATCmdHzToMHz(args->args[1].raw.uintValue);
+    base->sql = (uint8_t)args->args[2].raw.uintValue;
+    base->txPwr = (uint8_t)args->args[3].raw.uintValue;
+    base->tCTCSS = args->args[4].raw.floatValue;
+    base->rCTCSS = args->args[4].raw.floatValue;
+}
 
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE;
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support TX freq");
-                return xTrue;
-            }
-        }
-        // RX Freq
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_RXFREQ, xStringLen(AT_CMD_RXFREQ)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_RXFREQ);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_RXFREQ;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query RX freq");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to float
-                if (xStringnToFloat(sepPtr[0], sepLen[0], &outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse RX freq failed");
-                    return xTrue;
-                }
-                // 解析成功后进行四舍五入
-                outArgs->args[0].raw.floatValue = _roundFreq4(outArgs->args[0].raw.floatValue);
-                if (isVailideHamFreq(outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("RX freq out of range");
-                    return xTrue;
-                }
-
-                log_d("set RX freq:%.4f", outArgs->args[0].raw.floatValue);
-                outArgs->cmd = E_AT_CMD_RXFREQ;
-                outArgs->result = E_AT_RESULT_SUCC;
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
+// AT+CH=txHz,rxHz,sql,pwr,ctcss 整体校验,任一参数非法则全部不生效
+static const ATCmdArgSpec chArgSpec[AT_CMD_CH_ARG_NUM] = {
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, ATCmdCheckHamHz},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, ATCmdCheckHamHz},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, 10, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, TX_PWR_HIGH, NULL},
+    {E_AT_CMD_ARG_TYPE_FLOAT, 0, 0, ATCmdCheckNoCTCSS},
+};
+static const ATCmdArgList chArgList = {chArgSpec, AT_CMD_CH_ARG_NUM, AT_CMD_CH_ARG_NUM, NULL};
 
-                return xTrue;
-            }
-        }
-        // TXVOL
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_TXVOL, xStringLen(AT_CMD_TXVOL)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_TXVOL);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_TXVOL;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query TX vol");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to uint32
-                if (xStringnToUint32(sepPtr[0], sepLen[0], &outArgs->args[0].raw.uintValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse TX vol failed");
-                    return xTrue;
-                }
-
-                // check the value
-                if (outArgs->args[0].raw.uintValue > 10)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("TX vol value out of range");
-                    return xTrue;
-                }
-
-                log_d("set TX vol:%d", outArgs->args[0].raw.intValue);
-                outArgs->cmd = E_AT_CMD_TXVOL;
-                outArgs->result = E_AT_RESULT_SUCC;
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE;
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support TX vol");
-                return xTrue;
-            }
-        }
-        // RXVOL
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_RXVOL, xStringLen(AT_CMD_RXVOL)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_RXVOL);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_RXVOL;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query RX vol");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to uint32
-                if (xStringnToUint32(sepPtr[0], sepLen[0], &outArgs->args[0].raw.uintValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse RX vol failed");
-                    return xTrue;
-                }
-
-                // check the value
-                if (outArgs->args[0].raw.uintValue > 10)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("RX vol value out of range");
-                    return xTrue;
-                }
-
-                log_d("set RX vol:%d", outArgs->args[0].raw.intValue);
-                outArgs->cmd = E_AT_CMD_RXVOL;
-                outArgs->result = E_AT_RESULT_SUCC;
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE;
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support RX vol");
-                return xTrue;
-            }
-        }
-        // TCTCSS
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_TCTCSS, xStringLen(AT_CMD_TCTCSS)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_TCTCSS);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_TCTCSS;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query TX ctcss");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to uint32
-                if (xStringnToFloat(sepPtr[0], sepLen[0], &outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse TX ctcss failed");
-                    return xTrue;
-                }
-
-                // check the value
-                if (isValideCTCSS(outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("TX ctcss value out of range");
-                    return xTrue;
-                }
-
-                log_d("set TX ctcss:%d", outArgs->args[0].raw.floatValue);
-                outArgs->cmd = E_AT_CMD_TCTCSS;
-                outArgs->result = E_AT_RESULT_FAIL; // BK4802 不支持CTCSS功能
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE;
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support TX ctcss");
-                return xTrue;
-            }
-        }
-        // RCTCSS
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_RCTCSS, xStringLen(AT_CMD_RCTCSS)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_RCTCSS);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_RCTCSS;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query RX ctcss");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to uint32
-                if (xStringnToFloat(sepPtr[0], sepLen[0], &outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse RX ctcss failed");
-                    return xTrue;
-                }
-
-                // check the value
-                if (isValideCTCSS(outArgs->args[0].raw.floatValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("RX ctcss value out of range");
-                    return xTrue;
-                }
-
-                log_d("set RX ctcss:%d", outArgs->args[0].raw.floatValue);
-                outArgs->cmd = E_AT_CMD_RCTCSS;
-                outArgs->result = E_AT_RESULT_FAIL; // BK4802 不支持CTCSS功能
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
-                return xTrue;
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE;
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("not support RX ctcss");
-                return xTrue;
-            }
-        }
-        // E_AT_CMD_TXPWR
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_TXPWR, xStringLen(AT_CMD_TXPWR)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_TXPWR);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_TXPWR;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query TX power");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_TXPWR_LIST_0, xStringLen(AT_CMD_TXPWR_LIST_0)) == true)
-                {
-                    outArgs->cmd = E_AT_CMD_TXPWR;
-                    outArgs->result = E_AT_RESULT_SUCC;
-                    outArgs->type = E_AT_CMD_TYPE_SET;
-                    outArgs->argNum = 1;
-                    outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-                    xStringnCopy(outArgs->args[0].raw.strValue, AT_CMD_TXPWR_LIST_0, xStringLen(AT_CMD_TXPWR_LIST_0));
-                    log_d("set TX power LOW");
-                    return xTrue;
-                }
-                else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_TXPWR_LIST_1, xStringLen(AT_CMD_TXPWR_LIST_1)) == true)
-                {
-                    outArgs->cmd = E_AT_CMD_TXPWR;
-                    outArgs->result = E_AT_RESULT_SUCC;
-                    outArgs->type = E_AT_CMD_TYPE_SET;
-                    outArgs->argNum = 1;
-                    outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-                    xStringnCopy(outArgs->args[0].raw.strValue, AT_CMD_TXPWR_LIST_1, xStringLen(AT_CMD_TXPWR_LIST_1));
-                    log_d("set TX power MID");
-                    return xTrue;
-                }
-                else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_TXPWR_LIST_2, xStringLen(AT_CMD_TXPWR_LIST_2)) == true)
-                {
-                    outArgs->cmd = E_AT_CMD_TXPWR;
-                    outArgs->result = E_AT_RESULT_SUCC;
-                    outArgs->type = E_AT_CMD_TYPE_SET;
-                    outArgs->argNum = 1;
-                    outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-                    xStringnCopy(outArgs->args[0].raw.strValue, AT_CMD_TXPWR_LIST_2, xStringLen(AT_CMD_TXPWR_LIST_2));
-                    log_d("set TX power HIGH");
-                    return xTrue;
-                }
-                else
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_INVALID;
-                    log_w("not support TX power");
-                    return xTrue;
-                }
-            }
-        }
-        // E_AT_FREQ_TUNE
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_FREQTUNE, xStringLen(AT_CMD_FREQTUNE)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_FREQTUNE);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_FREQTUNE;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query freq tune");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                char *sepPtr[AT_CMD_MAX_ARG];
-                uint16_t sepLen[AT_CMD_MAX_ARG];
-                int acturalSepNum = 0;
-
-                for (int dd = 0; dd < AT_CMD_MAX_ARG; dd++)
-                {
-                    sepPtr[dd] = NULL;
-                    sepLen[dd] = 0;
-                }
-
-                if (xStringSeprateWithLen(atCmdProcRaw + startIdx, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepFailed");
-                    return xTrue;
-                }
-
-                log_d("sepNum:%d", acturalSepNum);
-                if (acturalSepNum != 1)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("SepNumError");
-                    return xTrue;
-                }
-
-                // parse the string to int32 (Hz 频偏)
-                if (xStringnToInt32(sepPtr[0], sepLen[0], &outArgs->args[0].raw.intValue) == xFalse)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("parse freq tune failed");
-                    return xTrue;
-                }
-
-                // 简单限制范围 ±50000 Hz
-                if (outArgs->args[0].raw.intValue > 50000 || outArgs->args[0].raw.intValue < -50000)
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_FAIL;
-                    log_w("freq tune out of range ±50000 Hz");
-                    return xTrue;
-                }
-
-                log_d("set freq tune(offset Hz):%d", outArgs->args[0].raw.intValue);
-                outArgs->cmd = E_AT_CMD_FREQTUNE;
-                outArgs->result = E_AT_RESULT_SUCC;
-                outArgs->type = E_AT_CMD_TYPE_SET;
-                outArgs->argNum = 1;
-                outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_INT;
-                return xTrue;
-            }
-        }
-        // RF Enable/Disable
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_RF, xStringLen(AT_CMD_RF)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_RF);
-            if (atCmdProcRaw[startIdx] == '?')
-            {
-                outArgs->cmd = E_AT_CMD_RF;
-                outArgs->result = E_AT_RESULT_OK;
-                outArgs->type = E_AT_CMD_TYPE_GET;
-                log_d("query RF enable state");
-                return xTrue;
-            }
-            else if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_RF_ENABLE, xStringLen(AT_CMD_RF_ENABLE)) == true)
-                {
-                    outArgs->cmd = E_AT_CMD_RF;
-                    outArgs->result = E_AT_RESULT_SUCC;
-                    outArgs->type = E_AT_CMD_TYPE_SET;
-                    outArgs->argNum = 1;
-                    outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-                    xStringnCopy(outArgs->args[0].raw.strValue, AT_CMD_RF_ENABLE, xStringLen(AT_CMD_RF_ENABLE));
-                    log_d("set RF ENABLE");
-                    return xTrue;
-                }
-                else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_RF_DISABLE, xStringLen(AT_CMD_RF_DISABLE)) == true)
-                {
-                    outArgs->cmd = E_AT_CMD_RF;
-                    outArgs->result = E_AT_RESULT_SUCC;
-                    outArgs->type = E_AT_CMD_TYPE_SET;
-                    outArgs->argNum = 1;
-                    outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-                    xStringnCopy(outArgs->args[0].raw.strValue, AT_CMD_RF_DISABLE, xStringLen(AT_CMD_RF_DISABLE));
-                    log_d("set RF DISABLE");
-                    return xTrue;
-                }
-                else
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_INVALID;
-                    log_w("not support RF state");
-                    return xTrue;
-                }
-            }
-        }
-        // System Command (only RESET)
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_SYS, xStringLen(AT_CMD_SYS)) == true)
-        {
-            startIdx = startIdx + xStringLen(AT_CMD_SYS);
-            if (atCmdProcRaw[startIdx] == '=')
-            {
-                startIdx = startIdx + 1;
-                if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_SYS_RESET, xStringLen(AT_CMD_SYS_RESET)) == true)
-                {
-                    outArgs->cmd = E_AT_CMD_SYS;
-                    outArgs->result = E_AT_RESULT_SUCC; // 立即返回 SUCCESS，实际复位延迟执行
-                    outArgs->type = E_AT_CMD_TYPE_SET;
-                    outArgs->argNum = 1;
-                    outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-                    xStringnCopy(outArgs->args[0].raw.strValue, AT_CMD_SYS_RESET, xStringLen(AT_CMD_SYS_RESET));
-                    log_d("system reset requested");
-                    return xTrue;
-                }
-                else
-                {
-                    outArgs->cmd = E_AT_CMD_NONE;
-                    outArgs->result = E_AT_RESULT_INVALID;
-                    log_w("not support SYS op");
-                    return xTrue;
-                }
-            }
-            else
-            {
-                outArgs->cmd = E_AT_CMD_NONE;
-                outArgs->result = E_AT_RESULT_INVALID;
-                log_w("SYS only support set RESET");
-                return xTrue;
-            }
-        }
-	//E_AT_CMD_BOOTLOAD
-        else if (xStringnCompare(&atCmdProcRaw[startIdx], AT_CMD_BOOTLOAD, xStringLen(AT_CMD_BOOTLOAD)) == true)
-        {
-            outArgs->cmd = E_AT_CMD_BOOTLOAD;
-            outArgs->result = E_AT_RESULT_OK;
-            outArgs->type = E_AT_CMD_TYPE_SET;
-            outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_INVALID;
-            outArgs->argNum = 0;
-            log_d("enter bootloader");
-            return xTrue;
-        }
-        // INVALID
-        else
-        {
-            outArgs->cmd = E_AT_CMD_NONE;
-            outArgs->result = E_AT_RESULT_INVALID;
-            log_w("not support command");
-            return xTrue;
-        }
+static void ATCmdGetChMem(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = 1;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_HEX;
+    args->args[0].raw.uintValue = channelUsedMask();
+}
+
+static void ATCmdSetChMem(ATCmdArgs *args, SHARECom *base)
+{
+    ChannelEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.txHz = args->args[1].raw.uintValue;
+    entry.rxHz = args->args[2].raw.uintValue;
+    entry.offsetHz = base->freqTune;
+    entry.sql = (uint8_t)args->args[3].raw.uintValue;
+    entry.txPwr = (uint8_t)args->args[4].raw.uintValue;
+    entry.tCTCSS = args->args[5].raw.floatValue;
+    entry.rCTCSS = args->args[5].raw.floatValue;
+    memcpy(entry.name, args->args[6].raw.strValue, CHANNEL_NAME_LEN);
+    if (channelSave((uint8_t)args->args[0].raw.uintValue, &entry) == xFalse)
+    {
+        args->result = E_AT_RESULT_FAIL;
     }
-    return xFalse;
 }
 
-// base on COM ,process the command,full fill the result
-xBool ATCmdArgsGetProc(ATCmdArgs *argsToBeProc, SHARECom *base)
+// AT+CHMEM=index,txHz,rxHz,sql,pwr,ctcss,name 校验规则与AT+CH一致
+static const ATCmdArgSpec chMemArgSpec[AT_CMD_CHMEM_ARG_NUM] = {
+    {E_AT_CMD_ARG_TYPE_UINT, 0, CHANNEL_NUM - 1, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, ATCmdCheckHamHz},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, ATCmdCheckHamHz},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, 10, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, TX_PWR_HIGH, NULL},
+    {E_AT_CMD_ARG_TYPE_FLOAT, 0, 0, ATCmdCheckNoCTCSS},
+    {E_AT_CMD_ARG_TYPE_STRING, 1, CHANNEL_NAME_LEN, NULL},
+};
+static const ATCmdArgList chMemArgList = {chMemArgSpec, AT_CMD_CHMEM_ARG_NUM, AT_CMD_CHMEM_ARG_NUM, NULL};
+
+static xBool ATCmdCheckChSel(ATCmdArg *arg)
 {
-    if (argsToBeProc == NULL || base == NULL)
+    return channelGet((uint8_t)arg->raw.uintValue) != NULL ? xTrue : xFalse;
+}
+
+static void ATCmdGetChSel(ATCmdArgs *args, SHARECom *base)
+{
+    const ChannelEntry *ch = channelGet(base->chSel);
+    args->argNum = 2;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[0].raw.uintValue = base->chSel;
+    args->args[1].argType = E_AT_CMD_ARG_TYPE_STRING;
+    memset(args->args[1].raw.strValue, 0, sizeof(args->args[1].raw.strValue));
+    if (ch != NULL)
     {
-        log_e("argsToBeProc or base is NULL");
+        memcpy(args->args[1].raw.strValue, ch->name, CHANNEL_NAME_LEN);
+    }
+}
+
+// 只更新COM,寄存器由syncTask按信道中预先计算的值加载
+static void ATCmdSetChSel(ATCmdArgs *args, SHARECom *base)
+{
+    const ChannelEntry *ch = channelGet((uint8_t)args->args[0].raw.uintValue);
+    base->chSel = (uint8_t)args->args[0].raw.uintValue;
+    base->txFreq = ATCmdHzToMHz(ch->txHz);
+    base->rxFreq = ATCmdHzToMHz(ch->rxHz);
+    base->sql = ch->sql;
+    base->txPwr = ch->txPwr;
+    base->tCTCSS = ch->tCTCSS;
+    base->rCTCSS = ch->rCTCSS;
+}
+
+static void ATCmdGetScan(ATCmdArgs *args, SHARECom *base)
+{
+    ScanStatus status;
+    scanGetStatus(&status);
+    args->argNum = 7;
+    for (int i = 0; i < args->argNum; i++)
+    {
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
+    }
+    args->args[0].raw.uintValue = status.mode;
+    args->args[1].raw.uintValue = status.hold;
+    args->args[2].raw.uintValue = status.num;
+    args->args[3].raw.uintValue = status.holding;
+    args->args[4].raw.uintValue = status.sweeps;
+    args->args[5].raw.uintValue = status.chps;
+    args->args[6].raw.uintValue = status.holdHz;
+}
+
+// 只更新COM,扫描由syncTask启动/停止
+static void ATCmdSetScan(ATCmdArgs *args, SHARECom *base)
+{
+    base->scanMode = (uint8_t)args->args[0].raw.uintValue;
+    base->scanHold = (uint8_t)args->args[1].raw.uintValue;
+    base->scanStartHz = args->args[2].raw.uintValue;
+    base->scanStopHz = args->args[3].raw.uintValue;
+    base->scanStepHz = args->args[4].raw.uintValue;
+}
+
+// AT+SCAN=mode[,hold[,startHz,stopHz,stepHz]] 范围模式必须给出起止频率和步进
+static xBool ATCmdCheckScanArgs(ATCmdArgs *args, uint8_t given)
+{
+    uint32_t mode = args->args[0].raw.uintValue;
+    uint32_t startHz = args->args[2].raw.uintValue;
+    uint32_t stopHz = args->args[3].raw.uintValue;
+    uint32_t stepHz = args->args[4].raw.uintValue;
+    if (given > 2 && given < AT_CMD_SCAN_ARG_NUM)
+    {
+        return xFalse; // 起止频率和步进须同时给出
+    }
+    if (mode == SHARE_SCAN_MODE_LIST && channelUsedMask() == 0)
+    {
+        log_w("no memory channel");
         return xFalse;
     }
-    if (argsToBeProc->type == E_AT_CMD_TYPE_SET)
+    if (mode == SHARE_SCAN_MODE_RANGE &&
+        (given != AT_CMD_SCAN_ARG_NUM || stepHz == 0 || stopHz < startHz ||
+         (stopHz - startHz) / stepHz >= SCAN_MAX_CHANNELS ||
+         isVailideHamFreq(ATCmdHzToMHz(startHz)) == xFalse ||
+         isVailideHamFreq(ATCmdHzToMHz(stopHz)) == xFalse))
     {
-        return xTrue;
+        log_w("scan range invalid");
+        return xFalse;
     }
-    if (argsToBeProc->cmd == E_AT_CMD_NONE)
+    return xTrue;
+}
+
+static const ATCmdArgSpec scanArgSpec[AT_CMD_SCAN_ARG_NUM] = {
+    {E_AT_CMD_ARG_TYPE_UINT, 0, SHARE_SCAN_MODE_RANGE, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, 1, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, NULL},
+};
+static const ATCmdArgList scanArgList = {scanArgSpec, AT_CMD_SCAN_ARG_NUM, 1, ATCmdCheckScanArgs};
+
+static void ATCmdGetScanCal(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = BK4802_BAND_NUM;
+    for (int i = 0; i < args->argNum; i++)
     {
-        return xTrue;
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
+        args->args[i].raw.uintValue = scanGetSettleUs(i);
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TEST)
+}
+
+static uint8_t atScanOccPage = 0;
+
+static void ATCmdGetScanOcc(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = AT_CMD_MAX_ARG;
+    for (int i = 0; i < args->argNum; i++)
     {
-        log_d("get test condition");
-        argsToBeProc->argNum = 0;
-        return xTrue;
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
+        args->args[i].raw.uintValue = scanGetOccupancy(atScanOccPage * AT_CMD_MAX_ARG + i);
+    }
+}
+
+static void ATCmdSetScanOcc(ATCmdArgs *args, SHARECom *base)
+{
+    atScanOccPage = (uint8_t)args->args[0].raw.uintValue;
+}
+
+static void ATCmdGetDualWatch(ATCmdArgs *args, SHARECom *base)
+{
+    WatchStatus status;
+    watchGetStatus(&status);
+    args->argNum = 7;
+    for (int i = 0; i < args->argNum; i++)
+    {
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
+    }
+    args->args[0].raw.uintValue = status.periodMs;
+    args->args[1].raw.uintValue = status.priorityHz;
+    args->args[2].raw.uintValue = status.state;
+    args->args[3].raw.uintValue = status.hops;
+    args->args[4].raw.uintValue = status.switches;
+    args->args[5].raw.uintValue = status.blind;
+    args->args[6].raw.uintValue = status.hopUs;
+}
+
+// 只更新COM,双守候由syncTask启动/停止
+static void ATCmdSetDualWatch(ATCmdArgs *args, SHARECom *base)
+{
+    base->watchPeriodMs = (uint16_t)args->args[0].raw.uintValue;
+    base->watchHz = args->args[1].raw.uintValue;
+}
+
+// AT+DUALW=periodMs,priorityHz 或 AT+DUALW=0 关闭
+static xBool ATCmdCheckDualWatchArgs(ATCmdArgs *args, uint8_t given)
+{
+    uint32_t periodMs = args->args[0].raw.uintValue;
+    if (periodMs == 0)
+    {
+        return xTrue; // 关闭时不检查优先信道
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_NAME)
+    return (given == 2 && periodMs >= WATCH_MIN_PERIOD_MS &&
+            isVailideHamFreq(ATCmdHzToMHz(args->args[1].raw.uintValue)))
+               ? xTrue
+               : xFalse;
+}
+
+static const ATCmdArgSpec dualWatchArgSpec[2] = {
+    {E_AT_CMD_ARG_TYPE_UINT, 0, WATCH_MAX_PERIOD_MS, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, INT32_MAX, NULL},
+};
+static const ATCmdArgList dualWatchArgList = {dualWatchArgSpec, 2, 1, ATCmdCheckDualWatchArgs};
+
+// 扫描结果推送,结果只在扫描运行时产生,无需单独开关
+static ATCmdScanCb atScanSource = NULL;
+static uint32_t atScanSeen = 0; // 已推送的累计结果数
+
+void ATCmdSetScanSource(ATCmdScanCb cb)
+{
+    SHAREScan res;
+    atScanSource = cb;
+    if (atScanSource != NULL)
     {
-        log_d("get name");
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-        xStringnCopy(argsToBeProc->args[0].raw.strValue, NAME, sizeof(NAME));
-        return xTrue;
+        atScanSource(&res, 0, &atScanSeen);
+    }
+}
+
+// 格式化为 H,3,145100000,80,20 或 W,16,120,返回长度
+static uint16_t ATCmdScanToa(char *buf, const SHAREScan *res)
+{
+    uint16_t len = 0;
+    buf[len++] = (char)res->type;
+    buf[len++] = ',';
+    len += xStringUint32Toa(buf + len, res->index);
+    buf[len++] = ',';
+    len += xStringUint32Toa(buf + len, res->value);
+    if (res->type == SHARE_SCAN_HIT)
+    {
+        buf[len++] = ',';
+        len += xStringUint32Toa(buf + len, res->rssi);
+        buf[len++] = ',';
+        len += xStringUint32Toa(buf + len, res->snr);
+    }
+    return len;
+}
+
+// 遥测订阅
+static ATCmdTelemetryCb atTelemetrySource = NULL;
+static uint32_t atStreamPeriod = 0; // ms, 0关闭
+static uint8_t atStreamDelta = 0;
+static uint32_t atStreamStamp = 0;
+static uint8_t atStreamSeq = 0;
+static SHARETelemetry atStreamLast;
+static xBool atStreamLastValid = xFalse;
+
+void ATCmdSetTelemetrySource(ATCmdTelemetryCb cb)
+{
+    atTelemetrySource = cb;
+}
+
+static void ATCmdGetStream(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = 2;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[1].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[0].raw.uintValue = atStreamPeriod;
+    args->args[1].raw.uintValue = atStreamDelta;
+}
+
+static void ATCmdSetStream(ATCmdArgs *args, SHARECom *base)
+{
+    atStreamPeriod = args->args[0].raw.uintValue;
+    atStreamDelta = (uint8_t)args->args[1].raw.uintValue;
+    atStreamStamp = millis() - atStreamPeriod; // 下一次轮询立即推送一条
+    atStreamLastValid = xFalse;
+}
+
+// AT+STREAM=period,delta
+static xBool ATCmdCheckStreamPeriod(ATCmdArg *arg)
+{
+    return (arg->raw.uintValue == 0 || arg->raw.uintValue >= AT_CMD_STREAM_MIN_PERIOD) ? xTrue : xFalse;
+}
+
+static const ATCmdArgSpec streamArgSpec[2] = {
+    {E_AT_CMD_ARG_TYPE_UINT, 0, AT_CMD_STREAM_MAX_PERIOD, ATCmdCheckStreamPeriod},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, 1, NULL},
+};
+static const ATCmdArgList streamArgList = {streamArgSpec, 2, 2, NULL};
+
+static void ATCmdGetIdle(ATCmdArgs *args, SHARECom *base)
+{
+    uint32_t now = millis();
+    args->argNum = 3;
+    args->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[1].argType = E_AT_CMD_ARG_TYPE_UINT;
+    args->args[2].argType = E_AT_CMD_ARG_TYPE_UINT;
+    SCH_Get_Idle_Stats(&args->args[0].raw.uintValue, &args->args[1].raw.uintValue);
+    args->args[2].raw.uintValue = now ? (uint32_t)((uint64_t)args->args[1].raw.uintValue * 100 / now) : 0;
+}
+
+static void ATCmdGetLoad(ATCmdArgs *args, SHARECom *base)
+{
+    CpuLoadStats stats;
+    cpuLoadGet(&stats);
+    args->argNum = 7;
+    args->args[0].raw.uintValue = stats.load1s;
+    args->args[1].raw.uintValue = stats.load10s;
+    args->args[2].raw.uintValue = stats.busyMaxUs;
+    args->args[3].raw.uintValue = stats.isrUs[E_CPU_LOAD_ISR_USART2];
+    args->args[4].raw.uintValue = stats.isrUs[E_CPU_LOAD_ISR_TIM16];
+    args->args[5].raw.uintValue = stats.isrUs[E_CPU_LOAD_ISR_SYSTICK];
+    args->args[6].raw.uintValue = stats.isrMaxUs;
+    for (int i = 0; i < args->argNum; i++)
+    {
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_VER)
+}
+
+static void ATCmdGetTrx(ATCmdArgs *args, SHARECom *base)
+{
+    args->argNum = AT_CMD_TRX_ARG_NUM + 4;
+    for (int i = 0; i < args->argNum; i++)
     {
-        log_d("get version");
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-        xStringnCopy(argsToBeProc->args[0].raw.strValue, VERSION, sizeof(VERSION));
-        return xTrue;
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_BANDCAP)
+    args->args[0].raw.uintValue = base->trxAntMs;
+    args->args[1].raw.uintValue = base->trxPinMs;
+    args->args[2].raw.uintValue = base->trxRampMs;
+    radioGetTrxLatency(&args->args[3].raw.uintValue, &args->args[4].raw.uintValue,
+                       &args->args[5].raw.uintValue, &args->args[6].raw.uintValue);
+}
+
+static void ATCmdSetTrx(ATCmdArgs *args, SHARECom *base)
+{
+    base->trxAntMs = (uint16_t)args->args[0].raw.uintValue;
+    base->trxPinMs = (uint16_t)args->args[1].raw.uintValue;
+    base->trxRampMs = (uint16_t)args->args[2].raw.uintValue;
+}
+
+// AT+TRX=ant,pin,ramp
+static const ATCmdArgSpec trxArgSpec[AT_CMD_TRX_ARG_NUM] = {
+    {E_AT_CMD_ARG_TYPE_UINT, 0, AT_CMD_TRX_ANT_MAX, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, AT_CMD_TRX_PIN_MAX, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, AT_CMD_TRX_RAMP_MAX, NULL},
+};
+static const ATCmdArgList trxArgList = {trxArgSpec, AT_CMD_TRX_ARG_NUM, AT_CMD_TRX_ARG_NUM, NULL};
+
+// 任务执行时间统计
+static uint8_t atProfTask = 0;
+static uint8_t atProfView = AT_CMD_PROF_VIEW_SUMMARY;
+
+static void ATCmdGetProf(ATCmdArgs *args, SHARECom *base)
+{
+    sTaskStats stats;
+    if (SCH_Get_Task_Stats(atProfTask, &stats) != RETURN_NORMAL)
     {
-        log_d("get band capability");
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_HEX;
-        argsToBeProc->args[0].raw.uintValue = base->bandCap;
-        return xTrue;
+        memset(&stats, 0, sizeof(stats)); // 空位,全部报0
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_SMETER)
+    if (atProfView == AT_CMD_PROF_VIEW_HIST)
     {
-        log_d("get S meter level");
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
-        argsToBeProc->args[0].raw.uintValue = base->smeter;
-        return xTrue;
+        args->argNum = SCH_PROF_HIST_SIZE;
+        for (int i = 0; i < SCH_PROF_HIST_SIZE; i++)
+        {
+            args->args[i].raw.uintValue = stats.Hist[i];
+        }
+    }
+    else
+    {
+        args->argNum = 7;
+        args->args[0].raw.uintValue = stats.Runs;
+        args->args[1].raw.uintValue = stats.Bcet_us;
+        args->args[2].raw.uintValue = SCH_Task_Avg_us(&stats);
+        args->args[3].raw.uintValue = stats.Wcet_us;
+        args->args[4].raw.uintValue = stats.Backlog;
+        args->args[5].raw.uintValue = stats.Overruns;
+        args->args[6].raw.uintValue = stats.Deadline_misses;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_SQL)
+    for (int i = 0; i < args->argNum; i++)
     {
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_UINT;
+    }
+}
 
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
-        argsToBeProc->args[0].raw.uintValue = base->sql;
-        log_d("get SQL level is %d", base->sql);
-        return xTrue;
+static void ATCmdSetProf(ATCmdArgs *args, SHARECom *base)
+{
+    atProfTask = (uint8_t)args->args[0].raw.uintValue;
+    atProfView = (uint8_t)args->args[1].raw.uintValue;
+}
+
+// AT+PROF=task,view
+static const ATCmdArgSpec profArgSpec[2] = {
+    {E_AT_CMD_ARG_TYPE_UINT, 0, SCH_MAX_TASKS - 1, NULL},
+    {E_AT_CMD_ARG_TYPE_UINT, 0, AT_CMD_PROF_VIEW_HIST, NULL},
+};
+static const ATCmdArgList profArgList = {profArgSpec, 2, 2, NULL};
+
+// 静噪/PTT事件
+static ATCmdEventCb atEventSource = NULL;
+static xBool atEventPush = xFalse;
+static uint32_t atEventSeen = 0; // 已推送的累计事件数
+
+static const char *const eventsList[] = {AT_CMD_EVENTS_LIST_0, AT_CMD_EVENTS_LIST_1};
+
+void ATCmdSetEventSource(ATCmdEventCb cb)
+{
+    atEventSource = cb;
+}
+
+// 格式化为 S1@12345678,返回长度
+static uint16_t ATCmdEventToa(char *buf, const SHAREEvent *evt)
+{
+    buf[0] = (char)evt->type;
+    buf[1] = evt->state ? '1' : '0';
+    buf[2] = '@';
+    return 3 + xStringUint32Toa(buf + 3, evt->us);
+}
+
+static void ATCmdGetEvents(ATCmdArgs *args, SHARECom *base)
+{
+    SHAREEvent evt[SHARE_EVENT_RING_SIZE];
+    uint32_t total = 0;
+    args->argNum = atEventSource != NULL ? atEventSource(evt, SHARE_EVENT_RING_SIZE, &total) : 0;
+    for (int i = 0; i < args->argNum; i++)
+    {
+        args->args[i].argType = E_AT_CMD_ARG_TYPE_STRING;
+        memset(args->args[i].raw.strValue, 0, sizeof(args->args[i].raw.strValue));
+        ATCmdEventToa(args->args[i].raw.strValue, &evt[i]);
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TXFREQ)
+}
+
+static void ATCmdSetEvents(ATCmdArgs *args, SHARECom *base)
+{
+    SHAREEvent evt;
+    atEventPush = args->args[0].raw.uintValue ? xTrue : xFalse;
+    if (atEventSource != NULL)
     {
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
-        argsToBeProc->args[0].raw.floatValue = base->txFreq;
-        log_d("get TX freq is %.4f", base->txFreq);
-        return xTrue;
+        atEventSource(&evt, 0, &atEventSeen); // 只推送开启之后的新事件
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RXFREQ)
+}
+
+// 命令表,必须按名称字典序排列(二分查找),新增命令只需在此添加一行
+static const ATCmdEntry atCmdTable[] =
+    {
+        {AT_CMD_BANDCAP, E_AT_CMD_BANDCAP, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_HEX, AT_CMD_FIELD(E_AT_FIELD_U16, bandCap), 0, 0, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_BAUD, E_AT_CMD_BAUD, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_FIELD(E_AT_FIELD_U32, baud), 19200, 921600, NULL, 0, ATCmdCheckBaud, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_BINARY, E_AT_CMD_BINARY, AT_CMD_FLAG_ACTION | AT_CMD_FLAG_LOCAL, E_AT_CMD_ARG_TYPE_INVALID, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_OK},
+        {AT_CMD_BOOTLOAD, E_AT_CMD_BOOTLOAD, AT_CMD_FLAG_ACTION, E_AT_CMD_ARG_TYPE_INVALID, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_OK},
+        {AT_CMD_CH, E_AT_CMD_CH, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_FREQ, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetChannel, &chArgList, ATCmdSetChannel, E_AT_RESULT_SUCC},
+        {AT_CMD_CHMEM, E_AT_CMD_CHMEM, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_LOCAL, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetChMem, &chMemArgList, ATCmdSetChMem, E_AT_RESULT_SUCC},
+        {AT_CMD_CHSEL, E_AT_CMD_CHSEL, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, CHANNEL_NUM - 1, NULL, 0, ATCmdCheckChSel, ATCmdGetChSel, NULL, ATCmdSetChSel, E_AT_RESULT_SUCC},
+        {AT_CMD_CMDQ, E_AT_CMD_CMDQ, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetCmdQueue, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_DUALW, E_AT_CMD_DUALW, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetDualWatch, &dualWatchArgList, ATCmdSetDualWatch, E_AT_RESULT_SUCC},
+        {AT_CMD_EVENTS, E_AT_CMD_EVENTS, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_LOCAL, E_AT_CMD_ARG_TYPE_STRING, AT_CMD_NO_FIELD, 0, 0, eventsList, 2, NULL, ATCmdGetEvents, NULL, ATCmdSetEvents, E_AT_RESULT_SUCC},
+        {AT_CMD_FREQTUNE, E_AT_CMD_FREQTUNE, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_INT, AT_CMD_FIELD(E_AT_FIELD_I32, freqTune), -50000, 50000, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_IDLE, E_AT_CMD_IDLE, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetIdle, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_LATENCY, E_AT_CMD_LATENCY, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetLatency, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_LOAD, E_AT_CMD_LOAD, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetLoad, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_NAME, E_AT_CMD_NAME, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_STRING, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetName, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_PLLCACHE, E_AT_CMD_PLLCACHE, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetPllCache, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_PROF, E_AT_CMD_PROF, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_LOCAL, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetProf, &profArgList, ATCmdSetProf, E_AT_RESULT_SUCC},
+        {AT_CMD_RCTCSS, E_AT_CMD_RCTCSS, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_FLOAT, AT_CMD_FIELD(E_AT_FIELD_FLOAT, rCTCSS), 0, 0, NULL, 0, ATCmdCheckCTCSS, NULL, NULL, NULL, E_AT_RESULT_FAIL}, // BK4802 不支持CTCSS功能
+        {AT_CMD_RF, E_AT_CMD_RF, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_STRING, AT_CMD_FIELD(E_AT_FIELD_U8, rfEnable), 0, 0, rfList, 2, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_RXFREQ, E_AT_CMD_RXFREQ, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_FREQ, E_AT_CMD_ARG_TYPE_FLOAT, AT_CMD_FIELD(E_AT_FIELD_FLOAT, rxFreq), 0, 0, NULL, 0, ATCmdCheckFreq, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_RXVOL, E_AT_CMD_RXVOL, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_FIELD(E_AT_FIELD_U8, rxVol), 0, 10, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_SCAN, E_AT_CMD_SCAN, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetScan, &scanArgList, ATCmdSetScan, E_AT_RESULT_SUCC},
+        {AT_CMD_SCANCAL, E_AT_CMD_SCANCAL, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetScanCal, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_SCANOCC, E_AT_CMD_SCANOCC, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_LOCAL, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, AT_CMD_SCANOCC_PAGE - 1, NULL, 0, NULL, ATCmdGetScanOcc, NULL, ATCmdSetScanOcc, E_AT_RESULT_SUCC},
+        {AT_CMD_SMETER, E_AT_CMD_SMETER, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_FIELD(E_AT_FIELD_U8, smeter), 0, 0, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_SQL, E_AT_CMD_SQL, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_FIELD(E_AT_FIELD_U8, sql), 0, 10, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_STREAM, E_AT_CMD_STREAM, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_LOCAL, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetStream, &streamArgList, ATCmdSetStream, E_AT_RESULT_SUCC},
+        {AT_CMD_SYS, E_AT_CMD_SYS, AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_STRING, AT_CMD_NO_FIELD, 0, 0, sysList, 1, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC}, // 立即返回 SUCCESS，实际复位延迟执行
+        {AT_CMD_TCTCSS, E_AT_CMD_TCTCSS, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_FLOAT, AT_CMD_FIELD(E_AT_FIELD_FLOAT, tCTCSS), 0, 0, NULL, 0, ATCmdCheckCTCSS, NULL, NULL, NULL, E_AT_RESULT_FAIL}, // BK4802 不支持CTCSS功能
+        {AT_CMD_TRX, E_AT_CMD_TRX, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetTrx, &trxArgList, ATCmdSetTrx, E_AT_RESULT_SUCC},
+        {AT_CMD_TXFREQ, E_AT_CMD_TXFREQ, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET | AT_CMD_FLAG_FREQ, E_AT_CMD_ARG_TYPE_FLOAT, AT_CMD_FIELD(E_AT_FIELD_FLOAT, txFreq), 0, 0, NULL, 0, ATCmdCheckFreq, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_TXPWR, E_AT_CMD_TXPWR, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_STRING, AT_CMD_FIELD(E_AT_FIELD_U8, txPwr), 0, 0, txPwrList, 3, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_TXVOL, E_AT_CMD_TXVOL, AT_CMD_FLAG_GET | AT_CMD_FLAG_SET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_FIELD(E_AT_FIELD_U8, txVol), 0, 10, NULL, 0, NULL, NULL, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_UARTTX, E_AT_CMD_UARTTX, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_UINT, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetUartTx, NULL, NULL, E_AT_RESULT_SUCC},
+        {AT_CMD_VER, E_AT_CMD_VER, AT_CMD_FLAG_GET, E_AT_CMD_ARG_TYPE_STRING, AT_CMD_NO_FIELD, 0, 0, NULL, 0, NULL, ATCmdGetVer, NULL, NULL, E_AT_RESULT_SUCC},
+};
+#define AT_CMD_TABLE_SIZE (sizeof(atCmdTable) / sizeof(atCmdTable[0]))
+
+// 比较命令名与输入的token(长度len,不以'\0'结尾),返回值同strcmp
+static int ATCmdTokenCompare(const char *name, const char *token, uint16_t len)
+{
+    int ret = strncmp(name, token, len);
+    if (ret != 0)
     {
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
-        argsToBeProc->args[0].raw.floatValue = base->rxFreq;
-        log_d("get RX freq is %.4f", base->rxFreq);
-        return xTrue;
+        return ret;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RXVOL)
+    return name[len] == '\0' ? 0 : 1; // name更长
+}
+
+static const ATCmdEntry *ATCmdLookup(const char *token, uint16_t len)
+{
+    int lo = 0;
+    int hi = AT_CMD_TABLE_SIZE - 1;
+    while (lo <= hi)
     {
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
-        argsToBeProc->args[0].raw.uintValue = base->rxVol;
-        log_d("get RX vol is %d", base->rxVol);
-        return xTrue;
+        int mid = (lo + hi) / 2;
+        int ret = ATCmdTokenCompare(atCmdTable[mid].name, token, len);
+        if (ret == 0)
+        {
+            return &atCmdTable[mid];
+        }
+        else if (ret < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TXVOL)
+    return NULL;
+}
+
+// 启动时检查命令表顺序,顺序错误时二分查找会漏掉命令
+static void ATCmdTableCheck(void)
+{
+    for (int i = 1; i < AT_CMD_TABLE_SIZE; i++)
     {
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_UINT;
-        argsToBeProc->args[0].raw.uintValue = base->txVol;
-        log_d("get TX vol is %d", base->txVol);
-        return xTrue;
+        if (strcmp(atCmdTable[i - 1].name, atCmdTable[i].name) >= 0)
+        {
+            log_e("cmd table not sorted at %s", atCmdTable[i].name);
+        }
+    }
+}
+
+static xBool ATCmdParseFailed(ATCmdArgs *outArgs, ATCmdResult result, const char *reason)
+{
+    outArgs->cmd = E_AT_CMD_NONE;
+    outArgs->entry = NULL;
+    outArgs->result = result;
+    log_w("%s", reason);
+    return xTrue;
+}
+
+// 按类型转换并检查一个参数,成功返回NULL,失败返回原因
+static const char *ATCmdParseArgValue(ATCmdArg *arg, ATCmdArgType argType, int32_t min, int32_t max, ATCmdArgCheck check, char *str, uint16_t len)
+{
+    xBool parsed = xFalse;
+    xBool inRange = xTrue;
+    arg->argType = argType;
+    switch (argType)
+    {
+    case E_AT_CMD_ARG_TYPE_UINT:
+        parsed = xStringnToUint32(str, len, &arg->raw.uintValue);
+        inRange = (arg->raw.uintValue >= (uint32_t)min && arg->raw.uintValue <= (uint32_t)max);
+        break;
+    case E_AT_CMD_ARG_TYPE_INT:
+        parsed = xStringnToInt32(str, len, &arg->raw.intValue);
+        inRange = (arg->raw.intValue >= min && arg->raw.intValue <= max);
+        break;
+    case E_AT_CMD_ARG_TYPE_FLOAT:
+        parsed = xStringnToFloat(str, len, &arg->raw.floatValue);
+        break;
+    case E_AT_CMD_ARG_TYPE_HEX:
+        parsed = xStringnToHex(str, len, &arg->raw.uintValue);
+        break;
+    case E_AT_CMD_ARG_TYPE_STRING:
+        parsed = xTrue;
+        inRange = ((int32_t)len >= min && (int32_t)len <= max && len < sizeof(arg->raw.strValue));
+        if (inRange)
+        {
+            memset(arg->raw.strValue, 0, sizeof(arg->raw.strValue));
+            memcpy(arg->raw.strValue, str, len);
+        }
+        break;
+    default:
+        break;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TCTCSS)
+    if (parsed == xFalse)
     {
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
-        argsToBeProc->args[0].raw.floatValue = base->tCTCSS;
-        log_d("get TX ctcss is %.1f", base->tCTCSS);
-        return xTrue;
+        return "parse arg failed";
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RCTCSS)
+    if (inRange == xFalse || (check != NULL && check(arg) == xFalse))
     {
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_FLOAT;
-        argsToBeProc->args[0].raw.floatValue = base->rCTCSS;
-        log_d("get RX ctcss is %.1f", base->rCTCSS);
-        return xTrue;
+        return "arg out of range";
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TXPWR)
+    return NULL;
+}
+
+// 按表项描述解析SET参数
+static xBool ATCmdParseSetArg(ATCmdArgs *outArgs, const ATCmdEntry *entry, char *argStr)
+{
+    ATCmdArg *arg = &outArgs->args[0];
+    if (entry->enumList != NULL)
     {
-        log_d("get TX power");
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-        if (base->txPwr == TX_PWR_LOW)
+        // 可选值精确匹配,下标作为参数
+        for (uint8_t i = 0; i < entry->enumNum; i++)
         {
-            log_d("get TX power LOW");
-            xStringnCopy(argsToBeProc->args[0].raw.strValue, AT_CMD_TXPWR_LIST_0, xStringLen(AT_CMD_TXPWR_LIST_0));
+            if (strcmp(argStr, entry->enumList[i]) == 0)
+            {
+                arg->argType = E_AT_CMD_ARG_TYPE_UINT;
+                arg->raw.uintValue = i;
+                outArgs->argNum = 1;
+                return xTrue;
+            }
         }
-        else if (base->txPwr == TX_PWR_MID)
+        ATCmdParseFailed(outArgs, E_AT_RESULT_INVALID, "arg not in list");
+        return xFalse;
+    }
+
+    char *sepPtr[AT_CMD_MAX_ARG] = {NULL};
+    uint16_t sepLen[AT_CMD_MAX_ARG] = {0};
+    int acturalSepNum = 0;
+    if (xStringSeprateWithLen(argStr, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse)
+    {
+        ATCmdParseFailed(outArgs, E_AT_RESULT_FAIL, "SepFailed");
+        return xFalse;
+    }
+    log_d("sepNum:%d", acturalSepNum);
+    if (acturalSepNum != 1)
+    {
+        ATCmdParseFailed(outArgs, E_AT_RESULT_FAIL, "SepNumError");
+        return xFalse;
+    }
+
+    const char *reason = ATCmdParseArgValue(arg, entry->argType, entry->min, entry->max, entry->check, sepPtr[0], sepLen[0]);
+    if (reason != NULL)
+    {
+        ATCmdParseFailed(outArgs, E_AT_RESULT_FAIL, reason);
+        return xFalse;
+    }
+    outArgs->argNum = 1;
+    return xTrue;
+}
+
+// 按参数列表解析多参数SET,任一参数非法则全部不生效
+static xBool ATCmdParseArgList(ATCmdArgs *outArgs, const ATCmdArgList *list, char *argStr)
+{
+    char *sepPtr[AT_CMD_MAX_ARG] = {NULL};
+    uint16_t sepLen[AT_CMD_MAX_ARG] = {0};
+    int acturalSepNum = 0;
+    if (xStringSeprateWithLen(argStr, sepPtr, sepLen, AT_CMD_MAX_ARG, ",", &acturalSepNum) == xFalse ||
+        acturalSepNum < list->minNum || acturalSepNum > list->num)
+    {
+        ATCmdParseFailed(outArgs, E_AT_RESULT_FAIL, "SepNumError");
+        return xFalse;
+    }
+    for (int i = 0; i < list->num; i++)
+    {
+        const ATCmdArgSpec *spec = &list->spec[i];
+        ATCmdArg *arg = &outArgs->args[i];
+        if (i >= acturalSepNum)
         {
-            log_d("get TX power MID");
-            xStringnCopy(argsToBeProc->args[0].raw.strValue, AT_CMD_TXPWR_LIST_1, xStringLen(AT_CMD_TXPWR_LIST_1));
+            arg->argType = spec->argType;
+            arg->raw.uintValue = 0;
+            continue;
         }
-        else if (base->txPwr == TX_PWR_HIGH)
+        const char *reason = ATCmdParseArgValue(arg, spec->argType, spec->min, spec->max, spec->check, sepPtr[i], sepLen[i]);
+        if (reason != NULL)
         {
-            log_d("get TX power HIGH");
-            xStringnCopy(argsToBeProc->args[0].raw.strValue, AT_CMD_TXPWR_LIST_2, xStringLen(AT_CMD_TXPWR_LIST_2));
+            ATCmdParseFailed(outArgs, E_AT_RESULT_FAIL, reason);
+            return xFalse;
         }
+    }
+    if (list->check != NULL && list->check(outArgs, (uint8_t)acturalSepNum) == xFalse)
+    {
+        ATCmdParseFailed(outArgs, E_AT_RESULT_FAIL, "arg out of range");
+        return xFalse;
+    }
+    outArgs->argNum = list->num;
+    return xTrue;
+}
+
+// will parse command as outArgs not related to the SHARECom
+xBool ATCmdParse(ATCmdArgs *outArgs)
+{
+    // step1 find "AT"
+    uint16_t startIdx = 0;
+    memset(outArgs, 0, sizeof(ATCmdArgs));
+    if (xStringStartIdxFinder(atCmdProcRaw, "AT", &startIdx) == xFalse)
+    {
+        return xFalse;
+    }
+    startIdx = startIdx + xStringLen("AT"); // go to content.
+    if (atCmdProcRaw[startIdx] == '?')      // AT?
+    {
+        outArgs->cmd = E_AT_CMD_TEST;
+        outArgs->result = E_AT_RESULT_OK;
+        outArgs->type = E_AT_CMD_TYPE_GET;
+        outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_INVALID;
+        outArgs->argNum = 0;
+        log_d("query command");
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_FREQTUNE)
+    else if (atCmdProcRaw[startIdx] != '+') // AT+
+    {
+        return xFalse;
+    }
+
+    // step2 取出命令名 token,到 '?' '=' 或结尾为止
+    startIdx = startIdx + 1;
+    uint16_t tokenLen = 0;
+    while (atCmdProcRaw[startIdx + tokenLen] != '\0' && atCmdProcRaw[startIdx + tokenLen] != '?' && atCmdProcRaw[startIdx + tokenLen] != '=')
+    {
+        tokenLen++;
+    }
+    const ATCmdEntry *entry = ATCmdLookup(&atCmdProcRaw[startIdx], tokenLen);
+    if (entry == NULL)
     {
-        log_d("get freq tune");
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_INT;
-        argsToBeProc->args[0].raw.intValue = base->freqTune;
-        return xTrue;
+        return ATCmdParseFailed(outArgs, E_AT_RESULT_INVALID, "not support command");
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RF)
+    char op = atCmdProcRaw[startIdx + tokenLen];
+
+    // step3 按表项描述解析
+    if (entry->flags & AT_CMD_FLAG_ACTION)
     {
-        log_d("get RF enable state");
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-        if (base->rfEnable)
-        {
-            xStringnCopy(argsToBeProc->args[0].raw.strValue, AT_CMD_RF_ENABLE, xStringLen(AT_CMD_RF_ENABLE));
-        }
-        else
-        {
-            xStringnCopy(argsToBeProc->args[0].raw.strValue, AT_CMD_RF_DISABLE, xStringLen(AT_CMD_RF_DISABLE));
-        }
+        outArgs->cmd = entry->cmd;
+        outArgs->entry = entry;
+        outArgs->result = E_AT_RESULT_OK;
+        outArgs->type = E_AT_CMD_TYPE_SET;
+        outArgs->args[0].argType = E_AT_CMD_ARG_TYPE_INVALID;
+        outArgs->argNum = 0;
+        log_d("action %s", entry->name);
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_SYS)
+    else if (op == '?' && (entry->flags & AT_CMD_FLAG_GET))
     {
-        // 查询不支持，只在 set 时返回 SUCCESS，无需回读参数
-        argsToBeProc->argNum = 1;
-        argsToBeProc->args[0].argType = E_AT_CMD_ARG_TYPE_STRING;
-        xStringnCopy(argsToBeProc->args[0].raw.strValue, AT_CMD_SYS_RESET, xStringLen(AT_CMD_SYS_RESET));
+        outArgs->cmd = entry->cmd;
+        outArgs->entry = entry;
+        outArgs->result = E_AT_RESULT_OK;
+        outArgs->type = E_AT_CMD_TYPE_GET;
+        log_d("query %s", entry->name);
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_BOOTLOAD)
+    else if (op == '=' && (entry->flags & AT_CMD_FLAG_SET))
     {
-        log_d("enter bootloader command");
+        char *argStr = &atCmdProcRaw[startIdx + tokenLen + 1];
+        xBool parsed = entry->argList != NULL ? ATCmdParseArgList(outArgs, entry->argList, argStr) : ATCmdParseSetArg(outArgs, entry, argStr);
+        if (parsed == xFalse)
+        {
+            return xTrue; // 结果已填为FAIL/INVALID
+        }
+        outArgs->cmd = entry->cmd;
+        outArgs->entry = entry;
+        outArgs->result = entry->setResult;
+        outArgs->type = E_AT_CMD_TYPE_SET;
+        log_d("set %s", entry->name);
         return xTrue;
     }
-    log_e("not support command");
-    return xFalse;
+    return ATCmdParseFailed(outArgs, E_AT_RESULT_INVALID, "not support operation");
 }
 
-// base on COM ,process the command,full fill the SHARECom
-xBool ATCmdArgsSetProc(ATCmdArgs *argsToBeProc, SHARECom *base)
+// base on COM ,process the command,full fill the result
+xBool ATCmdArgsGetProc(ATCmdArgs *argsToBeProc, SHARECom *base)
 {
     if (argsToBeProc == NULL || base == NULL)
     {
         log_e("argsToBeProc or base is NULL");
         return xFalse;
     }
-    if (argsToBeProc->type == E_AT_CMD_TYPE_GET)
+    if (argsToBeProc->type == E_AT_CMD_TYPE_SET)
     {
         return xTrue;
     }
-
     if (argsToBeProc->cmd == E_AT_CMD_NONE)
     {
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_NAME)
-    {
-        return xTrue;
-    }
-    else if (argsToBeProc->cmd == E_AT_CMD_VER)
-    {
-        return xTrue;
-    }
-    else if (argsToBeProc->cmd == E_AT_CMD_BANDCAP)
-    {
-        return xTrue;
-    }
-    else if (argsToBeProc->cmd == E_AT_CMD_SMETER)
-    {
-        return xTrue;
-    }
     else if (argsToBeProc->cmd == E_AT_CMD_TEST)
     {
+        log_d("get test condition");
+        argsToBeProc->argNum = 0;
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_SQL)
+
+    const ATCmdEntry *entry = argsToBeProc->entry;
+    if (entry == NULL)
     {
-        base->sql = argsToBeProc->args[0].raw.uintValue;
-        fetchPut(E_AT_CMD_SQL);
-        return xTrue;
+        log_e("not support command");
+        return xFalse;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TXFREQ)
+    if (entry->get != NULL)
     {
-        base->txFreq = argsToBeProc->args[0].raw.floatValue;
-        fetchPut(E_AT_CMD_TXFREQ);
+        entry->get(argsToBeProc, base);
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RXFREQ)
-    {
-        base->rxFreq = argsToBeProc->args[0].raw.floatValue;
-        fetchPut(E_AT_CMD_RXFREQ);
+
+    ATCmdArg *arg = &argsToBeProc->args[0];
+    const uint8_t *field = (const uint8_t *)base + entry->fieldOffset;
+    uint32_t value = 0;
+    argsToBeProc->argNum = 1;
+    arg->argType = entry->argType;
+    switch (entry->fieldType)
+    {
+    case E_AT_FIELD_U8:
+        value = *(const uint8_t *)field;
+        arg->raw.uintValue = value;
+        break;
+    case E_AT_FIELD_U16:
+        value = *(const uint16_t *)field;
+        arg->raw.uintValue = value;
+        break;
+    case E_AT_FIELD_U32:
+        value = *(const uint32_t *)field;
+        arg->raw.uintValue = value;
+        break;
+    case E_AT_FIELD_I32:
+        arg->raw.intValue = *(const int32_t *)field;
+        break;
+    case E_AT_FIELD_FLOAT:
+        arg->raw.floatValue = *(const float *)field;
+        break;
+    default:
+        argsToBeProc->argNum = 0;
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RXVOL)
+    if (entry->enumList != NULL)
     {
-        base->rxVol = argsToBeProc->args[0].raw.uintValue;
-        fetchPut(E_AT_CMD_RXVOL);
-        return xTrue;
+        // 字段值作为下标转换为字符串
+        memset(arg->raw.strValue, 0, sizeof(arg->raw.strValue));
+        if (value < entry->enumNum)
+        {
+            xStringnCopy(arg->raw.strValue, (char *)entry->enumList[value], xStringLen((char *)entry->enumList[value]));
+        }
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TXVOL)
+    log_d("get %s", entry->name);
+    return xTrue;
+}
+
+// base on COM ,process the command,full fill the SHARECom
+xBool ATCmdArgsSetProc(ATCmdArgs *argsToBeProc, SHARECom *base)
+{
+    if (argsToBeProc == NULL || base == NULL)
     {
-        base->txVol = argsToBeProc->args[0].raw.uintValue;
-        fetchPut(E_AT_CMD_TXVOL);
-        return xTrue;
+        log_e("argsToBeProc or base is NULL");
+        return xFalse;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TCTCSS)
+    if (argsToBeProc->type == E_AT_CMD_TYPE_GET)
     {
-        base->tCTCSS = argsToBeProc->args[0].raw.floatValue;
-        fetchPut(E_AT_CMD_TCTCSS);
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RCTCSS)
+    if (argsToBeProc->cmd == E_AT_CMD_NONE || argsToBeProc->cmd == E_AT_CMD_TEST)
     {
-        base->rCTCSS = argsToBeProc->args[0].raw.floatValue;
-        fetchPut(E_AT_CMD_RCTCSS);
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_TXPWR)
+
+    const ATCmdEntry *entry = argsToBeProc->entry;
+    if (entry == NULL)
     {
-        if (xStringnCompare(argsToBeProc->args[0].raw.strValue, AT_CMD_TXPWR_LIST_0, xStringLen(AT_CMD_TXPWR_LIST_0)) == true)
-        {
-            base->txPwr = TX_PWR_LOW;
-        }
-        else if (xStringnCompare(argsToBeProc->args[0].raw.strValue, AT_CMD_TXPWR_LIST_1, xStringLen(AT_CMD_TXPWR_LIST_1)) == true)
-        {
-            base->txPwr = TX_PWR_MID;
-        }
-        else if (xStringnCompare(argsToBeProc->args[0].raw.strValue, AT_CMD_TXPWR_LIST_2, xStringLen(AT_CMD_TXPWR_LIST_2)) == true)
-        {
-            base->txPwr = TX_PWR_HIGH;
-        }
-        fetchPut(E_AT_CMD_TXPWR);
-        return xTrue;
+        return xFalse;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_FREQTUNE)
+    if (!(entry->flags & (AT_CMD_FLAG_SET | AT_CMD_FLAG_ACTION)))
     {
-        base->freqTune = argsToBeProc->args[0].raw.intValue; // 频偏Hz
-        fetchPut(E_AT_CMD_FREQTUNE);
         return xTrue;
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_RF)
-    {
-        if (xStringnCompare(argsToBeProc->args[0].raw.strValue, AT_CMD_RF_ENABLE, xStringLen(AT_CMD_RF_ENABLE)) == true)
-        {
-            base->rfEnable = 1;
-        }
-        else if (xStringnCompare(argsToBeProc->args[0].raw.strValue, AT_CMD_RF_DISABLE, xStringLen(AT_CMD_RF_DISABLE)) == true)
+
+    uint8_t *field = (uint8_t *)base + entry->fieldOffset;
+    ATCmdArg *arg = &argsToBeProc->args[0];
+    switch (entry->fieldType)
+    {
+    case E_AT_FIELD_U8:
+        *(uint8_t *)field = (uint8_t)arg->raw.uintValue;
+        break;
+    case E_AT_FIELD_U16:
+        *(uint16_t *)field = (uint16_t)arg->raw.uintValue;
+        break;
+    case E_AT_FIELD_U32:
+        *(uint32_t *)field = arg->raw.uintValue;
+        break;
+    case E_AT_FIELD_I32:
+        *(int32_t *)field = arg->raw.intValue;
+        break;
+    case E_AT_FIELD_FLOAT:
+        *(float *)field = arg->raw.floatValue;
+        break;
+    default:
+        if (entry->set != NULL)
         {
-            base->rfEnable = 0;
+            entry->set(argsToBeProc, base); // 多字段命令
         }
-        fetchPut(E_AT_CMD_RF);
-        return xTrue;
+        break; // 否则不修改 SHARECom 数据，只发出功能事件
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_SYS)
+    if (entry->flags & AT_CMD_FLAG_FREQ)
     {
-        // 不修改 SHARECom 数据，只发出功能事件
-        fetchPut(E_AT_CMD_SYS);
-        return xTrue;
+        base->chSel = CHANNEL_NONE; // 在设置时清除,同一批中与AT+CHSEL的先后关系由到达顺序决定
     }
-    else if (argsToBeProc->cmd == E_AT_CMD_BOOTLOAD)
+    if (!(entry->flags & AT_CMD_FLAG_LOCAL))
     {
-        fetchPut(E_AT_CMD_BOOTLOAD);
-        return xTrue;
+        fetchPut(entry->cmd);
     }
-    return xFalse;
+    return xTrue;
 }
-
 xBool ATCmdSendResult(ATCmdArgs *inArgs)
 {
     char sendBuf[AT_CMD_SEND_BYTE_MAX];
@@ -1373,96 +1401,26 @@ xBool ATCmdSendResult(ATCmdArgs *inArgs)
     }
     if (inArgs->result == E_AT_RESULT_INVALID)
     {
-        ctrl.sendBytes((uint8_t *)AT_CMD_INVALID, xStringLen(AT_CMD_INVALID));
-        ctrl.sendBytes((uint8_t *)"\n", 1);
+        ctrl.sendBytes((uint8_t *)AT_CMD_INVALID "\n", xStringLen(AT_CMD_INVALID "\n")); // 每条回复一次写入,发送缓冲不足时整条丢弃
         return xTrue;
     }
     else if (inArgs->result == E_AT_RESULT_FAIL)
     {
-        ctrl.sendBytes((uint8_t *)AT_CMD_FAILED, xStringLen(AT_CMD_FAILED));
-        ctrl.sendBytes((uint8_t *)"\n", 1);
+        ctrl.sendBytes((uint8_t *)AT_CMD_FAILED "\n", xStringLen(AT_CMD_FAILED "\n"));
         return xTrue;
     }
     else if (inArgs->result == E_AT_RESULT_SUCC)
     {
-        ctrl.sendBytes((uint8_t *)AT_CMD_SUCCESS, xStringLen(AT_CMD_SUCCESS));
-        ctrl.sendBytes((uint8_t *)"\n", 1);
+        ctrl.sendBytes((uint8_t *)AT_CMD_SUCCESS "\n", xStringLen(AT_CMD_SUCCESS "\n"));
         return xTrue;
     }
     else if (inArgs->result == E_AT_RESULT_OK)
     {
         uint16_t sendBufUsedLen = 0;
-        switch (inArgs->cmd)
+        if (inArgs->entry != NULL)
         {
-        case E_AT_CMD_TEST:
-            sendBufUsedLen = 0;
-            break;
-        case E_AT_CMD_NAME:
-            sendBufUsedLen = xStringLen(AT_CMD_NAME);
-            xStringnCopy(sendBuf, AT_CMD_NAME, sendBufUsedLen);
-            break;
-        case E_AT_CMD_VER:
-            sendBufUsedLen = xStringLen(AT_CMD_VER);
-            xStringnCopy(sendBuf, AT_CMD_VER, sendBufUsedLen);
-            break;
-        case E_AT_CMD_BANDCAP:
-            sendBufUsedLen = xStringLen(AT_CMD_BANDCAP);
-            xStringnCopy(sendBuf, AT_CMD_BANDCAP, sendBufUsedLen);
-            break;
-        case E_AT_CMD_SMETER:
-            sendBufUsedLen = xStringLen(AT_CMD_SMETER);
-            xStringnCopy(sendBuf, AT_CMD_SMETER, sendBufUsedLen);
-            break;
-        case E_AT_CMD_SQL:
-            sendBufUsedLen = xStringLen(AT_CMD_SQL);
-            xStringnCopy(sendBuf, AT_CMD_SQL, sendBufUsedLen);
-            break;
-        case E_AT_CMD_TXFREQ:
-            sendBufUsedLen = xStringLen(AT_CMD_TXFREQ);
-            xStringnCopy(sendBuf, AT_CMD_TXFREQ, sendBufUsedLen);
-            break;
-        case E_AT_CMD_RXFREQ:
-            sendBufUsedLen = xStringLen(AT_CMD_RXFREQ);
-            xStringnCopy(sendBuf, AT_CMD_RXFREQ, sendBufUsedLen);
-            break;
-        case E_AT_CMD_RXVOL:
-            sendBufUsedLen = xStringLen(AT_CMD_RXVOL);
-            xStringnCopy(sendBuf, AT_CMD_RXVOL, sendBufUsedLen);
-            break;
-        case E_AT_CMD_TXVOL:
-            sendBufUsedLen = xStringLen(AT_CMD_TXVOL);
-            xStringnCopy(sendBuf, AT_CMD_TXVOL, sendBufUsedLen);
-            break;
-        case E_AT_CMD_TCTCSS:
-            sendBufUsedLen = xStringLen(AT_CMD_TCTCSS);
-            xStringnCopy(sendBuf, AT_CMD_TCTCSS, sendBufUsedLen);
-            break;
-        case E_AT_CMD_RCTCSS:
-            sendBufUsedLen = xStringLen(AT_CMD_RCTCSS);
-            xStringnCopy(sendBuf, AT_CMD_RCTCSS, sendBufUsedLen);
-            break;
-        case E_AT_CMD_TXPWR:
-            sendBufUsedLen = xStringLen(AT_CMD_TXPWR);
-            xStringnCopy(sendBuf, AT_CMD_TXPWR, sendBufUsedLen);
-            break;
-        case E_AT_CMD_FREQTUNE:
-            sendBufUsedLen = xStringLen(AT_CMD_FREQTUNE);
-            xStringnCopy(sendBuf, AT_CMD_FREQTUNE, sendBufUsedLen);
-            break;
-        case E_AT_CMD_RF:
-            sendBufUsedLen = xStringLen(AT_CMD_RF);
-            xStringnCopy(sendBuf, AT_CMD_RF, sendBufUsedLen);
-            break;
-        case E_AT_CMD_SYS:
-            sendBufUsedLen = xStringLen(AT_CMD_SYS);
-            xStringnCopy(sendBuf, AT_CMD_SYS, sendBufUsedLen);
-            break;
-	case E_AT_CMD_BOOTLOAD:
-            sendBufUsedLen = xStringLen(AT_CMD_BOOTLOAD);
-            xStringnCopy(sendBuf, AT_CMD_BOOTLOAD, sendBufUsedLen);
-            break;
-        default:
-            break;
+            sendBufUsedLen = xStringLen((char *)inArgs->entry->name);
+            xStringnCopy(sendBuf, (char *)inArgs->entry->name, sendBufUsedLen);
         }
 
         if (inArgs->argNum != 0)
@@ -1513,118 +1471,401 @@ xBool ATCmdSendResult(ATCmdArgs *inArgs)
     return xFalse;
 }
 
-// AT Command Handler Process Command Every 100ms
-void ATCmdHandler(SHARECom *com)
+// 二进制帧模式: TAG到命令表项的映射,字段类型/范围/读写属性沿用命令表
+typedef struct
+{
+    uint8_t tag;  // BIN_TAG_xx
+    ATCmd cmd;    // 对应的命令,用于查找表项和通知syncTask
+    uint8_t size; // 线路上的字节数
+} ATBinTag;
+
+static const ATBinTag atBinTagTable[] =
+    {
+        {BIN_TAG_SQL, E_AT_CMD_SQL, 1},
+        {BIN_TAG_TXFREQ, E_AT_CMD_TXFREQ, 4},
+        {BIN_TAG_RXFREQ, E_AT_CMD_RXFREQ, 4},
+        {BIN_TAG_RXVOL, E_AT_CMD_RXVOL, 1},
+        {BIN_TAG_TXVOL, E_AT_CMD_TXVOL, 1},
+        {BIN_TAG_TXPWR, E_AT_CMD_TXPWR, 1},
+        {BIN_TAG_FREQTUNE, E_AT_CMD_FREQTUNE, 4},
+        {BIN_TAG_RF, E_AT_CMD_RF, 1},
+        {BIN_TAG_SMETER, E_AT_CMD_SMETER, 1},
+        {BIN_TAG_BANDCAP, E_AT_CMD_BANDCAP, 2},
+};
+#define AT_BIN_TAG_TABLE_SIZE (sizeof(atBinTagTable) / sizeof(atBinTagTable[0]))
+
+static xBool atBinMode = xFalse;
+static uint32_t atBinStamp = 0; // 最近一次有效帧的时间
+static BinDecoder atBinDecoder;
+static BinFrame atBinReq;
+static BinFrame atBinRsp;
+
+xBool ATCmdIsBinaryMode(void)
 {
-    uint8_t recvBuf[AT_CMD_RECV_BYTE_MAX];
-    uint16_t recvLen = 0;
-    uint16_t storeLen = 0;
-    int endTagIndex = 0;
+    return atBinMode;
+}
 
-    xBool isFoundEndTag = xFalse;
+static void ATBinEnter(void)
+{
+    binProtoDecoderInit(&atBinDecoder);
+    atBinStamp = millis();
+    atBinMode = xTrue;
+    log_i("enter binary mode");
+}
 
-    // 添加参数检查
-    if (com == NULL || ctrl.recvBytes == NULL || ctrl.sendBytes == NULL)
+static const ATBinTag *ATBinFindTag(uint8_t tag)
+{
+    for (int i = 0; i < AT_BIN_TAG_TABLE_SIZE; i++)
     {
-        log_e("Invalid parameters or uninitialized controller");
-        return;
+        if (atBinTagTable[i].tag == tag)
+        {
+            return &atBinTagTable[i];
+        }
     }
+    return NULL;
+}
 
-    // wait for the command handler period
-    if (atCmdPeriond > millis())
+static const ATCmdEntry *ATCmdFindEntry(ATCmd cmd)
+{
+    for (int i = 0; i < AT_CMD_TABLE_SIZE; i++)
     {
-        return;
+        if (atCmdTable[i].cmd == cmd)
+        {
+            return &atCmdTable[i];
+        }
     }
+    return NULL;
+}
 
-    atCmdPeriond = millis() + AT_CMD_HANDLER_PERIOD;
-    memset(atCmdProcRaw, 0, AT_CMD_BUF_LEN);
-    recvLen = ctrl.recvBytes(recvBuf, AT_CMD_RECV_BYTE_MAX);
-    if (recvLen == 0)
-    {
-        return;
+// 读取字段,频率由MHz转为整数Hz
+static uint32_t ATBinFieldGet(const ATCmdEntry *entry, const SHARECom *base)
+{
+    const uint8_t *field = (const uint8_t *)base + entry->fieldOffset;
+    switch (entry->fieldType)
+    {
+    case E_AT_FIELD_U8:
+        return *(const uint8_t *)field;
+    case E_AT_FIELD_U16:
+        return *(const uint16_t *)field;
+    case E_AT_FIELD_U32:
+        return *(const uint32_t *)field;
+    case E_AT_FIELD_I32:
+        return (uint32_t)*(const int32_t *)field;
+    case E_AT_FIELD_FLOAT:
+        return BK4802MHzToHz(*(const float *)field);
+    default:
+        return 0;
+    }
+}
+
+// 写入字段,频率由整数Hz转为MHz
+static void ATBinFieldSet(const ATCmdEntry *entry, SHARECom *base, uint32_t value)
+{
+    uint8_t *field = (uint8_t *)base + entry->fieldOffset;
+    switch (entry->fieldType)
+    {
+    case E_AT_FIELD_U8:
+        *(uint8_t *)field = (uint8_t)value;
+        break;
+    case E_AT_FIELD_U16:
+        *(uint16_t *)field = (uint16_t)value;
+        break;
+    case E_AT_FIELD_U32:
+        *(uint32_t *)field = value;
+        break;
+    case E_AT_FIELD_I32:
+        *(int32_t *)field = (int32_t)value;
+        break;
+    case E_AT_FIELD_FLOAT:
+        *(float *)field = ATCmdHzToMHz(value);
+        break;
+    default:
+        break;
     }
-    log_d("recvLen:%d", recvLen);
+}
 
-    // step1: put the received data into the ring buffer and check for end tags
-    for (endTagIndex = 0; endTagIndex < recvLen; endTagIndex++)
+// 按表项检查SET数值,返回BIN_STATUS_xx
+static uint8_t ATBinCheck(const ATBinTag *binTag, const ATCmdEntry *entry, uint8_t len, uint32_t value)
+{
+    if (!(entry->flags & AT_CMD_FLAG_SET))
+    {
+        return BIN_STATUS_READONLY;
+    }
+    if (len != binTag->size)
+    {
+        return BIN_STATUS_BAD_TAG;
+    }
+    if (entry->enumList != NULL)
+    {
+        return value < entry->enumNum ? BIN_STATUS_OK : BIN_STATUS_BAD_VALUE;
+    }
+    switch (entry->fieldType)
     {
-        // 检查换行符组合：\r\n, \n\r, \r, \n
-        if (recvBuf[endTagIndex] == '\n' || recvBuf[endTagIndex] == '\r')
+    case E_AT_FIELD_I32:
+        return ((int32_t)value >= entry->min && (int32_t)value <= entry->max) ? BIN_STATUS_OK : BIN_STATUS_BAD_VALUE;
+    case E_AT_FIELD_FLOAT:
+        return isVailideHamFreq(ATCmdHzToMHz(value)) ? BIN_STATUS_OK : BIN_STATUS_BAD_VALUE;
+    default:
+        return (value >= (uint32_t)entry->min && value <= (uint32_t)entry->max) ? BIN_STATUS_OK : BIN_STATUS_BAD_VALUE;
+    }
+}
+
+// 处理一个完整的请求帧并回复
+static void ATBinProcess(SHARECom *com)
+{
+    uint8_t pos = 0;
+    uint8_t tag = 0;
+    uint8_t len = 0;
+    const uint8_t *value = NULL;
+    const ATBinTag *binTag = NULL;
+    int ret = 0;
+    uint8_t status = BIN_STATUS_OK;
+    uint8_t sendBuf[BIN_PROTO_MAX_FRAME];
+    uint16_t sendLen;
+
+    binFrameInit(&atBinRsp, atBinReq.op | BIN_OP_REPLY, atBinReq.seq);
+    binTlvPut(&atBinRsp, BIN_TAG_STATUS, BIN_STATUS_OK, 1); // 第一个TLV为状态,最后回填
+    switch (atBinReq.op)
+    {
+    case BIN_OP_GET:
+        while (status == BIN_STATUS_OK && (ret = binTlvNext(&atBinReq, &pos, &tag, &len, &value)) > 0)
         {
-            isFoundEndTag = xTrue;
-            // 修复索引越界问题
-            while (endTagIndex + 1 < recvLen && (recvBuf[endTagIndex + 1] == '\n' || recvBuf[endTagIndex + 1] == '\r'))
+            binTag = ATBinFindTag(tag);
+            if (binTag == NULL)
+            {
+                status = BIN_STATUS_BAD_TAG;
+            }
+            else if (binTlvPut(&atBinRsp, tag, ATBinFieldGet(ATCmdFindEntry(binTag->cmd), com), binTag->size) == 0)
             {
-                endTagIndex++;
+                status = BIN_STATUS_OVERFLOW;
             }
+        }
+        break;
+    case BIN_OP_SET:
+        // 先整体校验,任一项失败则全部不生效
+        while (status == BIN_STATUS_OK && (ret = binTlvNext(&atBinReq, &pos, &tag, &len, &value)) > 0)
+        {
+            binTag = ATBinFindTag(tag);
+            status = binTag == NULL ? BIN_STATUS_BAD_TAG : ATBinCheck(binTag, ATCmdFindEntry(binTag->cmd), len, binTlvGetU32(value, len));
+        }
+        if (status != BIN_STATUS_OK || ret < 0)
+        {
             break;
         }
-    }
-    log_d("isFoundEndTag:%d", isFoundEndTag);
-
-    if (isFoundEndTag == false)
-    {
-        // 只存储可打印字符到环形缓冲区，并检查缓冲区空间
-        for (int j = 0; j < recvLen; j++)
+        pos = 0;
+        while (binTlvNext(&atBinReq, &pos, &tag, &len, &value) > 0)
         {
-            if (recvBuf[j] >= 0x20 && recvBuf[j] <= 0x7E)
+            binTag = ATBinFindTag(tag);
+            ATBinFieldSet(ATCmdFindEntry(binTag->cmd), com, binTlvGetU32(value, len));
+            if (ATCmdFindEntry(binTag->cmd)->flags & AT_CMD_FLAG_FREQ)
             {
-                if (xRingBufFull(&serialRingHandler))
-                {
-                    log_w("ring buffer is full, drop the data");
-                    xRingBufClear(&serialRingHandler);
-                    return;
-                }
-                xRingBufPut(&serialRingHandler, &recvBuf[j], 1);
+                com->chSel = CHANNEL_NONE;
             }
+            fetchPut(binTag->cmd);
         }
+        break;
+    case BIN_OP_EXIT:
+        atBinMode = xFalse;
+        log_i("exit binary mode");
+        break;
+    default:
+        status = BIN_STATUS_BAD_OP;
+        break;
+    }
+    if (ret < 0)
+    {
+        status = BIN_STATUS_BAD_TAG;
+    }
+    if (status != BIN_STATUS_OK)
+    {
+        atBinRsp.tlvLen = 3; // 出错只回复状态
+    }
+    atBinRsp.tlv[2] = status;
+    sendLen = binProtoEncode(&atBinRsp, sendBuf, sizeof(sendBuf));
+    ctrl.sendBytes(sendBuf, sendLen);
+}
+
+// 二进制模式下逐字节输入
+static void ATBinFeed(SHARECom *com, uint8_t byte)
+{
+    int ret = binProtoFeed(&atBinDecoder, byte, &atBinReq);
+    if (ret < 0)
+    {
+        log_w("binary frame crc error");
+        return;
+    }
+    if (ret == 0)
+    {
         return;
     }
+    atBinStamp = millis();
+    atBaudConfirm(); // 新波特率下收到有效帧
+    ATBinProcess(com);
+}
+
+static xBool ATCmdStreamChanged(const SHARETelemetry *now, const SHARETelemetry *last)
+{
+    return abs(now->rssi - last->rssi) >= AT_CMD_STREAM_DEADBAND ||
+           abs(now->snr - last->snr) >= AT_CMD_STREAM_DEADBAND ||
+           abs(now->afc - last->afc) >= AT_CMD_STREAM_DEADBAND ||
+           now->smeter != last->smeter ||
+           now->sqlOpen != last->sqlOpen ||
+           now->ptt != last->ptt ||
+           now->ifGain != last->ifGain ||
+           now->errFlags != last->errFlags;
+}
 
-    // assemble the command,include(1)the previous data in the ring buffer (2)the current data of recvBuf
-    storeLen = xRingBufGet(&serialRingHandler, (unsigned char *)atCmdProcRaw, AT_CMD_BUF_LEN);
+// 按订阅周期推送遥测,链路拥塞时跳过,不挤占指令回复
+static void ATCmdStreamPoll(void)
+{
+    SHARETelemetry telem;
+    uint8_t sendBuf[AT_CMD_STREAM_RECORD_MAX];
+    uint16_t sendLen = 0;
+    if (atStreamPeriod == 0 || atTelemetrySource == NULL || millis() - atStreamStamp < atStreamPeriod)
+    {
+        return;
+    }
+    atStreamStamp = millis();
+    atTelemetrySource(&telem);
+    if (atStreamDelta && atStreamLastValid && ATCmdStreamChanged(&telem, &atStreamLast) == xFalse)
+    {
+        return;
+    }
+    if (atSendFree() < AT_CMD_STREAM_RECORD_MAX)
+    {
+        return;
+    }
+    atStreamLast = telem;
+    atStreamLastValid = xTrue;
 
-    // put the current data of recvBuf into the command buffer (only printable chars before end tag)
-    for (int j = 0; j < endTagIndex; j++)
+    // SHARETelemetry全部为uint8_t,按字段顺序作为字节数组发送
+    const uint8_t *field = (const uint8_t *)&telem;
+    if (atBinMode)
+    {
+        BinFrame frame;
+        binFrameInit(&frame, BIN_OP_TELEMETRY, atStreamSeq++);
+        binTlvPutBytes(&frame, BIN_TAG_TELEMETRY, field, sizeof(telem));
+        sendLen = binProtoEncode(&frame, sendBuf, sizeof(sendBuf));
+    }
+    else
     {
-        if (recvBuf[j] >= 0x20 && recvBuf[j] <= 0x7E && storeLen < AT_CMD_BUF_LEN - 1)
+        xStringnCopy((char *)sendBuf, "+" AT_CMD_STREAM ":", xStringLen("+" AT_CMD_STREAM ":"));
+        sendLen = xStringLen("+" AT_CMD_STREAM ":");
+        for (int i = 0; i < sizeof(telem); i++)
         {
-            atCmdProcRaw[storeLen++] = recvBuf[j];
+            sendLen += xStringUint32Toa((char *)sendBuf + sendLen, field[i]);
+            sendBuf[sendLen++] = (i == sizeof(telem) - 1) ? '\n' : ',';
         }
     }
+    ctrl.sendBytes(sendBuf, sendLen);
+}
 
-    // 确保字符串结束
-    atCmdProcRaw[storeLen] = '\0';
-
-    log_d("found command:%s", atCmdProcRaw);
+// 推送新的静噪/PTT事件,环被覆盖时只推送仍保留的部分
+static void ATCmdEventPoll(void)
+{
+    SHAREEvent evt[SHARE_EVENT_RING_SIZE];
+    uint8_t sendBuf[AT_CMD_STREAM_RECORD_MAX];
+    uint16_t sendLen;
+    uint32_t total = 0;
+    uint8_t num;
+    if (atEventPush == xFalse || atEventSource == NULL)
+    {
+        return;
+    }
+    num = atEventSource(evt, SHARE_EVENT_RING_SIZE, &total);
+    if (total == atEventSeen)
+    {
+        return;
+    }
+    for (uint8_t i = (total - atEventSeen) < num ? num - (total - atEventSeen) : 0; i < num; i++)
+    {
+        if (atSendFree() < AT_CMD_STREAM_RECORD_MAX)
+        {
+            return; // 下次轮询继续
+        }
+        if (atBinMode)
+        {
+            BinFrame frame;
+            binFrameInit(&frame, BIN_OP_EVENT, (uint8_t)(total - num + i));
+            binTlvPut(&frame, BIN_TAG_EVENT, evt[i].type | (uint32_t)evt[i].state << 8, 2);
+            binTlvPut(&frame, BIN_TAG_EVENT_US, evt[i].us, 4);
+            sendLen = binProtoEncode(&frame, sendBuf, sizeof(sendBuf));
+        }
+        else
+        {
+            xStringnCopy((char *)sendBuf, "+EVENT:", xStringLen("+EVENT:"));
+            sendLen = xStringLen("+EVENT:");
+            sendLen += ATCmdEventToa((char *)sendBuf + sendLen, &evt[i]);
+            sendBuf[sendLen++] = '\n';
+        }
+        ctrl.sendBytes(sendBuf, sendLen);
+        atEventSeen = total - num + i + 1;
+    }
+    atEventSeen = total;
+}
 
-    // put the rest data back to the ring buffer (skip the end tag)
-    endTagIndex++; // 跳过当前的换行符
-    if (endTagIndex < recvLen)
+// 推送新的扫描结果,环被覆盖时只推送仍保留的部分
+static void ATCmdScanPoll(void)
+{
+    SHAREScan res[SHARE_SCAN_RING_SIZE];
+    uint8_t sendBuf[AT_CMD_STREAM_RECORD_MAX];
+    uint16_t sendLen;
+    uint32_t total = 0;
+    uint8_t num;
+    if (atScanSource == NULL)
+    {
+        return;
+    }
+    num = atScanSource(res, SHARE_SCAN_RING_SIZE, &total);
+    if (total == atScanSeen)
+    {
+        return;
+    }
+    for (uint8_t i = (total - atScanSeen) < num ? num - (total - atScanSeen) : 0; i < num; i++)
     {
-        for (int j = endTagIndex; j < recvLen; j++)
+        if (atSendFree() < AT_CMD_STREAM_RECORD_MAX)
         {
-            if (recvBuf[j] >= 0x20 && recvBuf[j] <= 0x7E)
-            {
-                // 检查缓冲区空间
-                if (!xRingBufFull(&serialRingHandler))
-                {
-                    xRingBufPut(&serialRingHandler, &recvBuf[j], 1);
-                }
-                else
-                {
-                    log_w("ring buffer full when storing remaining data");
-                    break;
-                }
-            }
+            return; // 下次轮询继续
+        }
+        if (atBinMode)
+        {
+            BinFrame frame;
+            binFrameInit(&frame, BIN_OP_SCAN, (uint8_t)(total - num + i));
+            binTlvPut(&frame, BIN_TAG_SCAN, res[i].type | (uint32_t)res[i].index << 8 | (uint32_t)res[i].rssi << 16 | (uint32_t)res[i].snr << 24, 4);
+            binTlvPut(&frame, BIN_TAG_SCAN_VALUE, res[i].value, 4);
+            sendLen = binProtoEncode(&frame, sendBuf, sizeof(sendBuf));
+        }
+        else
+        {
+            xStringnCopy((char *)sendBuf, "+SCAN:", xStringLen("+SCAN:"));
+            sendLen = xStringLen("+SCAN:");
+            sendLen += ATCmdScanToa((char *)sendBuf + sendLen, &res[i]);
+            sendBuf[sendLen++] = '\n';
         }
+        ctrl.sendBytes(sendBuf, sendLen);
+        atScanSeen = total - num + i + 1;
     }
+    atScanSeen = total;
+}
 
-    // 如果命令为空，直接返回
+// process one assembled line in atCmdProcRaw
+static void ATCmdProcessLine(SHARECom *com)
+{
+    uint16_t storeLen;
+    memset(atCmdProcRaw, 0, AT_CMD_BUF_LEN);
+    storeLen = xRingBufGet(&serialRingHandler, (unsigned char *)atCmdProcRaw, AT_CMD_BUF_LEN - 1);
+    // 如果命令为空(例如 \r\n 的第二个字符)，直接返回
     if (storeLen == 0)
     {
         return;
     }
+    // 去掉行尾空格: 终端常在回车前带空格,原前缀匹配对此宽容,按完整token匹配后需要显式去掉
+    while (storeLen > 0 && atCmdProcRaw[storeLen - 1] == ' ')
+    {
+        storeLen--;
+    }
+    atCmdProcRaw[storeLen] = '\0';
+    log_d("found command:%s", atCmdProcRaw);
 
     // step2: parse the command
     if (ATCmdParse(&recvCmdArgs) == xFalse)
@@ -1632,6 +1873,10 @@ void ATCmdHandler(SHARECom *com)
         log_w("parse command failed");
         return;
     }
+    if (recvCmdArgs.cmd != E_AT_CMD_NONE)
+    {
+        atBaudConfirm(); // 新波特率下收到有效指令
+    }
     if (ATCmdArgsSetProc(&recvCmdArgs, com) == xFalse)
     {
         log_w("set command failed");
@@ -1649,6 +1894,88 @@ void ATCmdHandler(SHARECom *com)
         log_w("send result failed");
         return;
     }
+    if (recvCmdArgs.cmd == E_AT_CMD_BINARY)
+    {
+        ATBinEnter(); // 回复以文本发出后再切换
+    }
+}
+
+// 已取出但还未处理的接收数据,发送缓冲放不下一条完整回复时留到下次处理
+static uint8_t atRecvBuf[AT_CMD_RECV_BYTE_MAX];
+static uint16_t atRecvLen = 0;
+static uint16_t atRecvPos = 0;
+static xBool atRecvHeld = xFalse;
+
+xBool ATCmdIsRecvHeld(void)
+{
+    return atRecvHeld;
+}
+
+// AT Command Handler, process every complete line while the send buffer can take a full reply
+// called periodically and triggered by the receive ISR when a line ends
+void ATCmdHandler(SHARECom *com)
+{
+    // 添加参数检查
+    if (com == NULL || ctrl.recvBytes == NULL || ctrl.sendBytes == NULL)
+    {
+        log_e("Invalid parameters or uninitialized controller");
+        return;
+    }
+
+    if (atBinMode && millis() - atBinStamp > AT_CMD_BINARY_IDLE_TIMEOUT)
+    {
+        // 主机长时间无有效帧,回到文本模式以便重新连接
+        atBinMode = xFalse;
+        log_w("binary mode idle timeout");
+    }
+
+    atRecvHeld = xFalse;
+    for (;;)
+    {
+        if (atRecvPos >= atRecvLen)
+        {
+            atRecvPos = 0;
+            atRecvLen = ctrl.recvBytes(atRecvBuf, AT_CMD_RECV_BYTE_MAX);
+            if (atRecvLen == 0)
+            {
+                break;
+            }
+            log_d("recvLen:%d", atRecvLen);
+        }
+        uint8_t ch = atRecvBuf[atRecvPos];
+        xBool lineEnd = (ch == '\n' || ch == '\r') ? xTrue : xFalse;
+        // 二进制帧的任意字节和文本的行结束都可能产生回复,发送缓冲不足时暂停,剩余数据留在接收侧
+        if ((atBinMode || lineEnd) && atSendFree() < AT_CMD_SEND_BYTE_MAX)
+        {
+            atRecvHeld = xTrue;
+            break;
+        }
+        atRecvPos++;
+        // 模式可能在一包数据中途切换,逐字节判断
+        if (atBinMode)
+        {
+            ATBinFeed(com, ch);
+        }
+        // 行结束：\r\n, \n\r, \r, \n 均可，连续的结束符产生空行被忽略
+        else if (lineEnd)
+        {
+            ATCmdProcessLine(com);
+        }
+        // 只存储可打印字符到环形缓冲区，并检查缓冲区空间
+        else if (ch >= 0x20 && ch <= 0x7E)
+        {
+            if (xRingBufFull(&serialRingHandler))
+            {
+                log_w("ring buffer is full, drop the data");
+                xRingBufClear(&serialRingHandler);
+                continue;
+            }
+            xRingBufPut(&serialRingHandler, &ch, 1);
+        }
+    }
+    ATCmdEventPoll();
+    ATCmdScanPoll();
+    ATCmdStreamPoll();
 }
 
 ATCmd FetchATCmd(void)
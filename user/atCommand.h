@@ -49,6 +49,25 @@ typedef enum
     E_AT_CMD_RF, // RF ENABLE / DISABLE
     E_AT_CMD_SYS, // System operations e.g. RESET
     E_AT_CMD_BOOTLOAD,
+    E_AT_CMD_PLLCACHE, // PLL register cache statistics
+    E_AT_CMD_UARTTX,   // UART transmit statistics
+    E_AT_CMD_BAUD,     // AT link baud rate
+    E_AT_CMD_LATENCY,  // AT command latency histogram
+    E_AT_CMD_BINARY,   // enter binary frame mode
+    E_AT_CMD_CH,       // channel switch, applied in one retune
+    E_AT_CMD_CMDQ,     // pending settings queue statistics
+    E_AT_CMD_STREAM,   // telemetry subscription
+    E_AT_CMD_EVENTS,   // squelch/PTT edge events
+    E_AT_CMD_PROF,     // scheduler task execution profile
+    E_AT_CMD_IDLE,     // scheduler sleep statistics
+    E_AT_CMD_LOAD,     // CPU load and ISR time
+    E_AT_CMD_TRX,      // TX/RX switchover timing
+    E_AT_CMD_CHMEM,    // memory channel store
+    E_AT_CMD_CHSEL,    // memory channel recall
+    E_AT_CMD_SCAN,     // channel scanner
+    E_AT_CMD_SCANCAL,  // scanner PLL settle calibration
+    E_AT_CMD_SCANOCC,  // scanner channel occupancy
+    E_AT_CMD_DUALW,    // dual watch / priority channel
     E_AT_CMD_MAX,
 } ATCmd;
 
@@ -61,6 +80,8 @@ typedef struct
     ATCmdSendBytesCb sendBytes; // send data to user interface
 } ATCmdPort;
 
+#define AT_CMD_SEND_BYTE_MAX 128 // max byte send once, a reply is always sent in one sendBytes call
+
 // AT Command Port init
 void ATCmdInit(const ATCmdPort *port);
 
@@ -74,4 +95,26 @@ void ATCmdHandler(SHARECom *com);
 // 多次操作将被推入队列，可以多次调用以获取所有命令更改
 ATCmd FetchATCmd(void);
 
+// 待同步指令队列统计: 最高水位(条),队列满丢弃数
+void ATCmdGetQueueStats(uint32_t *peak, uint32_t *dropped);
+
+// 遥测数据来源,AT+STREAM订阅后按周期调用
+typedef void (*ATCmdTelemetryCb)(SHARETelemetry *telem);
+void ATCmdSetTelemetrySource(ATCmdTelemetryCb cb);
+
+// 静噪/PTT事件来源,按时间顺序返回最近max条,total返回累计事件数
+typedef uint8_t (*ATCmdEventCb)(SHAREEvent *out, uint8_t max, uint32_t *total);
+void ATCmdSetEventSource(ATCmdEventCb cb);
+
+// 扫描结果来源,新结果在ATCmdHandler中主动推送
+typedef uint8_t (*ATCmdScanCb)(SHAREScan *out, uint8_t max, uint32_t *total);
+void ATCmdSetScanSource(ATCmdScanCb cb);
+
+// 是否处于二进制帧模式,此时接收到的任意数据都需要尽快处理
+xBool ATCmdIsBinaryMode(void);
+
+// 上次ATCmdHandler因发送缓冲放不下完整回复而留下了未处理的数据,
+// 发送缓冲剩余AT_CMD_SEND_BYTE_MAX以上时应再次调用ATCmdHandler
+xBool ATCmdIsRecvHeld(void);
+
 #endif
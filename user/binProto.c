@@ -0,0 +1,219 @@
+/*
+ *Binary framed control protocol codec
+ */
+#include "binProto.h"
+#include <string.h>
+
+#define BIN_DEC_WAIT_SYNC 0
+#define BIN_DEC_WAIT_LEN 1
+#define BIN_DEC_BODY 2
+
+uint16_t binProtoCrc16(const uint8_t *data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void binProtoDecoderInit(BinDecoder *dec)
+{
+    dec->state = BIN_DEC_WAIT_SYNC;
+    dec->len = 0;
+    dec->idx = 0;
+    dec->pendPos = 0;
+    dec->pendEnd = 0;
+}
+
+static int binDecByte(BinDecoder *dec, uint8_t byte, BinFrame *frame)
+{
+    switch (dec->state)
+    {
+    case BIN_DEC_WAIT_SYNC:
+        if (byte == BIN_PROTO_SYNC)
+        {
+            dec->state = BIN_DEC_WAIT_LEN;
+        }
+        return 0;
+    case BIN_DEC_WAIT_LEN:
+        if (byte < 2 || byte > BIN_PROTO_MAX_BODY)
+        {
+            // 长度非法,重新同步(该字节本身可能是SYNC)
+            dec->state = (byte == BIN_PROTO_SYNC) ? BIN_DEC_WAIT_LEN : BIN_DEC_WAIT_SYNC;
+            return 0;
+        }
+        dec->len = byte;
+        dec->buf[0] = byte;
+        dec->idx = 1;
+        dec->state = BIN_DEC_BODY;
+        return 0;
+    default:
+        dec->buf[dec->idx++] = byte;
+        if (dec->idx < dec->len + 3)
+        {
+            return 0;
+        }
+        dec->state = BIN_DEC_WAIT_SYNC;
+        {
+            uint16_t crc = binProtoCrc16(dec->buf, dec->len + 1);
+            uint16_t rxCrc = dec->buf[dec->len + 1] | ((uint16_t)dec->buf[dec->len + 2] << 8);
+            if (crc != rxCrc)
+            {
+                return -1;
+            }
+        }
+        frame->op = dec->buf[1];
+        frame->seq = dec->buf[2];
+        frame->tlvLen = dec->len - 2;
+        for (uint8_t i = 0; i < frame->tlvLen; i++)
+        {
+            frame->tlv[i] = dec->buf[3 + i];
+        }
+        return 1;
+    }
+}
+
+// 重新解析buf[pendPos, pendEnd)中的字节,写入位置总在读取位置之前,可以原地进行
+// 得到一帧时把剩余字节移到buf开头,留给下一次调用
+static int binDecReplay(BinDecoder *dec, BinFrame *frame)
+{
+    int ret = 0;
+    while (dec->pendPos < dec->pendEnd)
+    {
+        int r = binDecByte(dec, dec->buf[dec->pendPos++], frame);
+        if (r > 0)
+        {
+            dec->pendEnd -= dec->pendPos;
+            memmove(dec->buf, &dec->buf[dec->pendPos], dec->pendEnd);
+            dec->pendPos = 0;
+            return 1;
+        }
+        if (r < 0)
+        {
+            // 又一个假帧头: 它之后的字节是buf[0, idx)加上尚未重放的部分
+            memmove(&dec->buf[dec->idx], &dec->buf[dec->pendPos], dec->pendEnd - dec->pendPos);
+            dec->pendEnd = dec->idx + (dec->pendEnd - dec->pendPos);
+            dec->pendPos = 0;
+            ret = -1;
+        }
+    }
+    dec->pendPos = 0;
+    dec->pendEnd = 0;
+    return ret;
+}
+
+int binProtoFeed(BinDecoder *dec, uint8_t byte, BinFrame *frame)
+{
+    int ret;
+    if (dec->pendPos < dec->pendEnd)
+    {
+        // 重同步得到的帧之后还有未处理的字节,新字节排在它们后面
+        // 每得到一帧至少消耗6字节,每次只追加1字节,不会超出buf
+        if (dec->pendEnd < sizeof(dec->buf))
+        {
+            dec->buf[dec->pendEnd++] = byte;
+        }
+        return binDecReplay(dec, frame);
+    }
+    ret = binDecByte(dec, byte, frame);
+    if (ret >= 0)
+    {
+        return ret;
+    }
+    // CRC错误: SYNC可能是噪声,真正的帧头可能就在已收到的字节中,从LEN之后重新解析
+    dec->pendPos = 0;
+    dec->pendEnd = dec->idx;
+    return binDecReplay(dec, frame) > 0 ? 1 : -1;
+}
+
+uint16_t binProtoEncode(const BinFrame *frame, uint8_t *out, uint16_t outSize)
+{
+    uint8_t len = frame->tlvLen + 2;
+    uint16_t crc;
+    if (outSize < (uint16_t)len + 4 || frame->tlvLen > BIN_PROTO_MAX_TLV)
+    {
+        return 0;
+    }
+    out[0] = BIN_PROTO_SYNC;
+    out[1] = len;
+    out[2] = frame->op;
+    out[3] = frame->seq;
+    for (uint8_t i = 0; i < frame->tlvLen; i++)
+    {
+        out[4 + i] = frame->tlv[i];
+    }
+    crc = binProtoCrc16(&out[1], len + 1);
+    out[len + 2] = (uint8_t)crc;
+    out[len + 3] = (uint8_t)(crc >> 8);
+    return len + 4;
+}
+
+void binFrameInit(BinFrame *frame, uint8_t op, uint8_t seq)
+{
+    frame->op = op;
+    frame->seq = seq;
+    frame->tlvLen = 0;
+}
+
+int binTlvPut(BinFrame *frame, uint8_t tag, uint32_t value, uint8_t size)
+{
+    if (size > 4 || frame->tlvLen + 2 + size > BIN_PROTO_MAX_TLV)
+    {
+        return 0;
+    }
+    frame->tlv[frame->tlvLen++] = tag;
+    frame->tlv[frame->tlvLen++] = size;
+    for (uint8_t i = 0; i < size; i++)
+    {
+        frame->tlv[frame->tlvLen++] = (uint8_t)(value >> (8 * i));
+    }
+    return 1;
+}
+
+int binTlvPutBytes(BinFrame *frame, uint8_t tag, const uint8_t *value, uint8_t len)
+{
+    if (frame->tlvLen + 2 + len > BIN_PROTO_MAX_TLV)
+    {
+        return 0;
+    }
+    frame->tlv[frame->tlvLen++] = tag;
+    frame->tlv[frame->tlvLen++] = len;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        frame->tlv[frame->tlvLen++] = value[i];
+    }
+    return 1;
+}
+
+int binTlvNext(const BinFrame *frame, uint8_t *pos, uint8_t *tag, uint8_t *len, const uint8_t **value)
+{
+    if (*pos >= frame->tlvLen)
+    {
+        return 0;
+    }
+    if (*pos + 2 > frame->tlvLen || *pos + 2 + frame->tlv[*pos + 1] > frame->tlvLen)
+    {
+        return -1;
+    }
+    *tag = frame->tlv[*pos];
+    *len = frame->tlv[*pos + 1];
+    *value = &frame->tlv[*pos + 2];
+    *pos += 2 + *len;
+    return 1;
+}
+
+uint32_t binTlvGetU32(const uint8_t *value, uint8_t len)
+{
+    uint32_t ret = 0;
+    for (uint8_t i = 0; i < len && i < 4; i++)
+    {
+        ret |= (uint32_t)value[i] << (8 * i);
+    }
+    return ret;
+}
@@ -0,0 +1,97 @@
+/*
+ *Binary framed control protocol codec
+ *纯C实现,不依赖HAL,主机端可直接编译使用
+ *
+ *帧格式: SYNC | LEN | OP | SEQ | TLV ... | CRC16(低字节在前)
+ *  LEN   : OP 到 TLV 结束的字节数
+ *  CRC16 : CCITT-FALSE(0x1021, 初值0xFFFF), 覆盖 LEN 到 TLV 结束
+ *  TLV   : TAG | L | VALUE, 整数按小端存放,频率为整数Hz
+ *应答: OP | 0x80, SEQ 原样返回, 第一个TLV为状态 BIN_TAG_STATUS
+ */
+#ifndef __BIN_PROTO_H__
+#define __BIN_PROTO_H__
+#include <stdint.h>
+
+#define BIN_PROTO_SYNC 0xA5
+#define BIN_PROTO_MAX_BODY 48                             // OP+SEQ+TLV 最大长度
+#define BIN_PROTO_MAX_FRAME (2 + BIN_PROTO_MAX_BODY + 2) // SYNC LEN ... CRC16
+#define BIN_PROTO_MAX_TLV (BIN_PROTO_MAX_BODY - 2)
+
+// 操作码
+#define BIN_OP_GET 0x01  // TLV的L为0,应答中携带数值
+#define BIN_OP_SET 0x02  // 所有TLV整体校验通过后一次性生效
+#define BIN_OP_EXIT 0x0F // 退出二进制模式,回到AT文本
+#define BIN_OP_TELEMETRY 0x40 // 模块主动上报的遥测(AT+STREAM),SEQ为上报计数,无需应答
+#define BIN_OP_EVENT 0x41     // 模块主动上报的静噪/PTT事件(AT+EVENTS=ON),SEQ为事件序号低8位
+#define BIN_OP_SCAN 0x42      // 模块主动上报的扫描结果(AT+SCAN),SEQ为结果序号低8位
+#define BIN_OP_REPLY 0x80
+
+// TAG,对应SHARECom字段
+#define BIN_TAG_STATUS 0x00   // u8 BIN_STATUS_xx
+#define BIN_TAG_SQL 0x01      // u8 0~10
+#define BIN_TAG_TXFREQ 0x02   // u32 Hz
+#define BIN_TAG_RXFREQ 0x03   // u32 Hz
+#define BIN_TAG_RXVOL 0x04    // u8 0~10
+#define BIN_TAG_TXVOL 0x05    // u8 0~10
+#define BIN_TAG_TXPWR 0x06    // u8 0 low 1 mid 2 high
+#define BIN_TAG_FREQTUNE 0x07 // i32 Hz
+#define BIN_TAG_RF 0x08       // u8 0 disable 1 enable
+#define BIN_TAG_SMETER 0x09   // u8 只读
+#define BIN_TAG_BANDCAP 0x0A  // u16 只读
+#define BIN_TAG_TELEMETRY 0x10 // 8字节: rssi snr smeter sqlOpen ptt ifGain afc errFlags
+#define BIN_TAG_EVENT 0x11     // u16: 低字节类型('S'/'P'),高字节新状态
+#define BIN_TAG_EVENT_US 0x12  // u32 micros()时间戳
+#define BIN_TAG_SCAN 0x13       // u32: 类型('H'/'W') | 信道序号<<8 | rssi<<16 | snr<<24
+#define BIN_TAG_SCAN_VALUE 0x14 // u32 'H'为频率Hz,'W'为信道/秒
+
+// 状态
+#define BIN_STATUS_OK 0
+#define BIN_STATUS_BAD_TAG 1   // 未知TAG或长度不符
+#define BIN_STATUS_BAD_VALUE 2 // 数值超出范围
+#define BIN_STATUS_READONLY 3  // 只读字段
+#define BIN_STATUS_BAD_OP 4    // 未知操作码
+#define BIN_STATUS_OVERFLOW 5  // 应答超长
+
+typedef struct
+{
+    uint8_t op;
+    uint8_t seq;
+    uint8_t tlvLen;                  // tlv中有效字节数
+    uint8_t tlv[BIN_PROTO_MAX_TLV];
+} BinFrame;
+
+typedef struct
+{
+    uint8_t state;
+    uint8_t len; // 期望的 LEN
+    uint8_t idx; // buf中已接收字节数
+    uint8_t pendPos; // CRC错误后待重新解析的字节 buf[pendPos, pendEnd)
+    uint8_t pendEnd;
+    uint8_t buf[BIN_PROTO_MAX_BODY + 3]; // LEN + body + CRC16
+} BinDecoder;
+
+uint16_t binProtoCrc16(const uint8_t *data, uint16_t len);
+
+void binProtoDecoderInit(BinDecoder *dec);
+
+// 逐字节输入,返回 1 得到完整帧, -1 CRC错误, 0 未完成
+// CRC错误时从已收到字节中的下一个SYNC重新同步,其中的完整帧照常返回
+int binProtoFeed(BinDecoder *dec, uint8_t byte, BinFrame *frame);
+
+// 编码为线路字节,返回总长度,缓冲区不足返回0
+uint16_t binProtoEncode(const BinFrame *frame, uint8_t *out, uint16_t outSize);
+
+void binFrameInit(BinFrame *frame, uint8_t op, uint8_t seq);
+
+// 追加TLV,数值按小端写入size字节,空间不足返回0
+int binTlvPut(BinFrame *frame, uint8_t tag, uint32_t value, uint8_t size);
+
+// 追加原始字节TLV,空间不足返回0
+int binTlvPutBytes(BinFrame *frame, uint8_t tag, const uint8_t *value, uint8_t len);
+
+// 遍历TLV,*pos从0开始,返回1得到一项,0结束,-1格式错误
+int binTlvNext(const BinFrame *frame, uint8_t *pos, uint8_t *tag, uint8_t *len, const uint8_t **value);
+
+// 小端读取len字节(1~4)
+uint32_t binTlvGetU32(const uint8_t *value, uint8_t len);
+#endif
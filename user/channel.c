@@ -0,0 +1,70 @@
+#include "channel.h"
+#include "BK4802.h"
+#include "binProto.h"
+#undef LOG_TAG
+#define LOG_TAG "CH"
+
+#define CHANNEL_CRC_LEN (offsetof(ChannelEntry, crc))
+
+const ChannelEntry *channelGet(uint8_t index)
+{
+    const ChannelEntry *entry;
+    if (index >= CHANNEL_NUM)
+    {
+        return NULL;
+    }
+    entry = (const ChannelEntry *)(CHANNEL_BASE + index * FLASH_PAGE_SIZE);
+    if (binProtoCrc16((const uint8_t *)entry, CHANNEL_CRC_LEN) != entry->crc)
+    {
+        return NULL; // 擦除后为全0xFF,CRC不匹配
+    }
+    return entry;
+}
+
+xBool channelSave(uint8_t index, ChannelEntry *entry)
+{
+    uint32_t pageData[FLASH_PAGE_SIZE / 4];
+    uint32_t addr = CHANNEL_BASE + index * FLASH_PAGE_SIZE;
+    uint32_t pageError = 0;
+    FLASH_EraseInitTypeDef eraseInit = {0};
+    HAL_StatusTypeDef status;
+    if (index >= CHANNEL_NUM ||
+        BK4802CalcPllRegs(entry->txHz, entry->offsetHz, xTrue, entry->txRegs) == xFalse ||
+        BK4802CalcPllRegs(entry->rxHz, entry->offsetHz, xFalse, entry->rxRegs) == xFalse)
+    {
+        return xFalse;
+    }
+    entry->crc = binProtoCrc16((const uint8_t *)entry, CHANNEL_CRC_LEN);
+    memset(pageData, 0xFF, sizeof(pageData));
+    memcpy(pageData, entry, sizeof(ChannelEntry));
+    eraseInit.TypeErase = FLASH_TYPEERASE_PAGEERASE;
+    eraseInit.PageAddress = addr;
+    eraseInit.NbPages = 1;
+    HAL_FLASH_Unlock();
+    status = HAL_FLASH_Erase(&eraseInit, &pageError);
+    if (status == HAL_OK)
+    {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_PAGE, addr, pageData);
+    }
+    HAL_FLASH_Lock();
+    if (status != HAL_OK || channelGet(index) == NULL)
+    {
+        log_e("save channel %d failed", index);
+        return xFalse;
+    }
+    log_i("channel %d saved tx:%lu rx:%lu", index, (unsigned long)entry->txHz, (unsigned long)entry->rxHz);
+    return xTrue;
+}
+
+uint32_t channelUsedMask(void)
+{
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < CHANNEL_NUM; i++)
+    {
+        if (channelGet(i) != NULL)
+        {
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
+}
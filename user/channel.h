@@ -0,0 +1,39 @@
+#ifndef __CHANNEL_H__
+#define __CHANNEL_H__
+/*
+ * 信道存储
+ * 每个信道占Flash一页,位于settings页区之前;信道内保存按存储时频偏计算好的PLL寄存器,
+ * 调出时直接放入BK4802的PLL缓存,不再做频率校验和浮点换算
+ */
+#include "components.h"
+#include "settings.h"
+
+#define CHANNEL_NUM 8
+#define CHANNEL_NAME_LEN 8 // 不足时补0,满长时无结束符
+#define CHANNEL_BASE (SETTINGS_BASE - CHANNEL_NUM * FLASH_PAGE_SIZE) // 链接脚本中已预留
+#define CHANNEL_NONE 0xFF
+
+typedef struct
+{
+    uint32_t txHz;
+    uint32_t rxHz;
+    int32_t offsetHz;   // 计算PLL寄存器时的频偏
+    uint16_t txRegs[3]; // reg0 reg1 reg2
+    uint16_t rxRegs[3];
+    float tCTCSS;
+    float rCTCSS;
+    uint8_t sql;
+    uint8_t txPwr;
+    char name[CHANNEL_NAME_LEN];
+    uint16_t crc; // binProtoCrc16,覆盖之前的全部字段
+} ChannelEntry;
+
+// 返回Flash中的信道,空或校验失败返回NULL
+const ChannelEntry *channelGet(uint8_t index);
+
+// 计算PLL寄存器后写入Flash(阻塞擦写一页),频率超出范围或写入失败返回xFalse
+xBool channelSave(uint8_t index, ChannelEntry *entry);
+
+// bit n: 信道n有效
+uint32_t channelUsedMask(void);
+#endif
@@ -0,0 +1,101 @@
+#include "cpuLoad.h"
+#undef LOG_TAG
+#define LOG_TAG "LOAD"
+
+#define CPU_LOAD_WINDOW 1000 // ms
+#define CPU_LOAD_WINDOWS 10  // 长窗口包含的1s窗口数
+
+static volatile uint32_t isrCycles[E_CPU_LOAD_ISR_MAX]; // 当前窗口内累计周期
+static volatile uint32_t isrMaxCycles = 0;
+
+static uint32_t windowStart = 0;
+static uint32_t windowIdleMs = 0;
+static uint16_t windowIdle[CPU_LOAD_WINDOWS]; // 每个1s窗口的空闲ms
+static uint16_t windowLen[CPU_LOAD_WINDOWS];  // 每个1s窗口的实际长度ms
+static uint32_t windowBusyMax[CPU_LOAD_WINDOWS];
+static uint8_t windowIdx = 0;
+static CpuLoadStats loadStats;
+
+void cpuLoadIsrAdd(CpuLoadIsr isr, uint32_t startVal)
+{
+    uint32_t endVal = SysTick->VAL;
+    // SysTick向下计数,期间最多回绕一次
+    uint32_t cycles = startVal >= endVal ? startVal - endVal : startVal + SysTick->LOAD + 1 - endVal;
+    isrCycles[isr] += cycles;
+    if (cycles > isrMaxCycles)
+    {
+        isrMaxCycles = cycles;
+    }
+}
+
+static uint16_t cpuLoadPermille(uint32_t idleMs, uint32_t lenMs)
+{
+    if (lenMs == 0 || idleMs >= lenMs)
+    {
+        return 0;
+    }
+    return (uint16_t)(1000 - idleMs * 1000 / lenMs);
+}
+
+void cpuLoadTask(void)
+{
+    uint32_t now = millis();
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+    uint32_t wakes, idleMs, lenMs;
+    uint32_t idleSum = 0, lenSum = 0, busyMax = 0;
+    uint32_t cycles[E_CPU_LOAD_ISR_MAX];
+
+    if (now - windowStart < CPU_LOAD_WINDOW)
+    {
+        return;
+    }
+    lenMs = now - windowStart;
+    windowStart = now;
+    SCH_Get_Idle_Stats(&wakes, &idleMs);
+
+    __disable_irq();
+    for (int i = 0; i < E_CPU_LOAD_ISR_MAX; i++)
+    {
+        cycles[i] = isrCycles[i];
+        isrCycles[i] = 0;
+    }
+    __enable_irq();
+
+    windowIdle[windowIdx] = (uint16_t)(idleMs - windowIdleMs);
+    windowLen[windowIdx] = (uint16_t)(lenMs > 0xFFFF ? 0xFFFF : lenMs);
+    windowBusyMax[windowIdx] = SCH_Take_Busy_Max_us();
+    windowIdleMs = idleMs;
+
+    loadStats.load1s = cpuLoadPermille(windowIdle[windowIdx], windowLen[windowIdx]);
+    for (int i = 0; i < CPU_LOAD_WINDOWS; i++)
+    {
+        idleSum += windowIdle[i];
+        lenSum += windowLen[i];
+        if (windowBusyMax[i] > busyMax)
+        {
+            busyMax = windowBusyMax[i];
+        }
+    }
+    loadStats.load10s = cpuLoadPermille(idleSum, lenSum);
+    loadStats.busyMaxUs = busyMax;
+    for (int i = 0; i < E_CPU_LOAD_ISR_MAX; i++)
+    {
+        loadStats.isrUs[i] = cycles[i] / cyclesPerUs;
+    }
+    loadStats.isrMaxUs = isrMaxCycles / cyclesPerUs;
+
+    windowIdx = (windowIdx + 1) % CPU_LOAD_WINDOWS;
+    if (windowIdx == 0)
+    {
+        log_i("load 1s:%d.%d%% 10s:%d.%d%% busy max:%luus isr us/s usart:%lu tim16:%lu systick:%lu max:%lu",
+              loadStats.load1s / 10, loadStats.load1s % 10, loadStats.load10s / 10, loadStats.load10s % 10,
+              (unsigned long)loadStats.busyMaxUs, (unsigned long)loadStats.isrUs[E_CPU_LOAD_ISR_USART2],
+              (unsigned long)loadStats.isrUs[E_CPU_LOAD_ISR_TIM16], (unsigned long)loadStats.isrUs[E_CPU_LOAD_ISR_SYSTICK],
+              (unsigned long)loadStats.isrMaxUs);
+    }
+}
+
+void cpuLoadGet(CpuLoadStats *stats)
+{
+    *stats = loadStats;
+}
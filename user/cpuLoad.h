@@ -0,0 +1,35 @@
+#ifndef __CPU_LOAD_H__
+#define __CPU_LOAD_H__
+/*
+ * CPU负载统计
+ * 空闲时间来自调度器休眠统计(SCH_Get_Idle_Stats),按1s窗口采样,10s窗口取最近10个采样
+ * 中断耗时用SysTick->VAL按内核周期计,单次中断需小于1ms(SysTick周期)
+ */
+#include "components.h"
+#include "py32f0xx.h"
+
+typedef enum
+{
+    E_CPU_LOAD_ISR_USART2,
+    E_CPU_LOAD_ISR_TIM16,
+    E_CPU_LOAD_ISR_SYSTICK,
+    E_CPU_LOAD_ISR_MAX,
+} CpuLoadIsr;
+
+typedef struct
+{
+    uint16_t load1s;                     // 最近1s负载, 0.1%
+    uint16_t load10s;                    // 最近10s负载, 0.1%
+    uint32_t busyMaxUs;                  // 最近10s调度器最长连续运行时间
+    uint32_t isrUs[E_CPU_LOAD_ISR_MAX];  // 最近1s各中断累计耗时
+    uint32_t isrMaxUs;                   // 单次中断最长耗时(上电以来)
+} CpuLoadStats;
+
+// 放在中断处理函数首尾,被更高优先级中断抢占的时间也计入
+#define CPU_LOAD_ISR_BEGIN() uint32_t cpuLoadIsrStart = SysTick->VAL
+#define CPU_LOAD_ISR_END(isr) cpuLoadIsrAdd(isr, cpuLoadIsrStart)
+void cpuLoadIsrAdd(CpuLoadIsr isr, uint32_t startVal);
+
+void cpuLoadTask(void); // put in a 100ms loop task, logs every 10s
+void cpuLoadGet(CpuLoadStats *stats);
+#endif
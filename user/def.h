@@ -5,4 +5,10 @@
 #define VOL_ADJ_TEST 1 // 音量调节测试
 #define DBUG_FUNCTION ANTENNA_TEST // 选择跳线功能测试
 
+#define BK4802_BUS_SOFT_I2C 0 // 软件IIC,逐位翻转GPIO
+#define BK4802_BUS_HW_I2C 1   // 硬件I2C外设,中断完成
+#define BK4802_BUS_SOFT_I2C_FAST 2 // 软件IIC,开漏+直接寄存器访问
+#define BK4802_BUS BK4802_BUS_SOFT_I2C // 选择BK4802总线驱动
+#define BK4802_HW_I2C_USE_DMA 0 // 硬件I2C时使用DMA搬运数据
+
 #endif
\ No newline at end of file
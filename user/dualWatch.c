@@ -0,0 +1,259 @@
+#include "dualWatch.h"
+#include "BK4802.h"
+#include "radio.h"
+#include "scan.h"
+#include "osTimer.h"
+#undef LOG_TAG
+#define LOG_TAG "WATCH"
+
+typedef enum
+{
+    E_WATCH_MAIN,     // 在主频率,等待下一次跳频
+    E_WATCH_CAL,      // 在优先信道,标定稳定时间
+    E_WATCH_SAMPLE,   // 在优先信道,稳定时间已到,采样
+    E_WATCH_BACK,     // 已跳回主频率,等待稳定
+    E_WATCH_PRIORITY, // 已切换到优先信道
+} WatchState;
+
+static WatchState watchState = E_WATCH_MAIN;
+static uint8_t watchStepId = SCH_MAX_TASKS; // 跳频任务,watchInit创建,每步按需重新设定延时
+static uint16_t watchPeriodMs = 0;
+static uint32_t watchHz = 0;
+static ScanCal watchCal;
+static uint32_t watchQuietMs = 0; // 优先信道静噪最后一次打开的时刻
+
+// 统计: 盲区按us累计,满1ms进位,避免长时间运行溢出
+static uint32_t watchHops = 0;
+static uint32_t watchSwitches = 0;
+static uint32_t watchHopStartUs = 0;
+static uint32_t watchHopUs = 0;
+static uint32_t watchBlindMs = 0;
+static uint32_t watchBlindUs = 0;
+static uint32_t watchStartMs = 0;
+static uint32_t watchEndMs = 0; // 停止时刻,停止后统计保持不变
+static uint32_t watchPriorityMs = 0; // 停在优先信道的总时间,不计入主频率监听时间
+static uint32_t watchPriorityStartMs = 0;
+
+static void watchStep(void);
+static void watchSchedule(uint16_t ticks)
+{
+    if (SCH_Arm_Task(watchStepId, ticks) != RETURN_NORMAL)
+    {
+        log_w("watch step not scheduled, stop");
+        watchStop(xTrue);
+    }
+}
+
+uint8_t watchInit(void)
+{
+    watchStepId = SCH_Add_Event_Task(watchStep);
+    return watchStepId;
+}
+
+// 盲区结束: 已回到主频率
+static void watchBlindEnd(void)
+{
+    watchHopUs = micros() - watchHopStartUs;
+    watchBlindUs += watchHopUs;
+    watchBlindMs += watchBlindUs / 1000;
+    watchBlindUs %= 1000;
+}
+
+static void watchBackToMain(void)
+{
+    uint32_t mainHz = radioGetRxHz();
+    if (BK4802RetuneRxHz(mainHz) == xFalse)
+    {
+        // 主频率无法快速重调谐,走完整加载路径
+        watchBlindEnd();
+        radioSetRxSuspend(xFalse, xTrue);
+        watchState = E_WATCH_MAIN;
+        watchSchedule(osTimerMsToTicks(watchPeriodMs));
+        return;
+    }
+    watchState = E_WATCH_BACK;
+    watchSchedule(scanGetSettleTicks(BK4802BandIndex(mainHz)));
+}
+
+static void watchEvaluate(uint8_t rssi, uint8_t snr)
+{
+    watchHops++;
+    if (BK4802RxDetect(rssi, snr, xFalse) == xFalse)
+    {
+        watchBackToMain();
+        return;
+    }
+    watchBlindEnd();
+    watchSwitches++;
+    log_i("priority active rssi:%d snr:%d", rssi, snr);
+    watchState = E_WATCH_PRIORITY;
+    watchQuietMs = millis();
+    watchPriorityStartMs = millis();
+    radioSetRxSuspend(xFalse, xFalse); // 保持优先信道,静噪和音频由radioTask处理
+    watchSchedule(osTimerMsToTicks(WATCH_POLL_MS));
+}
+
+static void watchStep(void)
+{
+    uint8_t rssi;
+    uint8_t band;
+    switch (watchState)
+    {
+    case E_WATCH_MAIN:
+        if (radioIsRxIdle() == xFalse || radioIsSqlOpen())
+        {
+            watchSchedule(osTimerMsToTicks(watchPeriodMs)); // 不打断发射和主频率上的接收
+            break;
+        }
+        watchHopStartUs = micros();
+        radioSetRxSuspend(xTrue, xFalse);
+        if (BK4802RetuneRxHz(watchHz) == xFalse)
+        {
+            radioSetRxSuspend(xFalse, xTrue);
+            watchSchedule(osTimerMsToTicks(watchPeriodMs));
+            break;
+        }
+        band = BK4802BandIndex(watchHz);
+        if (scanIsCalibrated(band) == xFalse)
+        {
+            watchState = E_WATCH_CAL;
+            scanCalBegin(&watchCal, band);
+            watchSchedule(1);
+        }
+        else
+        {
+            watchState = E_WATCH_SAMPLE;
+            watchSchedule(scanGetSettleTicks(band));
+        }
+        break;
+    case E_WATCH_CAL:
+        BK4802StatusInvalidate();
+        rssi = BK4802RSSIRead();
+        if (scanCalStep(&watchCal, rssi))
+        {
+            watchEvaluate(rssi, BK4802SNRRead());
+            break;
+        }
+        watchSchedule(1);
+        break;
+    case E_WATCH_SAMPLE:
+        BK4802StatusInvalidate(); // 等待期间其他任务可能读过旧频率的快照
+        rssi = BK4802RSSIRead();  // RSSI/SNR来自同一次reg24读取
+        watchEvaluate(rssi, BK4802SNRRead());
+        break;
+    case E_WATCH_BACK:
+        watchBlindEnd();
+        watchState = E_WATCH_MAIN;
+        radioSetRxSuspend(xFalse, xFalse);
+        watchSchedule(osTimerMsToTicks(watchPeriodMs));
+        break;
+    case E_WATCH_PRIORITY:
+        if (radioIsSqlOpen())
+        {
+            watchQuietMs = millis();
+        }
+        else if (millis() - watchQuietMs >= WATCH_RESUME_MS)
+        {
+            log_i("back to main");
+            watchPriorityMs += millis() - watchPriorityStartMs;
+            watchState = E_WATCH_MAIN;
+            radioSetRxSuspend(xFalse, xTrue); // 完整加载主频率,此时不计盲区
+            watchSchedule(osTimerMsToTicks(watchPeriodMs));
+            break;
+        }
+        watchSchedule(osTimerMsToTicks(WATCH_POLL_MS));
+        break;
+    default:
+        break;
+    }
+}
+
+xBool watchStart(uint32_t priorityHz, uint16_t periodMs)
+{
+    watchStop(xTrue);
+    if (periodMs < WATCH_MIN_PERIOD_MS || periodMs > WATCH_MAX_PERIOD_MS ||
+        BK4802BandIndex(priorityHz) >= BK4802_BAND_NUM)
+    {
+        return xFalse;
+    }
+    watchHz = priorityHz;
+    watchPeriodMs = periodMs;
+    watchHops = 0;
+    watchSwitches = 0;
+    watchHopUs = 0;
+    watchBlindMs = 0;
+    watchBlindUs = 0;
+    watchPriorityMs = 0;
+    watchStartMs = millis();
+    watchState = E_WATCH_MAIN;
+    log_i("watch %lu Hz every %d ms", (unsigned long)priorityHz, periodMs);
+    watchSchedule(osTimerMsToTicks(periodMs));
+    return xTrue;
+}
+
+// 取消进行中的跳频/切换,之后由调用者决定接收频率
+static void watchAbort(void)
+{
+    SCH_Disarm_Task(watchStepId);
+    if (watchState == E_WATCH_CAL || watchState == E_WATCH_SAMPLE || watchState == E_WATCH_BACK)
+    {
+        watchBlindEnd();
+    }
+    else if (watchState == E_WATCH_PRIORITY)
+    {
+        watchPriorityMs += millis() - watchPriorityStartMs;
+    }
+    watchState = E_WATCH_MAIN;
+}
+
+void watchStop(xBool retune)
+{
+    if (watchPeriodMs == 0)
+    {
+        return;
+    }
+    watchAbort();
+    watchPeriodMs = 0;
+    watchEndMs = millis();
+    radioSetRxSuspend(xFalse, retune); // 回到主接收频率
+    log_i("watch stop after %lu hops", (unsigned long)watchHops);
+}
+
+void watchCancel(void)
+{
+    if (watchPeriodMs == 0)
+    {
+        return;
+    }
+    watchAbort();
+    radioSetRxSuspend(xFalse, xFalse); // 发射寄存器由收发状态机加载
+    watchSchedule(osTimerMsToTicks(watchPeriodMs));
+}
+
+void watchGetStatus(WatchStatus *status)
+{
+    uint32_t nowMs = watchPeriodMs ? millis() : watchEndMs;
+    uint32_t monitorMs = nowMs - watchStartMs - watchPriorityMs;
+    if (watchPeriodMs && watchState == E_WATCH_PRIORITY)
+    {
+        monitorMs -= millis() - watchPriorityStartMs;
+    }
+    status->periodMs = watchPeriodMs;
+    status->priorityHz = watchHz;
+    status->hops = watchHops;
+    status->switches = watchSwitches;
+    status->hopUs = watchHopUs;
+    status->blind = monitorMs ? (uint32_t)(((uint64_t)watchBlindMs * 1000 + watchBlindUs) * 10 / monitorMs) : 0; // us*10/ms即0.01%,整数运算
+    if (watchPeriodMs == 0)
+    {
+        status->state = WATCH_STATE_MAIN;
+    }
+    else if (watchState == E_WATCH_PRIORITY)
+    {
+        status->state = WATCH_STATE_PRIORITY;
+    }
+    else
+    {
+        status->state = watchState == E_WATCH_MAIN ? WATCH_STATE_MAIN : WATCH_STATE_HOP;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef __DUAL_WATCH_H__
+#define __DUAL_WATCH_H__
+/*
+ * 双守候(优先信道监听)
+ * 每隔periodMs: 只写频率寄存器跳到优先信道 -> 等待该频段的PLL稳定时间 -> 读一次reg24 RSSI/SNR
+ *  -> 无信号: 跳回主接收频率,等待稳定后交还radioTask
+ *  -> 有信号: 切换到优先信道,由radioTask的静噪逻辑接收,静噪关闭WATCH_RESUME_MS后回到主频率
+ * 主频率静噪打开或收发切换/发射期间不跳频
+ * 稳定时间与扫描共用按频段标定的结果(scanCalStep),盲区时间从离开主频率到回到主频率并稳定为止
+ */
+#include "components.h"
+
+#define WATCH_MIN_PERIOD_MS 100
+#define WATCH_MAX_PERIOD_MS 60000
+#define WATCH_POLL_MS 100
+#define WATCH_RESUME_MS 2000
+
+#define WATCH_STATE_MAIN 0     // 在主频率
+#define WATCH_STATE_HOP 1      // 跳频采样中
+#define WATCH_STATE_PRIORITY 2 // 已切换到优先信道
+
+typedef struct
+{
+    uint16_t periodMs; // 0: 关闭
+    uint8_t state;     // WATCH_STATE_xx
+    uint32_t priorityHz;
+    uint32_t hops;     // 采样次数
+    uint32_t switches; // 切换到优先信道次数
+    uint32_t blind;    // 主频率盲区时间占比,单位0.01%
+    uint32_t hopUs;    // 最近一次盲区时间
+} WatchStatus;
+
+// 创建跳频任务,返回任务序号(SCH_MAX_TASKS: 失败)
+uint8_t watchInit(void);
+// 返回xFalse: 参数无效或优先信道超出范围
+xBool watchStart(uint32_t priorityHz, uint16_t periodMs);
+// retune=xFalse: 不重调谐,用于随后由调用者加载寄存器的场合(如开始扫描)
+void watchStop(xBool retune);
+// 发射前调用: 取消进行中的跳频/切换,发射结束后由收发状态机回到主频率
+void watchCancel(void);
+void watchGetStatus(WatchStatus *status);
+#endif
@@ -0,0 +1,223 @@
+/*
+ *Flash key/value store
+ */
+#include "kvStore.h"
+#include "binProto.h"
+#include <string.h>
+
+#define KV_STORE_CRC_POS (KV_STORE_PAGE_SIZE - 2)
+
+static const KvStorePort *kvPort = NULL;
+static uint32_t kvPage[KV_STORE_PAGE_SIZE / 4]; // 内存中的当前页,按字对齐供整页编程
+static uint8_t *const kvBuf = (uint8_t *)kvPage;
+static uint8_t *const kvData = (uint8_t *)kvPage + KV_STORE_HEAD_SIZE;
+static KvStoreStats kvStats;
+static uint8_t kvDirty = 0;
+static uint32_t kvChanges = 0;
+
+static const uint8_t *kvPageAddr(uint16_t page)
+{
+    return kvPort->base + (uint32_t)page * KV_STORE_PAGE_SIZE;
+}
+
+static uint32_t kvPageSeq(const uint8_t *p)
+{
+    return p[4] | ((uint32_t)p[5] << 8) | ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24);
+}
+
+static int kvPageHeadValid(const uint8_t *p)
+{
+    return (p[0] | (p[1] << 8)) == KV_STORE_MAGIC && p[2] <= KV_STORE_DATA_SIZE;
+}
+
+static int kvPageCrcValid(const uint8_t *p)
+{
+    uint16_t crc = p[KV_STORE_CRC_POS] | (p[KV_STORE_CRC_POS + 1] << 8);
+    return binProtoCrc16(p, KV_STORE_CRC_POS) == crc;
+}
+
+static int kvPageBlank(const uint8_t *p)
+{
+    const uint32_t *w = (const uint32_t *)p;
+    for (uint8_t i = 0; i < KV_STORE_PAGE_SIZE / 4; i++)
+    {
+        if (w[i] != 0xFFFFFFFF)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 在记录区查找key,返回记录起始位置,不存在返回-1
+static int kvFind(uint8_t key)
+{
+    uint8_t pos = 0;
+    while (pos + 2 <= kvStats.used)
+    {
+        if (kvData[pos] == key)
+        {
+            return pos;
+        }
+        pos += 2 + kvData[pos + 1];
+    }
+    return -1;
+}
+
+static void kvPageReset(void)
+{
+    memset(kvPage, 0xFF, sizeof(kvPage));
+    kvStats.used = 0;
+}
+
+int kvStoreInit(const KvStorePort *port)
+{
+    uint32_t limit = 0xFFFFFFFF;
+    kvPort = port;
+    memset(&kvStats, 0, sizeof(kvStats));
+    kvStats.page = port->pages;
+    kvDirty = 0;
+    kvPageReset();
+    // 按序号从大到小找第一个CRC正确的页,通常只需校验一页
+    while (1)
+    {
+        uint16_t best = port->pages;
+        uint32_t bestSeq = 0;
+        for (uint16_t i = 0; i < port->pages; i++)
+        {
+            const uint8_t *p = kvPageAddr(i);
+            uint32_t seq = kvPageSeq(p);
+            if (kvPageHeadValid(p) && seq < limit && (best == port->pages || seq > bestSeq))
+            {
+                best = i;
+                bestSeq = seq;
+            }
+        }
+        if (best == port->pages)
+        {
+            return 0;
+        }
+        if (kvPageCrcValid(kvPageAddr(best)))
+        {
+            memcpy(kvPage, kvPageAddr(best), KV_STORE_PAGE_SIZE);
+            kvStats.page = best;
+            kvStats.seq = bestSeq;
+            kvStats.used = kvBuf[2];
+            return 1;
+        }
+        limit = bestSeq; // 写入中途掉电的页
+    }
+}
+
+int kvStoreGet(uint8_t key, void *value, uint8_t len)
+{
+    int pos = kvFind(key);
+    if (pos < 0 || kvData[pos + 1] != len)
+    {
+        return 0;
+    }
+    memcpy(value, &kvData[pos + 2], len);
+    return 1;
+}
+
+int kvStoreSet(uint8_t key, const void *value, uint8_t len)
+{
+    int pos = kvFind(key);
+    if (key == KV_STORE_KEY_END)
+    {
+        return 0;
+    }
+    if (pos >= 0 && kvData[pos + 1] == len)
+    {
+        if (memcmp(&kvData[pos + 2], value, len) == 0)
+        {
+            return 1;
+        }
+        memcpy(&kvData[pos + 2], value, len);
+    }
+    else
+    {
+        uint8_t size = pos >= 0 ? 2 + kvData[pos + 1] : 0;
+        // 先检查空间,空间不足时旧记录保持不变
+        if (kvStats.used - size + 2 + len > KV_STORE_DATA_SIZE)
+        {
+            return 0;
+        }
+        if (pos >= 0)
+        {
+            // 长度变化,删除旧记录后追加
+            memmove(&kvData[pos], &kvData[pos + size], kvStats.used - pos - size);
+            kvStats.used -= size;
+            memset(&kvData[kvStats.used], 0xFF, size);
+        }
+        kvData[kvStats.used] = key;
+        kvData[kvStats.used + 1] = len;
+        memcpy(&kvData[kvStats.used + 2], value, len);
+        kvStats.used += 2 + len;
+    }
+    kvDirty = 1;
+    kvChanges++;
+    return 1;
+}
+
+int kvStoreIsDirty(void)
+{
+    return kvDirty;
+}
+
+uint32_t kvStoreChanges(void)
+{
+    return kvChanges;
+}
+
+int kvStoreFlush(void)
+{
+    uint16_t page = kvStats.page;
+    uint32_t seq = kvStats.seq + 1;
+    uint16_t crc;
+    if (kvPort == NULL)
+    {
+        return -1;
+    }
+    if (!kvDirty)
+    {
+        return 0;
+    }
+    kvBuf[0] = (uint8_t)KV_STORE_MAGIC;
+    kvBuf[1] = (uint8_t)(KV_STORE_MAGIC >> 8);
+    kvBuf[2] = kvStats.used;
+    kvBuf[3] = 0xFF;
+    kvBuf[4] = (uint8_t)seq;
+    kvBuf[5] = (uint8_t)(seq >> 8);
+    kvBuf[6] = (uint8_t)(seq >> 16);
+    kvBuf[7] = (uint8_t)(seq >> 24);
+    crc = binProtoCrc16(kvBuf, KV_STORE_CRC_POS);
+    kvBuf[KV_STORE_CRC_POS] = (uint8_t)crc;
+    kvBuf[KV_STORE_CRC_POS + 1] = (uint8_t)(crc >> 8);
+    // 总是写最旧的一页,各页轮流擦写;校验失败的页跳过,但不能覆盖当前有效页
+    for (uint8_t retry = 0; retry <= KV_STORE_WRITE_RETRY; retry++)
+    {
+        page = (page + 1 >= kvPort->pages) ? 0 : page + 1;
+        if (page == kvStats.page)
+        {
+            break;
+        }
+        if ((kvPageBlank(kvPageAddr(page)) || kvPort->erase(page) == 0) &&
+            kvPort->program(page, kvPage) == 0 &&
+            memcmp(kvPageAddr(page), kvPage, KV_STORE_PAGE_SIZE) == 0)
+        {
+            kvStats.page = page;
+            kvStats.seq = seq;
+            kvStats.writes++;
+            kvDirty = 0;
+            return 0;
+        }
+        kvStats.failures++;
+    }
+    return -1;
+}
+
+void kvStoreGetStats(KvStoreStats *stats)
+{
+    *stats = kvStats;
+}
@@ -0,0 +1,60 @@
+/*
+ *Flash key/value store
+ *纯C实现,不依赖HAL,Flash操作经端口函数完成,主机端可直接编译使用
+ *
+ *PY32F030只能整页(128字节)编程,所以每次写入把全部键值打包成一页,
+ *按序号追加到环形页区中的下一页:
+ *  页格式: MAGIC(u16) | LEN(u8) | 保留(u8) | SEQ(u32) | 记录 ... | CRC16(低字节在前)
+ *  记录  : KEY | L | VALUE, KEY为0xFF表示结束
+ *  CRC16 : 同binProtoCrc16, 覆盖页首到记录区结束
+ *启动时取CRC正确且SEQ最大的一页;写入总是落在最旧的一页,
+ *最新的有效页在新页写完之前不会被擦除,写入中途掉电最多丢失这一次改动
+ */
+#ifndef __KV_STORE_H__
+#define __KV_STORE_H__
+#include <stdint.h>
+
+#define KV_STORE_PAGE_SIZE 128
+#define KV_STORE_MAGIC 0x4B56 // "KV"
+#define KV_STORE_HEAD_SIZE 8
+#define KV_STORE_DATA_SIZE (KV_STORE_PAGE_SIZE - KV_STORE_HEAD_SIZE - 2)
+#define KV_STORE_KEY_END 0xFF
+#define KV_STORE_WRITE_RETRY 2 // 校验失败时换到下一页重写的次数
+
+typedef struct
+{
+    const uint8_t *base; // 页区起始地址(内存映射读取)
+    uint16_t pages;      // 页数,至少2页
+    int (*erase)(uint16_t page);                       // 擦除一页,成功返回0
+    int (*program)(uint16_t page, const uint32_t *data); // 编程一整页,成功返回0
+} KvStorePort;
+
+typedef struct
+{
+    uint32_t seq;      // 最新有效页的序号
+    uint16_t page;     // 最新有效页,无有效页时为pages
+    uint16_t writes;   // 上电以来写入的页数
+    uint16_t failures; // 写入失败/校验失败次数
+    uint8_t used;      // 记录区已用字节
+} KvStoreStats;
+
+// 扫描页区载入最新记录,返回1找到有效页,0页区为空
+int kvStoreInit(const KvStorePort *port);
+
+// 读取键值,长度需与存储时一致,返回1成功,0不存在或长度不符
+int kvStoreGet(uint8_t key, void *value, uint8_t len);
+
+// 修改内存中的键值,数值未变时不置脏,返回0空间不足
+int kvStoreSet(uint8_t key, const void *value, uint8_t len);
+
+// 有未写入Flash的修改
+int kvStoreIsDirty(void);
+
+// 每次kvStoreSet产生实际修改时递增,调用者据此判断修改是否已停止
+uint32_t kvStoreChanges(void);
+
+// 将全部键值写入下一页,返回0成功
+int kvStoreFlush(void);
+
+void kvStoreGetStats(KvStoreStats *stats);
+#endif
@@ -12,6 +12,10 @@
 #include "jumper.h"
 #include "boot.h"
 #include "wdt.h"
+#include "cpuLoad.h"
+#include "settings.h"
+#include "scan.h"
+#include "dualWatch.h"
 #undef LOG_TAG
 #define LOG_TAG "MAIN"
 
@@ -29,11 +33,17 @@ SHARECom COM =
         .rxFreq = 145.100,
         .txPwr = TX_PWR_LOW,
         .ver = VERSION,
-        .rfEnable = 1};
+        .rfEnable = 1,
+        .baud = 19200,
+        .trxAntMs = RADIO_TRX_ANT_MS,
+        .trxPinMs = RADIO_TRX_PIN_MS,
+        .trxRampMs = 0,
+        .chSel = CHANNEL_NONE};
 
 // 同步任务，将AT的COM中产生的各种指令，同步至其他模块
 void syncInit(void)
 {
+  radioBatchBegin();
   radioSetFreqTune(COM.freqTune);      // 设置频率偏移(Hz) 微调中心频点
   radioSetAudioOutputLevel(COM.txVol); // 设置音频输出电平
   radioSetMicInputLevel(COM.rxVol);    // 设置麦克风输入电平
@@ -41,27 +51,16 @@ void syncInit(void)
   radioSetRxFreq(COM.rxFreq);          // 设置接收频率
   radioSetSQLLevel(COM.sql);           // 设置静噪电平
   radioSetPower(COM.txPwr);            // 设置发射功率
+  radioSetTrxTiming(COM.trxAntMs, COM.trxPinMs, COM.trxRampMs);
+  radioBatchEnd();                     // 只重调谐一次
 }
-void syncTask(void)
+
+static uint32_t scheduleResetTime = 0; // 计划复位的时间戳 (millis)
+
+// 将一条指令对应的COM数据同步至其他模块
+static void syncApply(ATCmd atCmd)
 {
-  WDT_Kick();                            // 喂狗
-  atCtrl(isEnableCom());                 // 控制AT指令的开关，是否启用AT指令
-  COM.smeter = radioGetSMeter();         // 获取信号强度
-  static uint32_t scheduleResetTime = 0; // 计划复位的时间戳 (millis)
-  if (scheduleResetTime != 0 && millis() > scheduleResetTime)
-  {
-    log_w("System resetting now (scheduled by AT+SYS=RESET)...");
-    HAL_Delay(50);
-    NVIC_SystemReset();
-  }
-  // 指令设置
-  ATCmd atCmd = FetchATCmd();
-  // 更新COM的实时数据
-  if (atCmd == E_AT_CMD_NONE)
-  {
-    return;
-  }
-  else if (atCmd == E_AT_CMD_SQL)
+  if (atCmd == E_AT_CMD_SQL)
   {
     log_d("setting SQL:%d", COM.sql);
     radioSetSQLLevel(COM.sql); // 设置静噪电平
@@ -76,6 +75,62 @@ void syncTask(void)
     log_d("setting RX freq:%.4f", COM.rxFreq);
     radioSetRxFreq(COM.rxFreq); // 设置接收频率
   }
+  else if (atCmd == E_AT_CMD_CH)
+  {
+    log_d("setting channel TX:%.4f RX:%.4f SQL:%d PWR:%d", COM.txFreq, COM.rxFreq, COM.sql, COM.txPwr);
+    radioSetChannel(COM.txFreq, COM.rxFreq, COM.sql, COM.txPwr); // 一次重调谐
+  }
+  else if (atCmd == E_AT_CMD_CHSEL)
+  {
+    const ChannelEntry *ch = channelGet(COM.chSel);
+    if (ch != NULL)
+    {
+      log_d("recall channel %d %.8s", COM.chSel, ch->name);
+      radioRecallChannel(ch); // PLL寄存器已预先计算
+    }
+    else
+    {
+      // 调出后同一批中又单独设置了频率,chSel已清除,COM中仍是信道的其余参数
+      radioSetChannel(COM.txFreq, COM.rxFreq, COM.sql, COM.txPwr);
+    }
+  }
+  else if (atCmd == E_AT_CMD_SCAN)
+  {
+    log_d("setting scan mode:%d hold:%d", COM.scanMode, COM.scanHold);
+    if (COM.scanMode == SHARE_SCAN_MODE_OFF)
+    {
+      scanStop(xTrue); // 回到主接收频率
+    }
+    else
+    {
+      watchStop(xFalse); // 扫描与双守候不能同时运行,扫描开始时自行重调谐
+      COM.watchPeriodMs = 0;
+      if (scanStart(COM.scanMode, COM.scanHold, COM.scanStartHz, COM.scanStopHz, COM.scanStepHz) == xFalse)
+      {
+        log_w("scan not started");
+        COM.scanMode = SHARE_SCAN_MODE_OFF;
+        radioSetRxSuspend(xFalse, xTrue); // 回到主接收频率
+      }
+    }
+  }
+  else if (atCmd == E_AT_CMD_DUALW)
+  {
+    log_d("setting dual watch %lu Hz every %d ms", (unsigned long)COM.watchHz, COM.watchPeriodMs);
+    if (COM.watchPeriodMs == 0)
+    {
+      watchStop(xTrue); // 回到主接收频率
+    }
+    else
+    {
+      scanStop(xTrue);
+      COM.scanMode = SHARE_SCAN_MODE_OFF;
+      if (watchStart(COM.watchHz, COM.watchPeriodMs) == xFalse)
+      {
+        log_w("dual watch not started");
+        COM.watchPeriodMs = 0;
+      }
+    }
+  }
   else if (atCmd == E_AT_CMD_RXVOL)
   {
     log_d("setting RX volume");
@@ -96,6 +151,11 @@ void syncTask(void)
     log_d("setting RX CTCSS");
     log_d("not support");
   }
+  else if (atCmd == E_AT_CMD_TRX)
+  {
+    log_d("setting TRX timing ant:%d pin:%d ramp:%d", COM.trxAntMs, COM.trxPinMs, COM.trxRampMs);
+    radioSetTrxTiming(COM.trxAntMs, COM.trxPinMs, COM.trxRampMs);
+  }
   else if (atCmd == E_AT_CMD_TXPWR)
   {
     log_d("setting TX power %d", COM.txPwr);
@@ -117,14 +177,110 @@ void syncTask(void)
     log_w("AT requested system RESET, will reset after 1000ms");
     scheduleResetTime = millis() + 1000;
   }
+  else if (atCmd == E_AT_CMD_BAUD)
+  {
+    log_d("setting baud %ld", (long)COM.baud);
+    atBaudSwitch(COM.baud); // 回复已按旧波特率入队
+  }
   else if (atCmd == E_AT_CMD_BOOTLOAD)
   {
     log_d("enter bootloader");
-    HAL_Delay(10);
+    settingsFlush();
+    atSendFlush(50); // 等待回复发送完成
     vRunEnterBootloader();
   }
 }
 
+void syncTask(void)
+{
+  WDT_Kick();                    // 喂狗
+  atCtrl(isEnableCom());         // 控制AT指令的开关，是否启用AT指令
+  COM.smeter = radioGetSMeter(); // 获取信号强度
+  if (scheduleResetTime != 0 && millis() > scheduleResetTime)
+  {
+    log_w("System resetting now (scheduled by AT+SYS=RESET)...");
+    settingsFlush(); // 未到延迟写入时间的修改
+    atSendFlush(50);
+    NVIC_SystemReset();
+  }
+  settingsTask(); // 设置延迟写入Flash
+  // 指令设置: 一次取出全部待处理指令,按到达顺序同步
+  // 重复的指令只同步一次(COM中已是最新值),移到最后一次到达的位置,如 DUALW,SCAN 以扫描结束
+  uint8_t pending[E_AT_CMD_MAX];
+  uint8_t pendingNum = 0;
+  uint8_t fetchNum = 0;
+  uint8_t i;
+  ATCmd atCmd;
+  while ((atCmd = FetchATCmd()) != E_AT_CMD_NONE)
+  {
+    fetchNum++;
+    for (i = 0; i < pendingNum && pending[i] != atCmd; i++)
+    {
+    }
+    if (i < pendingNum)
+    {
+      memmove(&pending[i], &pending[i + 1], pendingNum - i - 1);
+      pendingNum--;
+    }
+    pending[pendingNum++] = (uint8_t)atCmd;
+  }
+  if (pendingNum == 0)
+  {
+    return;
+  }
+  log_d("sync %d cmds, %d distinct", fetchNum, pendingNum);
+  // 频率/频偏/信道引起的重调谐合并为一次BK4802Flush
+  radioBatchBegin();
+  for (i = 0; i < pendingNum; i++)
+  {
+    syncApply((ATCmd)pending[i]);
+  }
+  radioBatchEnd();
+  settingsUpdate();
+}
+
+// 任务执行时间统计,定期经RTT输出,AT+PROF可随时查询
+#define PROF_DUMP_PERIOD 10000 // ms
+#if (SCH_PROF_HIST_SIZE != 8)
+#error "profDumpTask prints 8 histogram buckets"
+#endif
+static const char *taskName[SCH_MAX_TASKS];
+
+static void taskRegister(uint8_t index, uint8_t priority, const char *name)
+{
+  if (index >= SCH_MAX_TASKS)
+  {
+    log_e("add task %s failed", name);
+    return;
+  }
+  SCH_Set_Priority(index, priority);
+  taskName[index] = name;
+}
+
+static void profDumpTask(void)
+{
+  static uint32_t dumpTime = 0;
+  sTaskStats stats;
+  if (millis() - dumpTime < PROF_DUMP_PERIOD)
+  {
+    return;
+  }
+  dumpTime = millis();
+  for (uint8_t i = 0; i < SCH_MAX_TASKS; i++)
+  {
+    if (taskName[i] == NULL || SCH_Get_Task_Stats(i, &stats) != RETURN_NORMAL)
+    {
+      continue;
+    }
+    log_i("%d %s runs:%lu us min/avg/max:%lu/%lu/%lu backlog:%u overrun:%u miss:%u",
+          i, taskName[i], (unsigned long)stats.Runs, (unsigned long)stats.Bcet_us,
+          (unsigned long)SCH_Task_Avg_us(&stats), (unsigned long)stats.Wcet_us,
+          stats.Backlog, stats.Overruns, stats.Deadline_misses);
+    log_i("%d hist:%u %u %u %u %u %u %u %u", i, stats.Hist[0], stats.Hist[1], stats.Hist[2], stats.Hist[3],
+          stats.Hist[4], stats.Hist[5], stats.Hist[6], stats.Hist[7]);
+  }
+}
+
 extern void BK4802DebugTask(void);
 //uint32_t VECT_SRAM_TAB[48]__attribute__((section(".ARM.__at_0x20000000")));
 extern uint32_t VECT_SRAM_TAB[48];
@@ -150,7 +306,11 @@ int main(void)
   log_d("NFM Module V1.00 AT Command");
   // complex components init
   radioInit();
+  settingsInit(&COM); // 恢复保存的设置,atInit读取其中的波特率
   atInit(&COM);
+  ATCmdSetTelemetrySource(radioGetTelemetry); // AT+STREAM遥测来源
+  ATCmdSetEventSource(radioGetEvents);        // AT+EVENTS事件来源
+  ATCmdSetScanSource(scanGetResults);         // AT+SCAN结果来源
   syncInit();
   osTimerInit();
 
@@ -169,10 +329,20 @@ int main(void)
     log_d("WDT started (timeout~2s)");
   }
 
-  SCH_Add_Task(atTask, 0, 10);
-  SCH_Add_Task(radioTask, 0, 10);
-  SCH_Add_Task(ledTask, 0, 10);
-  SCH_Add_Task(syncTask, 0, 100);
+  uint8_t atTaskId = SCH_Add_Task(atTask, 0, 10);
+  atSetTaskId(atTaskId); // 周期运行兼作超时处理,收到整行时由接收中断立即触发
+  taskRegister(atTaskId, SCH_PRIO_DEFAULT, "at");
+  uint8_t radioTaskId = SCH_Add_Task(radioTask, 0, 10);
+  radioSetTaskId(radioTaskId); // PTT边沿中断立即触发
+  taskRegister(radioTaskId, SCH_PRIO_HIGH, "radio"); // 静噪/PTT 检测优先
+  taskRegister(SCH_Add_Task(ledTask, 0, 10), SCH_PRIO_LOW, "led");
+  taskRegister(SCH_Add_Task(syncTask, 0, 100), SCH_PRIO_DEFAULT, "sync");
+  taskRegister(SCH_Add_Task(profDumpTask, 0, 1000), SCH_PRIO_LOW, "prof");
+  taskRegister(SCH_Add_Task(cpuLoadTask, 0, 100), SCH_PRIO_LOW, "load");
+  // 事件任务常驻任务表,按需设定延时,多步流程不会因任务表满而中断
+  taskRegister(radioTrxInit(), SCH_PRIO_HIGH, "trx"); // PTT到发射的各步不被普通任务推迟
+  taskRegister(scanInit(), SCH_PRIO_DEFAULT, "scan");
+  taskRegister(watchInit(), SCH_PRIO_DEFAULT, "watch");
   // SCH_Add_Task(BK4802DebugTask, 1000, 1000);
   while (1)
   {
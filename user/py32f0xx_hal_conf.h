@@ -56,7 +56,7 @@
 #define HAL_DMA_MODULE_ENABLED
 /* #define HAL_LPTIM_MODULE_ENABLED */  
 #define HAL_PWR_MODULE_ENABLED
-/* #define HAL_I2C_MODULE_ENABLED */ 
+#define HAL_I2C_MODULE_ENABLED 
 #define HAL_UART_MODULE_ENABLED 
 /* #define HAL_SPI_MODULE_ENABLED */  
 /* #define HAL_RTC_MODULE_ENABLED */   
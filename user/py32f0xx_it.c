@@ -31,6 +31,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "py32f0xx_it.h"
+#include "def.h"
+#include "cpuLoad.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
@@ -42,6 +44,13 @@
 /* External variables --------------------------------------------------------*/
 extern TIM_HandleTypeDef Tim16Handle;
 extern UART_HandleTypeDef UartHandle;
+#if (BK4802_BUS == BK4802_BUS_HW_I2C)
+extern I2C_HandleTypeDef I2cHandle;
+#if BK4802_HW_I2C_USE_DMA
+extern DMA_HandleTypeDef I2cDmaTxHandle;
+extern DMA_HandleTypeDef I2cDmaRxHandle;
+#endif
+#endif
 /******************************************************************************/
 /*          Cortex-M0+ Processor Interruption and Exception Handlers          */
 /******************************************************************************/
@@ -81,16 +90,43 @@ void PendSV_Handler(void)
  */
 void SysTick_Handler(void)
 {
+  CPU_LOAD_ISR_BEGIN();
   HAL_IncTick();
+  CPU_LOAD_ISR_END(E_CPU_LOAD_ISR_SYSTICK);
 }
 void TIM16_IRQHandler(void)
 {
+  CPU_LOAD_ISR_BEGIN();
   HAL_TIM_IRQHandler(&Tim16Handle);
+  CPU_LOAD_ISR_END(E_CPU_LOAD_ISR_TIM16);
 }
 void USART2_IRQHandler(void)
 {
+  CPU_LOAD_ISR_BEGIN();
   HAL_UART_IRQHandler(&UartHandle);
+  CPU_LOAD_ISR_END(E_CPU_LOAD_ISR_USART2);
 }
+void EXTI4_15_IRQHandler(void)
+{
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_6); // PTT
+}
+#if (BK4802_BUS == BK4802_BUS_HW_I2C)
+void I2C1_IRQHandler(void)
+{
+  HAL_I2C_EV_IRQHandler(&I2cHandle);
+  HAL_I2C_ER_IRQHandler(&I2cHandle);
+}
+#if BK4802_HW_I2C_USE_DMA
+void DMA1_Channel1_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&I2cDmaTxHandle);
+}
+void DMA1_Channel2_3_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&I2cDmaRxHandle);
+}
+#endif
+#endif
 /******************************************************************************/
 /* PY32F0xx Peripheral Interrupt Handlers                                     */
 /* Add here the Interrupt Handlers for the used peripherals.                  */
@@ -15,27 +15,228 @@
 #include "jumper.h"
 #include "SHARECom.h"
 #include "def.h"
+#include "osTimer.h"
+#include "scan.h"
+#include "dualWatch.h"
 #undef TAG
 #define TAG "RADIO"
 
 static GPIO_InitTypeDef GPIO_InitStruct;
-static float txFreq = 145.100;   // MHz
-static float rxFreq = 145.100;   // MHz
+static uint32_t txHz = 145100000; // 内部按Hz保存,重调谐时不再做浮点换算
+static uint32_t rxHz = 145100000;
 static int32_t freqOffsetHz = 0; // 全局频偏(Hz)
 
 #define RSSI_OVERLOAD_THRE 125
 
+// 批量更新期间推迟重调谐,结束时最多做一次BK4802Flush
+static xBool radioBatching = xFalse;
+static xBool radioRetunePending = xFalse;
+
+// 扫描等模块接管接收频率期间,radioTask不做静噪判定,重调谐推迟到恢复时
+static xBool radioRxSuspended = xFalse;
+
+// 收发切换状态机,各阶段由调度器的事件任务按配置的延时推进,不再阻塞radioTask
+// 发射: 天线路径 -> 等待trxAntMs -> TRX脚 -> 等待trxPinMs -> 加载寄存器 -> (按trxRampMs逐档提升功率) -> 发射
+// 接收: 天线路径+TRX脚 -> 等待trxPinMs -> 加载寄存器
+typedef enum
+{
+    E_RADIO_TRX_RX,     // 接收,空闲
+    E_RADIO_TRX_ANT,    // 等待天线路径稳定
+    E_RADIO_TRX_PIN,    // 等待BK4802切换到发射
+    E_RADIO_TRX_RAMP,   // 功率爬升
+    E_RADIO_TRX_TX,     // 发射中
+    E_RADIO_TRX_RX_PIN, // 等待BK4802切换到接收
+} RadioTrxState;
+
+static RadioTrxState trxState = E_RADIO_TRX_RX;
+static uint8_t trxStepId = SCH_MAX_TASKS; // 步进任务,radioTrxInit创建,每步按需重新设定延时
+static uint16_t trxAntMs = RADIO_TRX_ANT_MS;
+static uint16_t trxPinMs = RADIO_TRX_PIN_MS;
+static uint16_t trxRampMs = 0; // 0: 直接以目标功率发射
+static uint8_t txPower = 0;    // 目标功率档位
+static uint8_t trxRampLevel = 0;
+static uint32_t trxStartUs = 0; // PTT边沿时间
+static uint32_t trxLastUs = 0;  // 最近一次PTT到发射的时间
+static uint32_t trxMaxUs = 0;
+static uint32_t trxPinLastUs = 0; // 最近一次PTT到TRX脚切换的时间
+static uint32_t trxPinMaxUs = 0;
+
+static xBool radioTrxBusy(void)
+{
+    return (trxState != E_RADIO_TRX_RX && trxState != E_RADIO_TRX_TX) ? xTrue : xFalse;
+}
+
+static void radioRetune(void)
+{
+    if (radioBatching)
+    {
+        radioRetunePending = xTrue;
+        return;
+    }
+    if (radioTrxBusy())
+    {
+        return; // 切换完成时按最新频率加载
+    }
+    if (radioRxSuspended && !BK4802IsTx())
+    {
+        return; // 恢复时按最新频率加载
+    }
+    BK4802FlushHz(BK4802IsTx() ? txHz : rxHz);
+}
+
+static void radioTrxStep(void);
+static void radioTrxSchedule(uint16_t ms)
+{
+    // 任务在启动时创建并常驻任务表,只有创建失败时才会失败
+    if (SCH_Arm_Task(trxStepId, osTimerMsToTicks(ms)) != RETURN_NORMAL)
+    {
+        log_e("trx step not scheduled");
+    }
+}
+
+static void radioTrxCancel(void)
+{
+    SCH_Disarm_Task(trxStepId);
+}
+
+uint8_t radioTrxInit(void)
+{
+    trxStepId = SCH_Add_Event_Task(radioTrxStep);
+    return trxStepId;
+}
+
+static void radioTrxDone(void)
+{
+    trxState = E_RADIO_TRX_TX;
+    trxLastUs = micros() - trxStartUs;
+    if (trxLastUs > trxMaxUs)
+    {
+        trxMaxUs = trxLastUs;
+    }
+    log_d("PTT to RF %lu us", (unsigned long)trxLastUs);
+}
+
+static void radioTrxStep(void)
+{
+    switch (trxState)
+    {
+    case E_RADIO_TRX_ANT:
+        BK4802TrxPin(xTrue);
+        trxPinLastUs = micros() - trxStartUs;
+        if (trxPinLastUs > trxPinMaxUs)
+        {
+            trxPinMaxUs = trxPinLastUs;
+        }
+        trxState = E_RADIO_TRX_PIN;
+        radioTrxSchedule(trxPinMs);
+        break;
+    case E_RADIO_TRX_PIN:
+        if (trxRampMs != 0 && txPower > 0)
+        {
+            trxRampLevel = 0;
+            BK4802SetPowerCfg(0); // 以最低功率加载,随后逐档提升
+            BK4802LoadHz(txHz);
+            trxState = E_RADIO_TRX_RAMP;
+            radioTrxSchedule(trxRampMs);
+        }
+        else
+        {
+            BK4802LoadHz(txHz);
+            radioTrxDone();
+        }
+        break;
+    case E_RADIO_TRX_RAMP:
+        if (trxRampLevel < txPower)
+        {
+            trxRampLevel++;
+            BK4802SetPower(trxRampLevel);
+        }
+        if (trxRampLevel >= txPower)
+        {
+            radioTrxDone();
+        }
+        else
+        {
+            radioTrxSchedule(trxRampMs);
+        }
+        break;
+    case E_RADIO_TRX_RX_PIN:
+        BK4802LoadHz(rxHz);
+        trxState = E_RADIO_TRX_RX;
+        break;
+    default:
+        break;
+    }
+}
+
+// PTT按下,startUs为PTT边沿时间
+static void radioTrxStartTx(ANTENNA_PATH path, uint32_t startUs)
+{
+    radioTrxCancel();
+    trxStartUs = startUs;
+    antennaPathCtrl(path);
+    trxState = E_RADIO_TRX_ANT;
+    radioTrxSchedule(trxAntMs);
+}
+
+static void radioTrxStartRx(void)
+{
+    radioTrxCancel();
+    if (trxState == E_RADIO_TRX_RAMP)
+    {
+        BK4802SetPowerCfg(txPower); // 爬升被打断,恢复目标功率配置
+    }
+    antennaPathCtrl(ANTENNA_PATH_ATTENUATOR); // 打开衰减器
+    BK4802TrxPin(xFalse);
+    trxState = E_RADIO_TRX_RX_PIN;
+    radioTrxSchedule(trxPinMs);
+}
+
+void radioSetTrxTiming(uint16_t antMs, uint16_t pinMs, uint16_t rampMs)
+{
+    trxAntMs = antMs;
+    trxPinMs = pinMs;
+    trxRampMs = rampMs;
+}
+
+void radioGetTrxLatency(uint32_t *pinLastUs, uint32_t *pinMaxUs, uint32_t *lastUs, uint32_t *maxUs)
+{
+    *pinLastUs = trxPinLastUs;
+    *pinMaxUs = trxPinMaxUs;
+    *lastUs = trxLastUs;
+    *maxUs = trxMaxUs;
+}
+
+void radioBatchBegin(void)
+{
+    radioBatching = xTrue;
+    radioRetunePending = xFalse;
+}
+
+void radioBatchEnd(void)
+{
+    radioBatching = xFalse;
+    if (radioRetunePending)
+    {
+        radioRetunePending = xFalse;
+        radioRetune();
+    }
+}
+
 void radioInit(void)
 {
     BK4802Init();
 
     // 初始化通讯脚
     //  PTT 发射脚 PB6，读取到高电平时，进行发射，默认下拉，避免干扰
+    //  双边沿中断记录边沿时间并立即触发radioTask,电平仍由radioTask读取和消抖
     GPIO_InitStruct.Pin = GPIO_PIN_6;
-    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
     GPIO_InitStruct.Pull = GPIO_PULLDOWN;
     GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+    HAL_NVIC_SetPriority(EXTI4_15_IRQn, 1, 0); // 低于调度节拍和串口
+    HAL_NVIC_EnableIRQ(EXTI4_15_IRQn);
 
     // 音频对外输出脚 PB7，输出，高电平为有正在产生的音频信号，低电平为无音频信号
     GPIO_InitStruct.Pin = GPIO_PIN_7;
@@ -51,6 +252,30 @@ xBool radioGetPTT(void)
     return HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_6) ? xTrue : xFalse;
 }
 
+// PTT边沿中断: 只记录一串抖动中第一个边沿的时间,由radioTask清除
+static uint8_t radioTaskId = SCH_MAX_TASKS;
+static volatile uint32_t pttEdgeUs = 0;
+static volatile xBool pttEdgePending = xFalse;
+
+void radioSetTaskId(uint8_t taskId)
+{
+    radioTaskId = taskId;
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if (GPIO_Pin != GPIO_PIN_6)
+    {
+        return;
+    }
+    if (pttEdgePending == xFalse)
+    {
+        pttEdgeUs = micros();
+        pttEdgePending = xTrue;
+    }
+    SCH_Trigger_Task(radioTaskId); // radioTask为高优先级,当前任务结束后立即执行
+}
+
 void radioSetAudioOutput(xBool enable)
 {
     HAL_GPIO_WritePin(GPIOB, GPIO_PIN_7, enable ? GPIO_PIN_SET : GPIO_PIN_RESET);
@@ -95,21 +320,51 @@ uint8_t radioGetSQLLevel(void)
 
 void radioSetTxFreq(float freq)
 {
-    txFreq = freq;
+    txHz = BK4802MHzToHz(freq);
     if (BK4802IsTx())
     {
-        BK4802Flush(freq);
+        radioRetune();
     }
 }
 
 void radioSetRxFreq(float freq)
 {
-    rxFreq = freq;
+    rxHz = BK4802MHzToHz(freq);
     if (!BK4802IsTx())
     {
-        BK4802Flush(freq);
+        radioRetune();
+    }
+}
+// 一次切换整个信道:频率/静噪/功率全部更新后只做一次寄存器同步
+void radioSetChannel(float txFreqMHz, float rxFreqMHz, uint8_t sql, uint8_t pwr)
+{
+    radioSetChannelHz(BK4802MHzToHz(txFreqMHz), BK4802MHzToHz(rxFreqMHz), sql, pwr);
+}
+
+void radioSetChannelHz(uint32_t txFreqHz, uint32_t rxFreqHz, uint8_t sql, uint8_t pwr)
+{
+    txHz = txFreqHz;
+    rxHz = rxFreqHz;
+    BK4802SetRSSIThre(sql);
+    txPower = pwr > 2 ? 2 : pwr;
+    if (trxState != E_RADIO_TRX_RAMP)
+    {
+        BK4802SetPowerCfg(txPower);
+    }
+    radioRetune();
+}
+
+// 信道调出: 预先计算的PLL寄存器放入缓存,重调谐及之后的收发切换都直接命中
+void radioRecallChannel(const ChannelEntry *ch)
+{
+    if (BK4802PllCachePut(ch->txHz, ch->offsetHz, xTrue, ch->txRegs) == xFalse ||
+        BK4802PllCachePut(ch->rxHz, ch->offsetHz, xFalse, ch->rxRegs) == xFalse)
+    {
+        log_d("channel saved with offset %ld Hz, recalculate", (long)ch->offsetHz);
     }
+    radioSetChannelHz(ch->txHz, ch->rxHz, ch->sql, ch->txPwr);
 }
+
 uint8_t radioGetSMeter(void)
 {
     // 降低SMeter的读取频率,改为每500ms读取一次
@@ -131,14 +386,7 @@ void radioApplyFreqTune(void)
     // 直接调用 BK4802 偏移接口
     BK4802SetFreqOffsetHz((float)freqOffsetHz);
     // 重新刷新当前状态
-    if (BK4802IsTx())
-    {
-        BK4802Flush(txFreq);
-    }
-    else
-    {
-        BK4802Flush(rxFreq);
-    }
+    radioRetune();
 }
 
 void radioSetFreqTune(int32_t tuneHz)
@@ -160,29 +408,134 @@ void timelyResetBK4802(void)
         return;
     }
     resetBK4802Period = millis() + (1000 * 3600 * 6); //  每6小时重新设置BK4802 避免奇怪的断开问题
-    BK4802Reset(rxFreq);
+    BK4802Reset(rxHz);
+}
+
+// radioTask状态,遥测快照也从这里取
+static uint8_t lastPTT = 0xFF;
+static uint32_t pttAcceptMs = 0; // 最近一次接受PTT变化的时间,用于消抖
+static uint8_t lastVout = 0xFF;
+static uint8_t lastGainLevel = 7; // IF增益等级,默认最大值
+static uint8_t radioErrFlags = 0; // SHARE_TELEM_ERR_xx
+
+// 静噪/PTT边沿事件环,保留最近SHARE_EVENT_RING_SIZE条
+#if (SHARE_EVENT_RING_SIZE & (SHARE_EVENT_RING_SIZE - 1))
+#error "SHARE_EVENT_RING_SIZE must be a power of 2"
+#endif
+static SHAREEvent radioEventRing[SHARE_EVENT_RING_SIZE];
+static uint32_t radioEventTotal = 0; // 累计事件数,也是下一条的序号
+
+// 可在中断中调用
+static void radioEventPut(uint8_t type, uint8_t state, uint32_t us)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    SHAREEvent *evt = &radioEventRing[radioEventTotal & (SHARE_EVENT_RING_SIZE - 1)];
+    evt->type = type;
+    evt->state = state;
+    evt->us = us;
+    radioEventTotal++;
+    __set_PRIMASK(primask);
+}
+
+// 按时间顺序取出最近的max条事件,返回条数,total返回累计事件数
+uint8_t radioGetEvents(SHAREEvent *out, uint8_t max, uint32_t *total)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t num = radioEventTotal < SHARE_EVENT_RING_SIZE ? radioEventTotal : SHARE_EVENT_RING_SIZE;
+    if (num > max)
+    {
+        num = max;
+    }
+    for (uint32_t i = 0; i < num; i++)
+    {
+        out[i] = radioEventRing[(radioEventTotal - num + i) & (SHARE_EVENT_RING_SIZE - 1)];
+    }
+    *total = radioEventTotal;
+    __set_PRIMASK(primask);
+    return (uint8_t)num;
+}
+
+// 遥测快照: RSSI/SNR/AFC来自本节拍的状态快照,radioTask已读过reg24,这里只需再读一次reg25
+void radioGetTelemetry(SHARETelemetry *telem)
+{
+    telem->rssi = BK4802RSSIRead();
+    telem->snr = BK4802SNRRead();
+    telem->smeter = radioGetSMeter();
+    telem->sqlOpen = lastVout == 1 ? 1 : 0;
+    telem->ptt = lastPTT == 1 ? 1 : 0;
+    telem->ifGain = lastGainLevel;
+    telem->afc = BK4802AFCResidualRead();
+    telem->errFlags = radioErrFlags | (BK4802IsError() ? SHARE_TELEM_ERR_BUS : 0);
+}
+
+void radioSetRxSuspend(xBool suspend, xBool retune)
+{
+    radioRxSuspended = suspend;
+    if (suspend && lastVout == 1)
+    {
+        // 离开当前频率前关闭音频,恢复后由radioTask重新判定
+        lastVout = 0;
+        radioEventPut(SHARE_EVENT_SQL, 0, micros());
+        radioSetAudioOutput(xFalse);
+    }
+    if (!suspend && retune)
+    {
+        radioRetune();
+    }
+}
+
+xBool radioIsSqlOpen(void)
+{
+    return lastVout == 1 ? xTrue : xFalse;
+}
+
+xBool radioIsRxIdle(void)
+{
+    return (trxState == E_RADIO_TRX_RX && lastPTT != 1) ? xTrue : xFalse;
+}
+
+uint32_t radioGetRxHz(void)
+{
+    return rxHz;
 }
 
 void radioTask(void)
 {
     extern SHARECom COM; // 使用全局共享结构体中的 rfEnable 状态
 
-    static uint8_t lastPTT = 0xFF;
-    static uint8_t lastVout = 0xFF;
     static uint8_t lastEn = 0xFF;
-    static uint8_t lastGainLevel = 7; // IF增益等级,默认最大值
     uint8_t vout = 0;
     uint8_t ptt = 0;
     uint8_t en = 0;
     WDT_Kick(); // 喂狗
     // 读取PTT状态
     ptt = radioGetPTT();
+    if (ptt != lastPTT && lastPTT != 0xFF && millis() - pttAcceptMs < RADIO_PTT_DEBOUNCE_MS)
+    {
+        ptt = lastPTT; // 消抖锁定期内保持原状态,期满后由周期运行读取最终电平
+    }
+    else if (ptt == lastPTT)
+    {
+        pttEdgePending = xFalse; // 抖动后回到原电平
+    }
     if (ptt != lastPTT)
     {
+        uint32_t pttUs = pttEdgePending ? pttEdgeUs : micros();
+        pttEdgePending = xFalse;
+        pttAcceptMs = millis();
+        if (lastPTT != 0xFF) // 上电首次读取不算边沿
+        {
+            radioEventPut(SHARE_EVENT_PTT, ptt, pttUs);
+        }
         lastPTT = ptt;
+        radioErrFlags &= ~SHARE_TELEM_ERR_RF_DISABLED;
 
         if (ptt) // 二次判断，可能被上面禁用
         {
+            scanStop(xFalse); // 发射优先,扫描停止;发射寄存器由收发状态机加载,不再重调谐接收频率
+            watchCancel();    // 取消进行中的优先信道跳频
 #if (DBUG_FUNCTION == ANTENNA_TEST) // 启用天线路径测试功能后,根据跳线状态决定天线路径
             if (getAntennaTestMode() == E_ANTENNA_MODE_RX_ONLY)
             {
@@ -193,30 +546,24 @@ void radioTask(void)
             else if (COM.rfEnable == 0)
             {
                 log_w("PTT ignored: RF DISABLED via AT+RF");
+                radioErrFlags |= SHARE_TELEM_ERR_RF_DISABLED;
                 LED_BLINK(100, 1500); // 慢闪表示被禁止
             }
             else if (getAntennaTestMode() == E_ANTENNA_MODE_ATT_ONLY)
             {
-                antennaPathCtrl(ANTENNA_PATH_ATTENUATOR); // 正常一直在衰减器挡位
                 log_d("PTT ON ATT_ONLY");
-
-                HAL_Delay(100); // 等待衰减器稳定
-                BK4802Tx(txFreq);
+                radioTrxStartTx(ANTENNA_PATH_ATTENUATOR, pttUs); // 正常一直在衰减器挡位
                 LED_BLINK(100, 500);
             }
             else if (getAntennaTestMode() == E_ANTENNA_MODE_NORMAL)
             {
                 log_d("PTT ON");
-                antennaPathCtrl(ANTENNA_PATH_FILTER); // UHF
-                HAL_Delay(100);                       // 等待衰减器稳定
-                BK4802Tx(txFreq);
+                radioTrxStartTx(ANTENNA_PATH_FILTER, pttUs); // UHF
                 LED_ON();
             }
 #else // 未启用天线路径测试,收发工作模式
             log_d("PTT ON");
-            antennaPathCtrl(ANTENNA_PATH_FILTER); // UHF
-            HAL_Delay(100);                       // 等待衰减器稳定
-            BK4802Tx(txFreq);
+            radioTrxStartTx(ANTENNA_PATH_FILTER, pttUs); // UHF
             LED_ON();
 #endif
             speakerPlay(xTrue);
@@ -224,21 +571,20 @@ void radioTask(void)
         else
         {
             // log_d("PTT OFF:%f", rxFreq);
-            antennaPathCtrl(ANTENNA_PATH_ATTENUATOR); // 打开衰减器
-            BK4802Rx(rxFreq);
+            radioTrxStartRx();
             speakerPlay(xFalse);
             LED_BLINK_COUNT(200, 200, getJumpHex() + 1, 3000);
         }
     }
 
-    if (!ptt) // 发射时，不进行接收信号判定
+    if (!ptt && trxState == E_RADIO_TRX_RX && !radioRxSuspended) // 发射、收发切换及扫描期间，不进行接收信号判定
     {
         // 判定RSSI和SNR是否满足条件,并触发音频发送
         // TODO: 判定合适的值
         uint8_t rxExist = BK4802IsRx();
         if (BK4802IsError())
         {
-            BK4802Reset(rxFreq);
+            BK4802Reset(rxHz);
         }
         else
         {
@@ -256,6 +602,10 @@ void radioTask(void)
 
         if (vout != lastVout)
         {
+            if (lastVout != 0xFF)
+            {
+                radioEventPut(SHARE_EVENT_SQL, vout, micros());
+            }
             lastVout = vout;
             if (vout)
             {
@@ -297,10 +647,19 @@ void radioTask(void)
                     BK4802IFGainLevel(lastGainLevel);
                     log_d("AGC: Decrease Gain Level to %d", lastGainLevel);
                 }
+                else
+                {
+                    radioErrFlags |= SHARE_TELEM_ERR_OVERLOAD; // 增益已最低仍过载
+                }
+            }
+            if (rssi <= RSSI_OVERLOAD_THRE)
+            {
+                radioErrFlags &= ~SHARE_TELEM_ERR_OVERLOAD;
             }
         }
         else
         {
+            radioErrFlags &= ~SHARE_TELEM_ERR_OVERLOAD;
             if (lastGainLevel != 7)
             {
                 lastGainLevel = 7; // 直接提升到最大值
@@ -316,5 +675,9 @@ void radioSetPower(uint8_t level)
     {
         level = 2; // 限制最大值为2
     }
-    BK4802SetPower(level);
+    txPower = level;
+    if (trxState != E_RADIO_TRX_RAMP) // 爬升中只更新目标,由状态机逐档写入
+    {
+        BK4802SetPower(level);
+    }
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "components.h"
 #include "wdt.h"
 #include "SHARECom.h"
+#include "channel.h"
 #define RSSI_TRIG_THRESHOLD_0 0
 #define RSSI_TRIG_THRESHOLD_1 10
 #define RSSI_TRIG_THRESHOLD_2 20
@@ -42,7 +43,34 @@ void radioSetSQLLevel(uint8_t level);
 void radioSetPower(uint8_t level); // 0,1,2分为三档 0最低, 2最高
 void radioSetTxFreq(float freq);
 void radioSetRxFreq(float freq);
+void radioSetChannel(float txFreqMHz, float rxFreqMHz, uint8_t sql, uint8_t pwr); // 单次重调谐切换信道
+void radioSetChannelHz(uint32_t txFreqHz, uint32_t rxFreqHz, uint8_t sql, uint8_t pwr);
+void radioRecallChannel(const ChannelEntry *ch); // 信道存储调出
 void radioSetFreqTune(int32_t tuneHz); // 设置频率偏移(Hz)
 void radioApplyFreqTune(void);         // 重新应用频偏到当前收/发频率
 uint8_t radioGetSMeter(void);
+void radioGetTelemetry(SHARETelemetry *telem); // 遥测快照,供AT+STREAM推送
+uint8_t radioGetEvents(SHAREEvent *out, uint8_t max, uint32_t *total); // 最近的静噪/PTT边沿事件
+// 接收挂起: 其他模块(扫描)直接重调谐接收频率期间,radioTask不做静噪判定;恢复时retune回到rxFreq
+void radioSetRxSuspend(xBool suspend, xBool retune);
+xBool radioIsSqlOpen(void);
+xBool radioIsRxIdle(void);    // 接收中,非发射及收发切换
+uint32_t radioGetRxHz(void); // 主接收频率(Hz)
+
+// 收发切换时序(ms): 天线路径稳定,TRX脚切换稳定,功率爬升每档间隔(0不爬升)
+#define RADIO_TRX_ANT_MS 100
+#define RADIO_TRX_PIN_MS 30 // 与BK4802_TRX_SETTLE_MS一致
+void radioSetTrxTiming(uint16_t antMs, uint16_t pinMs, uint16_t rampMs);
+// 创建收发切换步进任务,返回任务序号(SCH_MAX_TASKS: 失败)
+uint8_t radioTrxInit(void);
+// PTT边沿到TRX脚切换 / 到发射寄存器加载完成: 最近一次,最大值
+void radioGetTrxLatency(uint32_t *pinLastUs, uint32_t *pinMaxUs, uint32_t *lastUs, uint32_t *maxUs);
+
+// PTT(PB6)边沿中断触发radioTask,首个边沿立即响应,之后RADIO_PTT_DEBOUNCE_MS内的变化视为抖动
+#define RADIO_PTT_DEBOUNCE_MS 20
+void radioSetTaskId(uint8_t taskId);
+
+// 批量更新: 期间的频率/频偏/信道设置只记录,结束时合并为一次重调谐
+void radioBatchBegin(void);
+void radioBatchEnd(void);
 #endif
\ No newline at end of file
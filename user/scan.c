@@ -0,0 +1,334 @@
+#include "scan.h"
+#include "BK4802.h"
+#include "radio.h"
+#include "channel.h"
+#include "osTimer.h"
+#undef LOG_TAG
+#define LOG_TAG "SCAN"
+
+typedef enum
+{
+    E_SCAN_TUNE,   // 重调谐到当前信道
+    E_SCAN_CAL,    // 标定中,逐节拍采样直到RSSI稳定
+    E_SCAN_SAMPLE, // 稳定时间已到,采样
+    E_SCAN_HOLD,   // 停在信号上
+} ScanState;
+
+static ScanState scanState = E_SCAN_TUNE;
+static uint8_t scanStepId = SCH_MAX_TASKS; // 步进任务,scanInit创建,每步按需重新设定延时
+static uint8_t scanMode = SHARE_SCAN_MODE_OFF;
+static uint8_t scanHold = 0;
+static uint8_t scanNum = 0;
+static uint8_t scanIdx = 0;
+static uint8_t scanSlot[CHANNEL_NUM]; // 列表模式: 扫描序号对应的存储信道
+static uint32_t scanStartHz = 0;
+static uint32_t scanStepHz = 0;
+static uint32_t scanHz = 0;   // 当前信道频率
+static uint8_t scanBand = 0;  // 当前信道频段
+static uint32_t scanSweeps = 0;
+static uint32_t scanSweepMs = 0; // 本轮开始时刻
+static uint32_t scanChps = 0;
+static uint32_t scanQuietMs = 0; // 停留期间静噪最后一次打开的时刻
+static uint16_t scanOcc[SCAN_MAX_CHANNELS]; // 各信道有信号的次数
+
+// 各频段PLL稳定时间: 调度节拍数用于等待,us为标定时实测值
+static uint8_t settleTicks[BK4802_BAND_NUM];
+static uint16_t settleUs[BK4802_BAND_NUM];
+static uint8_t calCount[BK4802_BAND_NUM];
+static ScanCal scanCal;
+
+#if (SHARE_SCAN_RING_SIZE & (SHARE_SCAN_RING_SIZE - 1))
+#error "SHARE_SCAN_RING_SIZE must be a power of 2"
+#endif
+static SHAREScan scanRing[SHARE_SCAN_RING_SIZE];
+static uint32_t scanTotal = 0; // 累计结果数,也是下一条的序号
+
+static void scanPut(uint8_t type, uint8_t index, uint8_t rssi, uint8_t snr, uint32_t value)
+{
+    SHAREScan *res = &scanRing[scanTotal & (SHARE_SCAN_RING_SIZE - 1)];
+    res->type = type;
+    res->index = index;
+    res->rssi = rssi;
+    res->snr = snr;
+    res->value = value;
+    scanTotal++;
+}
+
+uint8_t scanGetResults(SHAREScan *out, uint8_t max, uint32_t *total)
+{
+    uint32_t num = scanTotal < SHARE_SCAN_RING_SIZE ? scanTotal : SHARE_SCAN_RING_SIZE;
+    if (num > max)
+    {
+        num = max;
+    }
+    for (uint32_t i = 0; i < num; i++)
+    {
+        out[i] = scanRing[(scanTotal - num + i) & (SHARE_SCAN_RING_SIZE - 1)];
+    }
+    *total = scanTotal;
+    return (uint8_t)num;
+}
+
+xBool scanIsCalibrated(uint8_t band)
+{
+    return band < BK4802_BAND_NUM && calCount[band] >= SCAN_CAL_SAMPLES ? xTrue : xFalse;
+}
+
+uint8_t scanGetSettleTicks(uint8_t band)
+{
+    return scanIsCalibrated(band) ? settleTicks[band] : SCAN_SETTLE_MAX_TICKS;
+}
+
+void scanCalBegin(ScanCal *cal, uint8_t band)
+{
+    cal->band = band;
+    cal->wait = 0;
+    cal->lastRssi = 0xFF;
+    cal->startUs = micros();
+}
+
+xBool scanCalStep(ScanCal *cal, uint8_t rssi)
+{
+    uint8_t band = cal->band;
+    uint8_t last = cal->lastRssi;
+    uint32_t us;
+    uint8_t ticks;
+    cal->wait++;
+    cal->lastRssi = rssi;
+    if ((last == 0xFF || (rssi > last ? rssi - last : last - rssi) > SCAN_CAL_TOLERANCE) &&
+        cal->wait < SCAN_SETTLE_MAX_TICKS)
+    {
+        return xFalse;
+    }
+    if (band >= BK4802_BAND_NUM)
+    {
+        return xTrue;
+    }
+    us = micros() - cal->startUs;
+    // 第二次读数才确认稳定,稳定时间按前一次读数计
+    ticks = cal->wait >= SCAN_SETTLE_MAX_TICKS ? cal->wait : cal->wait - 1;
+    if (ticks > settleTicks[band])
+    {
+        settleTicks[band] = ticks;
+    }
+    if (us > settleUs[band])
+    {
+        settleUs[band] = us > 0xFFFF ? 0xFFFF : (uint16_t)us;
+    }
+    if (calCount[band] < SCAN_CAL_SAMPLES && ++calCount[band] == SCAN_CAL_SAMPLES)
+    {
+        log_i("band %d settle %d ticks %dus", band, settleTicks[band], settleUs[band]);
+    }
+    return xTrue;
+}
+
+static void scanStep(void);
+static void scanSchedule(uint16_t ticks)
+{
+    if (SCH_Arm_Task(scanStepId, ticks) != RETURN_NORMAL)
+    {
+        log_w("scan step not scheduled, stop");
+        scanStop(xTrue);
+    }
+}
+
+uint8_t scanInit(void)
+{
+    scanStepId = SCH_Add_Event_Task(scanStep);
+    return scanStepId;
+}
+
+static uint32_t scanChannelHz(uint8_t idx)
+{
+    if (scanMode == SHARE_SCAN_MODE_LIST)
+    {
+        const ChannelEntry *ch = channelGet(scanSlot[idx]);
+        return ch != NULL ? ch->rxHz : 0;
+    }
+    return scanStartHz + idx * scanStepHz;
+}
+
+static void scanNext(void)
+{
+    scanIdx++;
+    if (scanIdx >= scanNum)
+    {
+        uint32_t ms = millis() - scanSweepMs;
+        scanIdx = 0;
+        scanSweeps++;
+        scanChps = ms ? scanNum * 1000UL / ms : scanNum * 1000UL;
+        scanSweepMs = millis();
+        scanPut(SHARE_SCAN_SWEEP, scanNum, 0, 0, scanChps);
+    }
+    scanState = E_SCAN_TUNE;
+}
+
+// 采样结果: 连续扫描时记录占用,停留模式下有信号时交给radioTask
+static void scanEvaluate(uint8_t rssi, uint8_t snr)
+{
+    if (BK4802RxDetect(rssi, snr, xFalse) == xFalse)
+    {
+        scanNext();
+        scanSchedule(0);
+        return;
+    }
+    scanOcc[scanIdx]++;
+    scanPut(SHARE_SCAN_HIT, scanIdx, rssi, snr, scanHz);
+    if (!scanHold)
+    {
+        scanNext();
+        scanSchedule(0);
+        return;
+    }
+    log_d("hold on %lu rssi:%d snr:%d", (unsigned long)scanHz, rssi, snr);
+    scanState = E_SCAN_HOLD;
+    scanQuietMs = millis();
+    radioSetRxSuspend(xFalse, xFalse); // 保持当前频率,静噪和音频由radioTask处理
+    scanSchedule(osTimerMsToTicks(SCAN_HOLD_POLL_MS));
+}
+
+static void scanStep(void)
+{
+    uint8_t rssi;
+    switch (scanState)
+    {
+    case E_SCAN_TUNE:
+        scanHz = scanChannelHz(scanIdx);
+        if (scanHz == 0 || BK4802RetuneRxHz(scanHz) == xFalse)
+        {
+            scanNext(); // 信道已删除或超出范围
+            scanSchedule(0);
+            break;
+        }
+        scanBand = BK4802BandIndex(scanHz);
+        if (scanIsCalibrated(scanBand) == xFalse)
+        {
+            scanState = E_SCAN_CAL;
+            scanCalBegin(&scanCal, scanBand);
+            scanSchedule(1);
+        }
+        else
+        {
+            scanState = E_SCAN_SAMPLE;
+            scanSchedule(settleTicks[scanBand]);
+        }
+        break;
+    case E_SCAN_CAL:
+        BK4802StatusInvalidate();
+        rssi = BK4802RSSIRead();
+        if (scanCalStep(&scanCal, rssi))
+        {
+            scanEvaluate(rssi, BK4802SNRRead());
+            break;
+        }
+        scanSchedule(1);
+        break;
+    case E_SCAN_SAMPLE:
+        BK4802StatusInvalidate(); // 等待期间其他任务可能读过旧频率的快照
+        rssi = BK4802RSSIRead();  // RSSI/SNR来自同一次reg24读取
+        scanEvaluate(rssi, BK4802SNRRead());
+        break;
+    case E_SCAN_HOLD:
+        if (radioIsSqlOpen())
+        {
+            scanQuietMs = millis();
+        }
+        else if (millis() - scanQuietMs >= SCAN_RESUME_MS)
+        {
+            radioSetRxSuspend(xTrue, xFalse);
+            scanNext();
+            scanSchedule(0);
+            break;
+        }
+        scanSchedule(osTimerMsToTicks(SCAN_HOLD_POLL_MS));
+        break;
+    default:
+        break;
+    }
+}
+
+xBool scanStart(uint8_t mode, uint8_t hold, uint32_t startHz, uint32_t stopHz, uint32_t stepHz)
+{
+    uint8_t num = 0;
+    scanStop(xTrue);
+    if (mode == SHARE_SCAN_MODE_LIST)
+    {
+        uint32_t mask = channelUsedMask();
+        for (uint8_t i = 0; i < CHANNEL_NUM; i++)
+        {
+            if (mask & (1UL << i))
+            {
+                scanSlot[num++] = i;
+            }
+        }
+    }
+    else if (mode == SHARE_SCAN_MODE_RANGE && stepHz != 0 && stopHz >= startHz &&
+             (stopHz - startHz) / stepHz < SCAN_MAX_CHANNELS)
+    {
+        num = (uint8_t)((stopHz - startHz) / stepHz + 1);
+    }
+    if (num == 0)
+    {
+        return xFalse;
+    }
+    scanMode = mode;
+    scanHold = hold;
+    scanNum = num;
+    scanStartHz = startHz;
+    scanStepHz = stepHz;
+    scanIdx = 0;
+    scanSweeps = 0;
+    scanChps = 0;
+    scanSweepMs = millis();
+    memset(scanOcc, 0, sizeof(scanOcc));
+    scanState = E_SCAN_TUNE;
+    radioSetRxSuspend(xTrue, xFalse);
+    log_i("scan start mode:%d hold:%d num:%d", mode, hold, num);
+    scanSchedule(0);
+    return xTrue;
+}
+
+void scanStop(xBool retune)
+{
+    if (scanMode == SHARE_SCAN_MODE_OFF)
+    {
+        return;
+    }
+    SCH_Disarm_Task(scanStepId);
+    scanMode = SHARE_SCAN_MODE_OFF;
+    radioSetRxSuspend(xFalse, retune); // 回到主接收频率
+    log_i("scan stop after %lu sweeps", (unsigned long)scanSweeps);
+}
+
+xBool scanIsActive(void)
+{
+    return scanMode != SHARE_SCAN_MODE_OFF ? xTrue : xFalse;
+}
+
+void scanGetStatus(ScanStatus *status)
+{
+    status->mode = scanMode;
+    status->hold = scanHold;
+    status->num = scanNum;
+    status->holding = (scanMode != SHARE_SCAN_MODE_OFF && scanState == E_SCAN_HOLD) ? 1 : 0;
+    status->sweeps = scanSweeps;
+    status->chps = scanChps;
+    status->holdHz = status->holding ? scanHz : 0;
+}
+
+uint16_t scanGetOccupancy(uint8_t index)
+{
+    if (index >= scanNum || scanSweeps == 0)
+    {
+        return 0;
+    }
+    // 当前未完成的一轮中已扫过的信道多计一次
+    uint32_t visits = scanSweeps + (index < scanIdx ? 1 : 0);
+    uint32_t permille = scanOcc[index] * 1000UL / visits;
+    return permille > 1000 ? 1000 : (uint16_t)permille;
+}
+
+uint16_t scanGetSettleUs(uint8_t band)
+{
+    return scanIsCalibrated(band) ? settleUs[band] : 0;
+}
@@ -0,0 +1,57 @@
+#ifndef __SCAN_H__
+#define __SCAN_H__
+/*
+ * 信道扫描
+ * 每个信道: 只写频率寄存器重调谐 -> 等待该频段的PLL稳定时间 -> 读一次reg24 RSSI/SNR
+ * 各步由调度器的事件任务推进,等待期间调度器可休眠;稳定时间在每个频段的前几次重调谐中
+ * 逐节拍采样RSSI直到读数稳定来标定,取最大值
+ * hold=1: 发现信号后停在该信道,交给radioTask的静噪逻辑,静噪关闭SCAN_RESUME_MS后继续
+ * hold=0: 连续扫描,统计每个信道的占用率
+ */
+#include "components.h"
+#include "SHARECom.h"
+
+#define SCAN_MAX_CHANNELS 64    // 范围扫描最多的信道数
+#define SCAN_CAL_SAMPLES 4      // 每个频段用于标定稳定时间的重调谐次数
+#define SCAN_CAL_TOLERANCE 2    // 相邻两次RSSI读数相差不超过此值视为稳定
+#define SCAN_SETTLE_MAX_TICKS 42 // 标定上限,约30ms(原HAL_Delay(30))
+#define SCAN_HOLD_POLL_MS 100
+#define SCAN_RESUME_MS 2000
+
+typedef struct
+{
+    uint8_t mode;      // SHARE_SCAN_MODE_xx, 停止后为OFF
+    uint8_t hold;
+    uint8_t num;       // 扫描列表信道数
+    uint8_t holding;   // 1: 停在信号上
+    uint32_t sweeps;   // 完成的轮数
+    uint32_t chps;     // 最近一轮的信道/秒
+    uint32_t holdHz;   // 停留的频率
+} ScanStatus;
+
+// 创建扫描步进任务,返回任务序号(SCH_MAX_TASKS: 失败)
+uint8_t scanInit(void);
+// 返回xFalse: 列表为空或范围超过SCAN_MAX_CHANNELS
+xBool scanStart(uint8_t mode, uint8_t hold, uint32_t startHz, uint32_t stopHz, uint32_t stepHz);
+// retune=xFalse: 不重调谐,用于随后由调用者加载寄存器的场合(如发射)
+void scanStop(xBool retune);
+xBool scanIsActive(void);
+void scanGetStatus(ScanStatus *status);
+uint16_t scanGetOccupancy(uint8_t index);    // 千分比
+uint16_t scanGetSettleUs(uint8_t band);      // 频段标定的稳定时间,未标定返回0
+uint8_t scanGetResults(SHAREScan *out, uint8_t max, uint32_t *total); // 最近的扫描结果,按时间顺序
+
+// PLL稳定时间标定,双守候跳到优先信道时共用同一张频段表
+typedef struct
+{
+    uint8_t band;
+    uint8_t wait;     // 已等待的节拍数
+    uint8_t lastRssi; // 上一次读数,0xFF表示尚无
+    uint32_t startUs; // 重调谐时刻
+} ScanCal;
+xBool scanIsCalibrated(uint8_t band);
+uint8_t scanGetSettleTicks(uint8_t band); // 未标定返回SCAN_SETTLE_MAX_TICKS
+void scanCalBegin(ScanCal *cal, uint8_t band); // 重调谐后立即调用
+// 重调谐后每节拍读一次RSSI调用,稳定或超时返回xTrue并记入该频段
+xBool scanCalStep(ScanCal *cal, uint8_t rssi);
+#endif
@@ -0,0 +1,165 @@
+#include "settings.h"
+#include "radioConvert.h"
+#include "atCommand.h"
+#include "channel.h"
+#undef LOG_TAG
+#define LOG_TAG "SET"
+
+static SHARECom *setCOM = NULL;
+static uint32_t setChanges = 0;  // 上次检查时的kvStoreChanges
+static uint32_t setChangeTime = 0; // 最后一次修改的时刻
+
+static int settingsErase(uint16_t page)
+{
+    uint32_t pageError = 0;
+    FLASH_EraseInitTypeDef eraseInit = {0};
+    HAL_StatusTypeDef status;
+    eraseInit.TypeErase = FLASH_TYPEERASE_PAGEERASE;
+    eraseInit.PageAddress = SETTINGS_BASE + page * FLASH_PAGE_SIZE;
+    eraseInit.NbPages = 1;
+    HAL_FLASH_Unlock();
+    status = HAL_FLASH_Erase(&eraseInit, &pageError);
+    HAL_FLASH_Lock();
+    return status == HAL_OK ? 0 : -1;
+}
+
+static int settingsProgram(uint16_t page, const uint32_t *data)
+{
+    HAL_StatusTypeDef status;
+    HAL_FLASH_Unlock();
+    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_PAGE, SETTINGS_BASE + page * FLASH_PAGE_SIZE, (uint32_t *)data);
+    HAL_FLASH_Lock();
+    return status == HAL_OK ? 0 : -1;
+}
+
+static const KvStorePort settingsPort = {
+    .base = (const uint8_t *)SETTINGS_BASE,
+    .pages = SETTINGS_PAGES,
+    .erase = settingsErase,
+    .program = settingsProgram,
+};
+
+void settingsInit(SHARECom *com)
+{
+    uint8_t u8;
+    float f;
+    int32_t i32;
+    uint16_t trx[3];
+    uint32_t start = micros();
+    setCOM = com;
+    if (!kvStoreInit(&settingsPort))
+    {
+        log_i("no saved settings, use default");
+        return;
+    }
+    // 逐项校验,单项无效时保留默认值
+    if (kvStoreGet(SETTINGS_KEY_SQL, &u8, 1) && u8 <= 10)
+    {
+        com->sql = u8;
+    }
+    if (kvStoreGet(SETTINGS_KEY_TXFREQ, &f, 4) && isVailideHamFreq(f))
+    {
+        com->txFreq = f;
+    }
+    if (kvStoreGet(SETTINGS_KEY_RXFREQ, &f, 4) && isVailideHamFreq(f))
+    {
+        com->rxFreq = f;
+    }
+    if (kvStoreGet(SETTINGS_KEY_RXVOL, &u8, 1))
+    {
+        com->rxVol = u8;
+    }
+    if (kvStoreGet(SETTINGS_KEY_TXVOL, &u8, 1))
+    {
+        com->txVol = u8;
+    }
+    if (kvStoreGet(SETTINGS_KEY_TXPWR, &u8, 1) && u8 <= TX_PWR_HIGH)
+    {
+        com->txPwr = u8;
+    }
+    if (kvStoreGet(SETTINGS_KEY_FREQTUNE, &i32, 4))
+    {
+        com->freqTune = i32;
+    }
+    if (kvStoreGet(SETTINGS_KEY_RF, &u8, 1) && u8 <= 1)
+    {
+        com->rfEnable = u8;
+    }
+    if (kvStoreGet(SETTINGS_KEY_TCTCSS, &f, 4) && (f == 0 || isValideCTCSS(f)))
+    {
+        com->tCTCSS = f;
+    }
+    if (kvStoreGet(SETTINGS_KEY_RCTCSS, &f, 4) && (f == 0 || isValideCTCSS(f)))
+    {
+        com->rCTCSS = f;
+    }
+    if (kvStoreGet(SETTINGS_KEY_CHSEL, &u8, 1) && (u8 == CHANNEL_NONE || channelGet(u8) != NULL))
+    {
+        com->chSel = u8;
+    }
+    if (kvStoreGet(SETTINGS_KEY_TRX, trx, sizeof(trx)))
+    {
+        com->trxAntMs = trx[0];
+        com->trxPinMs = trx[1];
+        com->trxRampMs = trx[2];
+    }
+    setChanges = kvStoreChanges();
+    log_i("settings restored in %luus", (unsigned long)(micros() - start));
+}
+
+void settingsUpdate(void)
+{
+    uint16_t trx[3];
+    if (setCOM == NULL)
+    {
+        return;
+    }
+    // 未变化的项不会置脏
+    kvStoreSet(SETTINGS_KEY_SQL, &setCOM->sql, 1);
+    kvStoreSet(SETTINGS_KEY_TXFREQ, &setCOM->txFreq, 4);
+    kvStoreSet(SETTINGS_KEY_RXFREQ, &setCOM->rxFreq, 4);
+    kvStoreSet(SETTINGS_KEY_RXVOL, &setCOM->rxVol, 1);
+    kvStoreSet(SETTINGS_KEY_TXVOL, &setCOM->txVol, 1);
+    kvStoreSet(SETTINGS_KEY_TXPWR, &setCOM->txPwr, 1);
+    kvStoreSet(SETTINGS_KEY_FREQTUNE, &setCOM->freqTune, 4);
+    kvStoreSet(SETTINGS_KEY_RF, &setCOM->rfEnable, 1);
+    kvStoreSet(SETTINGS_KEY_TCTCSS, &setCOM->tCTCSS, 4);
+    kvStoreSet(SETTINGS_KEY_RCTCSS, &setCOM->rCTCSS, 4);
+    kvStoreSet(SETTINGS_KEY_CHSEL, &setCOM->chSel, 1);
+    trx[0] = setCOM->trxAntMs;
+    trx[1] = setCOM->trxPinMs;
+    trx[2] = setCOM->trxRampMs;
+    kvStoreSet(SETTINGS_KEY_TRX, trx, sizeof(trx));
+}
+
+void settingsFlush(void)
+{
+    KvStoreStats stats;
+    if (!kvStoreIsDirty())
+    {
+        return;
+    }
+    if (kvStoreFlush() != 0)
+    {
+        log_e("settings save failed");
+        return;
+    }
+    kvStoreGetStats(&stats);
+    log_d("settings saved page:%d seq:%lu used:%d", stats.page, (unsigned long)stats.seq, stats.used);
+}
+
+// 连续修改(如上位机逐项下发配置)期间不写Flash,停止修改后一次写入
+void settingsTask(void)
+{
+    uint32_t changes = kvStoreChanges();
+    if (changes != setChanges)
+    {
+        setChanges = changes;
+        setChangeTime = millis();
+        return;
+    }
+    if (kvStoreIsDirty() && millis() - setChangeTime >= SETTINGS_SAVE_DELAY_MS)
+    {
+        settingsFlush();
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef __SETTINGS_H__
+#define __SETTINGS_H__
+/*
+ * SHARECom设置掉电保存
+ * 存放在Flash末尾的kvStore页区,启动时恢复;修改停止SETTINGS_SAVE_DELAY_MS后合并写入一次
+ */
+#include "components.h"
+#include "SHARECom.h"
+#include "kvStore.h"
+
+#define SETTINGS_PAGES 16 // 2KB,链接脚本中已预留
+#define SETTINGS_BASE (FLASH_BASE + FLASH_SIZE - SETTINGS_PAGES * FLASH_PAGE_SIZE)
+#define SETTINGS_SAVE_DELAY_MS 2000
+
+// kvStore的KEY,与BIN_TAG_xx编号一致
+#define SETTINGS_KEY_SQL 0x01      // u8
+#define SETTINGS_KEY_TXFREQ 0x02   // float MHz
+#define SETTINGS_KEY_RXFREQ 0x03   // float MHz
+#define SETTINGS_KEY_RXVOL 0x04    // u8
+#define SETTINGS_KEY_TXVOL 0x05    // u8
+#define SETTINGS_KEY_TXPWR 0x06    // u8
+#define SETTINGS_KEY_FREQTUNE 0x07 // i32 Hz
+#define SETTINGS_KEY_RF 0x08       // u8
+#define SETTINGS_KEY_TCTCSS 0x0B   // float Hz
+#define SETTINGS_KEY_RCTCSS 0x0C   // float Hz
+#define SETTINGS_KEY_TRX 0x0D      // u16 ant, pin, ramp
+#define SETTINGS_KEY_BAUD 0x0E     // u32, 由at.c在波特率确认后写入
+#define SETTINGS_KEY_CHSEL 0x0F    // u8 最近调出的存储信道
+
+void settingsInit(SHARECom *com); // 在atInit之前调用,恢复保存的设置
+void settingsUpdate(void);        // COM被修改后调用,只在内存中记录
+void settingsTask(void);          // put in a 100ms loop task
+void settingsFlush(void);         // 立即写入,复位前调用
+#endif